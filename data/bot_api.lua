@@ -169,6 +169,10 @@ function estimate(time, posx, posy, velx, vely)
 	-- read parameters and set correct defaults
 	-- TODO actually, it makes only sense to set them all, or none. should we check that somewhere?
 	-- TODO re-introduce errors
+	if posx == nil and posy == nil and velx == nil and vely == nil then
+		-- the current ball's trajectory is cached on the C++ side
+		return predict_ball( time )
+	end
 	posx = posx or ballx()
 	velx = velx or bspeedx()
 	posy = posy or bally()
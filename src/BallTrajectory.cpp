@@ -0,0 +1,118 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "BallTrajectory.h"
+
+/* includes */
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+
+#include "PhysicWorld.h"
+
+/* implementation */
+
+const int BallTrajectory::MAX_STEPS;
+
+BallTrajectory::BallTrajectory() : mWorld(new PhysicWorld())
+{
+	push( BallState{mWorld->getBallPosition(), mWorld->getBallVelocity()} );
+}
+
+BallTrajectory::~BallTrajectory() = default;
+
+void BallTrajectory::setStart(Vector2 position, Vector2 velocity)
+{
+	int steps = find(position, velocity);
+	if(steps < 0)
+	{
+		mStates.clear();
+		mIndex.clear();
+		mFirstStep = 0;
+		push( BallState{position, velocity} );
+		return;
+	}
+
+	for(int i = 0; i < steps; ++i)
+	{
+		// a state that occurs again later is not found anymore, which only costs a new simulation
+		auto entry = mIndex.find(mStates.front());
+		if(entry != mIndex.end() && entry->second == mFirstStep)
+			mIndex.erase(entry);
+		mStates.pop_front();
+		++mFirstStep;
+	}
+}
+
+int BallTrajectory::find(Vector2 position, Vector2 velocity) const
+{
+	auto entry = mIndex.find( BallState{position, velocity} );
+	if(entry == mIndex.end())
+		return -1;
+	return entry->second - mFirstStep;
+}
+
+void BallTrajectory::push(const BallState& state)
+{
+	// keeps the first occurrence, like a scan from the front would find it
+	mIndex.emplace(state, mFirstStep + mStates.size());
+	mStates.push_back(state);
+}
+
+std::size_t BallTrajectory::StateHash::operator()(const BallState& state) const
+{
+	// 0 and -0 are equal, so they need the same hash
+	auto hash = [](float value) { return std::hash<float>()(value == 0 ? 0.f : value); };
+	std::size_t result = hash(state.position.x);
+	for(float value : {state.position.y, state.velocity.x, state.velocity.y})
+		result = result * 31 + hash(value);
+	return result;
+}
+
+bool BallTrajectory::StateEqual::operator()(const BallState& a, const BallState& b) const
+{
+	return a.position == b.position && a.velocity == b.velocity;
+}
+
+const BallTrajectory::BallState& BallTrajectory::at(int steps)
+{
+	// scripts choose the number of steps, so the cache must not grow without a limit
+	steps = std::max(0, std::min(steps, MAX_STEPS - 1));
+
+	if(steps >= (int)mStates.size())
+	{
+		mWorld->setBallPosition( mStates.back().position );
+		mWorld->setBallVelocity( mStates.back().velocity );
+		while(steps >= (int)mStates.size())
+		{
+			// set ball valid to false to ignore blobby bounces
+			mWorld->step(PlayerInput(), PlayerInput(), false, true);
+			push( BallState{mWorld->getBallPosition(), mWorld->getBallVelocity()} );
+		}
+	}
+
+	return mStates[steps];
+}
+
+int BallTrajectory::getCachedSteps() const
+{
+	return mStates.size();
+}
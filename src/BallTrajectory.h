@@ -0,0 +1,92 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include "Vector.h"
+
+class PhysicWorld;
+
+/*! \class BallTrajectory
+	\brief Cached prediction of the ball's flight
+	\details Stores the ball positions and velocities for consecutive physic steps,
+			starting at the current ball state and ignoring collisions with the blobs.
+			Steps are only simulated when they are requested for the first time. When
+			the start is moved to a state the ball already reached on the cached path,
+			the remaining steps are kept, so a bot that queries the trajectory every
+			frame only needs to simulate about one new step per frame.
+			All results are bit-identical to stepping a PhysicWorld with an invalid ball.
+*/
+class BallTrajectory
+{
+	public:
+		struct BallState
+		{
+			Vector2 position;
+			Vector2 velocity;
+		};
+
+		/// at most this many steps are simulated and cached, one minute at normal speed
+		static const int MAX_STEPS = 75 * 60;
+
+		BallTrajectory();
+		~BallTrajectory();
+
+		/// lets the trajectory start at the given ball state. If the state is on the
+		/// cached trajectory, the steps behind it are reused.
+		void setStart(Vector2 position, Vector2 velocity);
+
+		/// gets the number of steps after which the ball reaches the given state,
+		/// or -1 if it is not on the cached part of the trajectory.
+		int find(Vector2 position, Vector2 velocity) const;
+
+		/// gets the ball state after \p steps steps. \p steps is clamped to [0, MAX_STEPS), so
+		/// callers that need states further ahead have to simulate them without the cache.
+		const BallState& at(int steps);
+
+		/// gets the number of steps that are simulated and cached at the moment
+		int getCachedSteps() const;
+
+	private:
+		struct StateHash
+		{
+			std::size_t operator()(const BallState& state) const;
+		};
+
+		struct StateEqual
+		{
+			bool operator()(const BallState& a, const BallState& b) const;
+		};
+
+		/// appends the state after the last cached step
+		void push(const BallState& state);
+
+		std::deque<BallState> mStates;
+		// number of the first cached state, counted since the last time the cache was reset
+		std::size_t mFirstStep = 0;
+		// first cached occurrence of each state, by its number, so find does not scan the cache
+		std::unordered_map<BallState, std::size_t, StateHash, StateEqual> mIndex;
+		std::unique_ptr<PhysicWorld> mWorld;
+};
@@ -0,0 +1,132 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "BlobColorizer.h"
+
+/* includes */
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOBBY_COLORIZE_SSE2
+#include <emmintrin.h>
+#endif
+
+/* implementation */
+namespace
+{
+	// pixels are stored as 0xAABBGGRR
+	const std::uint32_t RGB_MASK = 0x00FFFFFF;
+
+#ifdef BLOBBY_COLORIZE_SSE2
+	/// tints two pixels, unpacked to 16 bit per channel
+	inline __m128i colorizeSSE2(__m128i pixels, __m128i color, __m128i alpha_mask)
+	{
+		// red channel of each pixel in all of its lanes
+		__m128i red = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+		__m128i fak = _mm_sub_epi16(_mm_mullo_epi16(red, _mm_set1_epi16(5)), _mm_set1_epi16(4 * 256 + 138));
+		fak = _mm_max_epi16(fak, _mm_setzero_si128());
+
+		__m128i tinted = _mm_srli_epi16(_mm_mullo_epi16(pixels, color), 8);
+		tinted = _mm_max_epi16(_mm_add_epi16(tinted, fak), _mm_set1_epi16(1));
+
+		return _mm_or_si128(_mm_andnot_si128(alpha_mask, tinted), _mm_and_si128(alpha_mask, pixels));
+	}
+#else
+	/// tints the pixels one by one. The products with the color channels and the brightness
+	/// correction, which depends on the red channel, are looked up in tables.
+	void colorizeScalar(const std::uint32_t* source, std::uint32_t* target, std::size_t count, Color color)
+	{
+		std::uint8_t red[256], green[256], blue[256];
+		int bright[256];
+		for(int v = 0; v < 256; ++v)
+		{
+			red[v] = (v * color.r) >> 8;
+			green[v] = (v * color.g) >> 8;
+			blue[v] = (v * color.b) >> 8;
+			// Bright pixels in the original image should remain bright!
+			bright[v] = std::max(0, v * 5 - 4 * 256 - 138);
+		}
+
+		// This is clamped to 1 because dark colors may would be
+		// color-keyed otherwise
+		auto clamp = [](int value) -> std::uint32_t {
+			return std::max(1, std::min(value, 255));
+		};
+
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			std::uint32_t pixel = source[i];
+			if( !(pixel & RGB_MASK) )
+			{
+				target[i] = pixel;
+				continue;
+			}
+
+			unsigned r = pixel & 0xFF;
+			unsigned g = (pixel >> 8) & 0xFF;
+			unsigned b = (pixel >> 16) & 0xFF;
+			int fak = bright[r];
+
+			target[i] = (pixel & ~RGB_MASK) | clamp(red[r] + fak) | clamp(green[g] + fak) << 8 | clamp(blue[b] + fak) << 16;
+		}
+	}
+#endif
+}
+
+void colorizeBlobPixels(const std::uint32_t* source, std::uint32_t* target, std::size_t count, Color color)
+{
+#ifdef BLOBBY_COLORIZE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i color_lanes = _mm_setr_epi16(color.r, color.g, color.b, 0, color.r, color.g, color.b, 0);
+	const __m128i alpha_mask = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+	const __m128i rgb_mask = _mm_set1_epi32(RGB_MASK);
+
+	auto colorize = [&](__m128i pixels)
+	{
+		__m128i low = colorizeSSE2(_mm_unpacklo_epi8(pixels, zero), color_lanes, alpha_mask);
+		__m128i high = colorizeSSE2(_mm_unpackhi_epi8(pixels, zero), color_lanes, alpha_mask);
+		// saturation clamps the channels to 255
+		__m128i tinted = _mm_packus_epi16(low, high);
+
+		// color keyed pixels stay as they are
+		__m128i keyed = _mm_cmpeq_epi32(_mm_and_si128(pixels, rgb_mask), zero);
+		return _mm_or_si128(_mm_and_si128(keyed, pixels), _mm_andnot_si128(keyed, tinted));
+	};
+
+	std::size_t done = 0;
+	for(; done + 4 <= count; done += 4)
+	{
+		__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + done));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(target + done), colorize(pixels));
+	}
+
+	// the remaining pixels are padded to a full vector
+	if( done < count )
+	{
+		std::uint32_t rest[4] = {0, 0, 0, 0};
+		std::copy(source + done, source + count, rest);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(rest), colorize(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rest))));
+		std::copy(rest, rest + (count - done), target + done);
+	}
+#else
+	colorizeScalar(source, target, count, color);
+#endif
+}
@@ -0,0 +1,34 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Color.h"
+
+/// \brief tints blob pixels with a player color
+/// \details Reads \p count pixels in SDL_PIXELFORMAT_ABGR8888 from \p source and writes the tinted
+///			pixels to \p target, which may be the same buffer. Black pixels are the color key and
+///			are copied unchanged, alpha is kept. Bright parts of the image stay bright, and no
+///			tinted pixel becomes black, so it cannot turn into the color key.
+///			Uses SSE2 where available.
+void colorizeBlobPixels(const std::uint32_t* source, std::uint32_t* target, std::size_t count, Color color);
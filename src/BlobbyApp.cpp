@@ -30,6 +30,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "IUserConfigReader.h"
 #include "IMGUI.h"
 #include "FileSystem.h"
+#include "Tracing.h"
 
 /* implementation */
 void BlobbyApp::switchToState(std::unique_ptr<State> newState)
@@ -51,6 +52,8 @@ const char* BlobbyApp::getCurrenStateName() const
 
 void BlobbyApp::step()
 {
+	TRACE_SCOPE("BlobbyApp::step");
+
 	// perform a state step
 	mCurrentState->step_impl();
 
@@ -20,6 +20,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "BlobbyDebug.h"
 #include <string>
 #include <map>
+#include <mutex>
 #include <iostream>
 #include <fstream>
 
@@ -29,6 +30,13 @@ std::map<std::string, CountingReport>& GetCounterMap()
 	return CounterMap;
 }
 
+// guards the structure of the counter map. the counters themselves are atomic.
+std::mutex& GetCounterMapMutex()
+{
+	static std::mutex CounterMapMutex;
+	return CounterMapMutex;
+}
+
 std::map<void*, int>& GetAddressMap()
 {
 	static std::map<void*, int> AddressMap;
@@ -41,42 +49,44 @@ std::map<std::string, int>& GetProfMap()
 	return ProfMap;
 }
 
-int count(const std::type_info& type)
+CountingReport& getCountingReport(const std::type_info& type)
 {
-	std::string test = type.name();
-	if(GetCounterMap().find(type.name()) == GetCounterMap().end() )
-	{
-		GetCounterMap()[type.name()] = CountingReport();
-	}
+	std::lock_guard<std::mutex> lock(GetCounterMapMutex());
+	// std::map never moves its elements, so the reference stays valid
+	return GetCounterMap()[type.name()];
+}
 
-	GetCounterMap()[type.name()].created++;
-	return ++GetCounterMap()[type.name()].alive;
+int count(const std::type_info& type)
+{
+	CountingReport& report = getCountingReport(type);
+	report.created++;
+	return ++report.alive;
 }
 
 int uncount(const std::type_info& type)
 {
-	return --GetCounterMap()[type.name()].alive;
+	return --getCountingReport(type).alive;
 }
 
 int getObjectCount(const std::type_info& type)
 {
-	return 	GetCounterMap()[type.name()].alive;
+	return getCountingReport(type).alive;
 }
 
 int count(const std::type_info& type, std::string tag, int n)
 {
 	std::string name = std::string(type.name()) + " - " + std::move(tag);
-	if(GetCounterMap().find(name) == GetCounterMap().end() )
-	{
-		GetCounterMap()[name] = CountingReport();
-	}
-	GetCounterMap()[name].created += n;
-	return GetCounterMap()[name].alive += n;
+	std::lock_guard<std::mutex> lock(GetCounterMapMutex());
+	CountingReport& report = GetCounterMap()[name];
+	report.created += n;
+	return report.alive += n;
 }
 
 int uncount(const std::type_info& type, std::string tag, int n)
 {
-	return GetCounterMap()[std::string(type.name()) + " - " + std::move(tag)].alive -= n;
+	std::string name = std::string(type.name()) + " - " + std::move(tag);
+	std::lock_guard<std::mutex> lock(GetCounterMapMutex());
+	return GetCounterMap()[name].alive -= n;
 }
 
 int count(const std::type_info& type, std::string tag, void* address, int num)
@@ -111,6 +121,7 @@ void report(std::ostream& stream)
 {
 	stream << "MEMORY REPORT\n";
 	int sum = 0;
+	std::lock_guard<std::mutex> lock(GetCounterMapMutex());
 	for(auto& i : GetCounterMap())
 	{
 		stream << i.first << "\n- - - - - - - - - -\n";
@@ -22,12 +22,27 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <typeinfo>
 #include <iosfwd>
+#include <atomic>
 #include <utility>
 #include <cstddef>
 #include <cstdlib>
 #include <memory>
 #include <string>
 
+struct CountingReport
+{
+	CountingReport() : alive(0), created(0)
+	{
+
+	}
+
+	std::atomic<int> alive;
+	std::atomic<int> created;
+};
+
+/// gets the counters for objects of \p type. The returned reference stays valid forever.
+CountingReport& getCountingReport(const std::type_info& type);
+
 int count(const std::type_info& type);
 int uncount(const std::type_info& type);
 int count(const std::type_info& type, std::string tag, int num);
@@ -38,6 +53,8 @@ int uncount(const std::type_info& type, std::string tag, int num);
 	\details To use this class for logging creations of a class TYPE, just derive it
 			from ObjectCounter<TYPE>. A full memory report can be written to a stream
 			by the record function.
+			The counters of a type are looked up only once, so counting is cheap and does
+			not allocate memory, even for types like BitStream that are created for every packet.
 	\todo more specific reporting, watches, etc.
 */
 template<class Base>
@@ -46,37 +63,40 @@ class ObjectCounter
 	public:
 		ObjectCounter()
 		{
-			count(typeid(Base));
+			counted();
 		};
 
 		~ObjectCounter()
 		{
-			uncount(typeid(Base));
+			--getReport().alive;
 		};
 
 		ObjectCounter(const ObjectCounter& other)
 		{
-			count(typeid(Base));
+			counted();
 		}
 
 		ObjectCounter& operator=(const ObjectCounter& other) = default;
+
+	private:
+		static CountingReport& getReport()
+		{
+			static CountingReport& report = getCountingReport(typeid(Base));
+			return report;
+		}
+
+		static void counted()
+		{
+			CountingReport& report = getReport();
+			++report.created;
+			++report.alive;
+		}
 };
 
 
 void report(std::ostream& stream);
 int getObjectCount(const std::type_info& type);
 
-struct CountingReport
-{
-	CountingReport() : alive(0), created(0)
-	{
-
-	}
-
-	int alive;
-	int created;
-};
-
 // counting allocator
 template<class T, typename tag_type>
 struct CountingAllocator : private std::allocator<T>
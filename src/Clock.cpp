@@ -24,6 +24,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 /* includes */
 #include <sstream>
 
+#include "SimulationClock.h"
+
 /* implementation */
 
 namespace {
@@ -33,17 +35,33 @@ namespace {
 	}
 }
 
+Clock::Clock() : Clock(SimulationClock::createRealTimeClock())
+{
+}
+
+Clock::Clock(std::shared_ptr<const SimulationClock> time_source) :
+	mTimeSource(std::move(time_source)),
+	mLastTime(mTimeSource->now())
+{
+}
+
+void Clock::setTimeSource(std::shared_ptr<const SimulationClock> time_source)
+{
+	mTimeSource = std::move(time_source);
+	mLastTime = mTimeSource->now();
+}
+
 void Clock::reset()
 {
 	// set all variables to their default values
 	mRunning = false;
 	mGameRunning = duration_t(0);
-	mLastTime = clock_t::now();
+	mLastTime = mTimeSource->now();
 }
 
 void Clock::start()
 {
-	mLastTime = clock_t::now();
+	mLastTime = mTimeSource->now();
 	mRunning = true;
 }
 
@@ -108,7 +126,7 @@ void Clock::step()
 {
 	if(mRunning)
 	{
-		auto newTime = clock_t::now();
+		auto newTime = mTimeSource->now();
 		updateGameTime(mGameRunning + (newTime - mLastTime));
 		mLastTime = newTime;
 	}
@@ -22,6 +22,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <string>
 #include <chrono>
+#include <memory>
+
+class SimulationClock;
 
 /*! \class Clock
 	\brief Game Timing Management
@@ -36,8 +39,14 @@ class Clock
 		using clock_t = std::chrono::steady_clock;
 		using duration_t = clock_t::duration;
 
-		/// default c'tor
-		Clock() = default;
+		/// default c'tor, measures real time
+		Clock();
+		/// creates a clock that measures the time of \p time_source
+		explicit Clock(std::shared_ptr<const SimulationClock> time_source);
+
+		/// changes the time source used for measuring passed time.
+		/// The time measured so far is kept.
+		void setTimeSource(std::shared_ptr<const SimulationClock> time_source);
 
 		/// starts/unpauses the clock
 		void start();
@@ -65,6 +74,9 @@ class Clock
 		const std::string& getTimeString() const;
 
 	private:
+		/// source of the current time
+		std::shared_ptr<const SimulationClock> mTimeSource;
+
 		/// is the clock currently running?
 		bool mRunning{false};
 
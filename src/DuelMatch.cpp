@@ -30,10 +30,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "InputSource.h"
 #include "IUserConfigReader.h"
 #include "Clock.h"
+#include "SimulationClock.h"
+#include "Tracing.h"
 
 /* implementation */
 
-DuelMatch::DuelMatch(bool remote, const std::string& rules, int score_to_win) :
+DuelMatch::DuelMatch(bool remote, const std::string& rules, int score_to_win, std::shared_ptr<SimulationClock> clock) :
+		mSimulationClock(clock ? std::move(clock) : SimulationClock::createRealTimeClock()),
 		mPaused(false),
 		mRemote(remote)
 {
@@ -41,7 +44,7 @@ DuelMatch::DuelMatch(bool remote, const std::string& rules, int score_to_win) :
 		score_to_win = IUserConfigReader::createUserConfigReader("config.xml")->getInteger("scoretowin");
 	}
 
-	mLogic = createGameLogic(rules, score_to_win);
+	createLogic(rules, score_to_win);
 	mPhysicWorld.reset( new PhysicWorld() );
 
 	setInputSources(std::make_shared<InputSource>(), std::make_shared<InputSource>());
@@ -69,6 +72,7 @@ void DuelMatch::reset()
 {
 	mPhysicWorld.reset(new PhysicWorld());
 	mLogic = mLogic->clone();
+	mLogic->getClock().setTimeSource(mSimulationClock);
 }
 
 DuelMatch::~DuelMatch() = default;
@@ -77,16 +81,26 @@ void DuelMatch::setRules(const std::string& rulesFile, int score_to_win)
 {
 	if( score_to_win == 0)
 		score_to_win = getScoreToWin();
-	mLogic = createGameLogic(rulesFile, score_to_win);
+	createLogic(rulesFile, score_to_win);
+}
+
+void DuelMatch::createLogic(const std::string& rules, int score_to_win)
+{
+	mLogic = createGameLogic(rules, score_to_win);
+	mLogic->getClock().setTimeSource(mSimulationClock);
 }
 
 
 void DuelMatch::step()
 {
+	TRACE_SCOPE("DuelMatch::step");
+
 	// in pause mode, step does nothing
 	if(mPaused)
 		return;
 
+	mSimulationClock->advance();
+
 	mTransformedInput[LEFT_PLAYER] = mInputSources[LEFT_PLAYER]->updateInput().toPlayerInput(this);
 	mTransformedInput[RIGHT_PLAYER] = mInputSources[RIGHT_PLAYER]->updateInput().toPlayerInput(this);
 
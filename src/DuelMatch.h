@@ -34,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 class InputSource;
 struct DuelMatchState;
 class PhysicWorld;
+class SimulationClock;
 
 /*! \class DuelMatch
 	\brief class representing a blobby game.
@@ -49,8 +50,11 @@ class DuelMatch : public ObjectCounter<DuelMatch>
 	public:
 		// If remote is true, only physical responses will be calculated
 		// but hit events and score events are received from network
+		// All timing inside the match is measured with clock, which advances
+		// once per step. If no clock is given, real time is used.
 
-		DuelMatch(bool remote, const std::string& rules, int score_to_win = 0);
+		DuelMatch(bool remote, const std::string& rules, int score_to_win = 0,
+				  std::shared_ptr<SimulationClock> clock = nullptr);
 
 		void setPlayers(PlayerIdentity left_player, PlayerIdentity right_player);
 		void setInputSources(std::shared_ptr<InputSource> left_input, std::shared_ptr<InputSource> right_input );
@@ -95,6 +99,7 @@ class DuelMatch : public ObjectCounter<DuelMatch>
 		const PhysicWorld& getWorld() const{ return *mPhysicWorld; };
 
 		// Timing
+		const SimulationClock& getSimulationClock() const { return *mSimulationClock; }
 		const std::string& getTimeString() const;
 		void setMatchTimeMs(int milliseconds);
 
@@ -133,6 +138,10 @@ class DuelMatch : public ObjectCounter<DuelMatch>
 		void updateEvents();
 
 	private:
+		/// creates the game logic and connects its clock to mSimulationClock
+		void createLogic(const std::string& rules, int score_to_win);
+
+		std::shared_ptr<SimulationClock> mSimulationClock;
 
 		std::unique_ptr<PhysicWorld> mPhysicWorld;
 
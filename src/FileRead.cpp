@@ -22,7 +22,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "FileRead.h"
 
 /* includes */
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <mutex>
 
 #include <physfs.h>
 
@@ -149,34 +152,65 @@ std::string FileRead::readString()
 }
 
 
+namespace
+{
+	// checksum of a file, together with the file properties it was calculated for
+	struct CachedChecksum
+	{
+		PHYSFS_sint64 modtime;
+		PHYSFS_sint64 filesize;
+		uint32_t checksum;
+	};
+
+	std::mutex gChecksumCacheMutex;
+	std::map<std::pair<std::string, uint32_t>, CachedChecksum> gChecksumCache;
+}
+
 uint32_t FileRead::calcChecksum(uint32_t start)
 {
+	// an unchanged file does not need to be read again
+	PHYSFS_Stat stat;
+	bool has_stat = PHYSFS_stat(getFileName().c_str(), &stat) != 0 && stat.modtime >= 0;
+	auto key = std::make_pair(getFileName(), start);
+
+	if( has_stat )
+	{
+		std::lock_guard<std::mutex> lock(gChecksumCacheMutex);
+		auto cached = gChecksumCache.find(key);
+		if( cached != gChecksumCache.end() && cached->second.modtime == stat.modtime
+			&& cached->second.filesize == stat.filesize )
+		{
+			return cached->second.checksum;
+		}
+	}
+
 	uint32_t old_position = tell();
 	seek(start);
 
 	// buffered reading
-	char buffer[128];
-	size_t len = length();
+	std::vector<char> buffer(64 * 1024);
+	uint32_t len = length();
+	uint32_t remaining = start < len ? len - start : 0;
 
 	boost::crc_32_type crc;
 
-	while(true)
+	while( remaining > 0 )
 	{
-		int max_read = std::min( sizeof(buffer), len - tell());
-		readRawBytes( buffer, max_read );	// read into buffer
-
-		for( int i = 0; i < max_read; ++i)
-		{
-			crc.process_bytes( buffer, max_read);
-		}
-
-		if( max_read < 32)
-			break;
+		uint32_t max_read = std::min<uint32_t>( buffer.size(), remaining );
+		readRawBytes( buffer.data(), max_read );	// read into buffer
+		crc.process_bytes( buffer.data(), max_read );
+		remaining -= max_read;
 	}
 
 	// return read pointer back to old position
 	seek( old_position);
 
+	if( has_stat )
+	{
+		std::lock_guard<std::mutex> lock(gChecksumCacheMutex);
+		gChecksumCache[key] = CachedChecksum{stat.modtime, stat.filesize, crc()};
+	}
+
 	return crc();
 }
 
@@ -185,42 +219,58 @@ uint32_t FileRead::calcChecksum(uint32_t start)
 
 // reading lua script
 
-struct ReaderInfo
-{
-	FileRead file;
-	char buffer[2048];
-};
-
-static const char* chunkReader(lua_State* state, void* data, size_t *size)
+namespace
 {
-	ReaderInfo* info = (ReaderInfo*) data;
-
-	int bytesRead = 2048;
-	if(info->file.length() - info->file.tell() < 2048)
+	// compiled lua chunks, shared by all lua states of this process
+	struct CompiledChunk
 	{
-		bytesRead = info->file.length() - info->file.tell();
-	}
+		uint32_t checksum;
+		std::string bytecode;
+	};
 
-	info->file.readRawBytes(info->buffer, bytesRead);
-	// if this doesn't throw, bytesRead is the actual number of bytes read
-	/// \todo we must do sth about this code, its just plains awful.
-	/// 		File interface has to be improved to support such buffered reading.
-	*size = bytesRead;
-	if (bytesRead == 0)
-	{
-		return nullptr;
-	}
-	else
+	std::mutex gLuaChunkCacheMutex;
+	std::map<std::string, std::shared_ptr<const CompiledChunk>> gLuaChunkCache;
+
+	int chunkWriter(lua_State* state, const void* data, size_t size, void* target)
 	{
-		return info->buffer;
+		static_cast<std::string*>(target)->append(static_cast<const char*>(data), size);
+		return 0;
 	}
 }
 
 int FileRead::readLuaScript(const std::string& filename, lua_State* mState)
 {
-	ReaderInfo info;
-	info.file.open(makeLuaFilename(filename));
-	return lua_load(mState, chunkReader, &info, filename.c_str(), nullptr);
+	const std::string path = makeLuaFilename(filename);
+	FileRead file(path);
+	std::vector<char> source = file.readRawBytes(file.length());
+
+	boost::crc_32_type crc;
+	crc.process_bytes(source.data(), source.size());
+	const uint32_t checksum = crc();
+
+	std::shared_ptr<const CompiledChunk> chunk;
+	{
+		std::lock_guard<std::mutex> lock(gLuaChunkCacheMutex);
+		auto cached = gLuaChunkCache.find(path);
+		if(cached != gLuaChunkCache.end() && cached->second->checksum == checksum)
+			chunk = cached->second;
+	}
+
+	if(chunk)
+		return luaL_loadbufferx(mState, chunk->bytecode.data(), chunk->bytecode.size(), filename.c_str(), "b");
+
+	int error = luaL_loadbufferx(mState, source.data(), source.size(), filename.c_str(), nullptr);
+	if(error)
+		return error;
+
+	// keep the debug information, so errors in cached scripts still report their lines
+	auto compiled = std::make_shared<CompiledChunk>();
+	compiled->checksum = checksum;
+	lua_dump(mState, chunkWriter, &compiled->bytecode, 0);
+
+	std::lock_guard<std::mutex> lock(gLuaChunkCacheMutex);
+	gLuaChunkCache[path] = compiled;
+	return 0;
 }
 
 std::string FileRead::makeLuaFilename(std::string filename)
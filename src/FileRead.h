@@ -112,6 +112,8 @@ class FileRead : public File
 		
 		// helper function for checksum
 		/// calculates a crc checksum of the file contents beginning at posInFile till the end of the file.
+		/// \details The result is cached per file and start position, and reused as long as
+		///			modification time and size of the file stay the same.
 		uint32_t calcChecksum(uint32_t start);
 		
 		
@@ -119,6 +121,11 @@ class FileRead : public File
 		// 								LUA/XML reading helper function
 		// -----------------------------------------------------------------------------------------
 		static std::string makeLuaFilename(std::string filename);
+		/// \brief loads the lua script \p filename as a function onto the stack of \p mState
+		/// \details Compiled scripts are cached for the whole process, keyed by their path and
+		///			the checksum of their source. Loading an unchanged script again only reads
+		///			the file and skips the compilation.
+		/// \return the result of `lua_load`
 		static int readLuaScript(const std::string& filename, lua_State* mState);
 		
 		static XMLDocumentPtr readXMLDocument(const std::string& filename);
@@ -81,3 +81,13 @@ void FileWrite::write(const char* data, std::size_t length)
 		BOOST_THROW_EXCEPTION( PhysfsFileException(mFileName) );
 	}
 }
+
+void FileWrite::flush()
+{
+	check_file_open();
+
+	if( !PHYSFS_flush(reinterpret_cast<PHYSFS_file*>(mHandle)) )
+	{
+		BOOST_THROW_EXCEPTION( PhysfsFileException(mFileName) );
+	}
+}
@@ -98,4 +98,10 @@ class FileWrite : public File
 		/// \details writes \p length characters from \p data to the file
 		/// \throw PhysfsFileException when Physfs reports an error
 		void write(const char* data, std::size_t length);
+
+		/// \brief writes buffered data to disk
+		/// \details after this, everything written so far can be read by opening the file again.
+		/// \throw PhysfsFileException when Physfs reports an error
+		/// \throw NoFileOpenedException when called while no file is opened.
+		void flush();
 };
@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "IScriptableComponent.h"
 #include "PlayerInput.h"
 #include "Clock.h"
+#include "Tracing.h"
 
 
 int lua_to_int(lua_State* state, int index)
@@ -457,6 +458,22 @@ class LuaGameLogic : public FallbackGameLogic, public IScriptableComponent
 LuaGameLogic::LuaGameLogic( std::string filename, int score_to_win ) :
 	FallbackGameLogic( score_to_win ), mSourceFile(std::move(filename))
 {
+	acquireState("rules", [this]()
+	{
+		setGameConstants();
+		setGameFunctions();
+
+		// add functions
+		lua_register(mState, "score", luaScore);
+		lua_register(mState, "mistake", luaMistake);
+		lua_register(mState, "servingplayer", luaGetServingPlayer);
+		lua_register(mState, "time", luaGetGameTime);
+		lua_register(mState, "isgamerunning", luaIsGameRunning);
+
+		openScript("api");
+		openScript("rules_api");
+	});
+
 	lua_pushlightuserdata(mState, this);
 	lua_setglobal(mState, "__GAME_LOGIC_POINTER");
 
@@ -464,19 +481,7 @@ LuaGameLogic::LuaGameLogic( std::string filename, int score_to_win ) :
 	lua_pushnumber(mState, getScoreToWin());
 	lua_setglobal(mState, "SCORE_TO_WIN");
 
-	setGameConstants();
-	setGameFunctions();
-
-	// add functions
-	lua_register(mState, "score", luaScore);
-	lua_register(mState, "mistake", luaMistake);
-	lua_register(mState, "servingplayer", luaGetServingPlayer);
-	lua_register(mState, "time", luaGetGameTime);
-	lua_register(mState, "isgamerunning", luaIsGameRunning);
-
 	// now load script file
-	openScript("api");
-	openScript("rules_api");
 	openScript("rules/"+mSourceFile);
 
 	lua_getglobal(mState, "SCORE_TO_WIN");
@@ -500,6 +505,8 @@ LuaGameLogic::~LuaGameLogic() = default;
 
 PlayerSide LuaGameLogic::checkWin() const
 {
+	TRACE_SCOPE("LuaGameLogic::checkWin");
+
 	if (!getLuaFunction("IsWinning"))
 	{
 		return FallbackGameLogic::checkWin();
@@ -530,6 +537,8 @@ PlayerSide LuaGameLogic::checkWin() const
 
 PlayerInput LuaGameLogic::handleInput(PlayerInput ip, PlayerSide player)
 {
+	TRACE_SCOPE("LuaGameLogic::handleInput");
+
 	if (!getLuaFunction( "HandleInput" ))
 	{
 		return FallbackGameLogic::handleInput(ip, player);
@@ -557,6 +566,8 @@ PlayerInput LuaGameLogic::handleInput(PlayerInput ip, PlayerSide player)
 
 void LuaGameLogic::OnBallHitsPlayerHandler(PlayerSide side)
 {
+	TRACE_SCOPE("LuaGameLogic::OnBallHitsPlayerHandler");
+
 	updateLuaLogicState();
 
 	if (!getLuaFunction("OnBallHitsPlayer"))
@@ -574,6 +585,8 @@ void LuaGameLogic::OnBallHitsPlayerHandler(PlayerSide side)
 
 void LuaGameLogic::OnBallHitsWallHandler(PlayerSide side)
 {
+	TRACE_SCOPE("LuaGameLogic::OnBallHitsWallHandler");
+
 	updateLuaLogicState();
 
 	if (!getLuaFunction("OnBallHitsWall"))
@@ -592,6 +605,8 @@ void LuaGameLogic::OnBallHitsWallHandler(PlayerSide side)
 
 void LuaGameLogic::OnBallHitsNetHandler(PlayerSide side)
 {
+	TRACE_SCOPE("LuaGameLogic::OnBallHitsNetHandler");
+
 	updateLuaLogicState();
 
 	if (!getLuaFunction( "OnBallHitsNet" ))
@@ -611,6 +626,8 @@ void LuaGameLogic::OnBallHitsNetHandler(PlayerSide side)
 
 void LuaGameLogic::OnBallHitsGroundHandler(PlayerSide side)
 {
+	TRACE_SCOPE("LuaGameLogic::OnBallHitsGroundHandler");
+
 	updateLuaLogicState();
 
 	if (!getLuaFunction( "OnBallHitsGround" ))
@@ -630,6 +647,8 @@ void LuaGameLogic::OnBallHitsGroundHandler(PlayerSide side)
 
 void LuaGameLogic::OnGameHandler( const DuelMatchState& state )
 {
+	TRACE_SCOPE("LuaGameLogic::OnGameHandler");
+
 	setMatchState(state);
 	if (!getLuaFunction( "OnGame" ))
 	{
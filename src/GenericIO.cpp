@@ -162,127 +162,97 @@ class FileIn : public GenericIn
 //							Bitstream Output Class
 // -------------------------------------------------------------------------------------------------
 
-class NetworkOut : public GenericOut
+void NetworkOut::byte(const unsigned char& data)
 {
-	public:
-		explicit NetworkOut(RakNet::BitStream* stream) : mStream(stream)
-		{
-
-		}
-
-	private:
-		void byte(const unsigned char& data) override
-		{
-			mStream->Write(data);
-		}
-
-		void boolean(const bool& data) override
-		{
-			mStream->Write(data);
-		}
-
-		void uint32(const unsigned int& data) override
-		{
-			mStream->Write(data);
-		}
+	mStream->Write(data);
+}
 
-		void number(const float& data) override
-		{
-			mStream->Write(data);
-		}
+void NetworkOut::boolean(const bool& data)
+{
+	mStream->Write(data);
+}
 
-		void string(const std::string& string) override
-		{
-			uint32(string.size());
-			mStream->Write(string.c_str(), string.size());
-		}
+void NetworkOut::uint32(const unsigned int& data)
+{
+	mStream->Write(data);
+}
 
+void NetworkOut::number(const float& data)
+{
+	mStream->Write(data);
+}
 
-		unsigned int tell() const override
-		{
-			return mStream->GetNumberOfBitsUsed();
-		}
+void NetworkOut::string(const std::string& string)
+{
+	uint32(string.size());
+	mStream->Write(string.c_str(), string.size());
+}
 
-		void seek(unsigned int pos) const override
-		{
-			mStream->SetWriteOffset(pos);
-		}
+unsigned int NetworkOut::tell() const
+{
+	return mStream->GetNumberOfBitsUsed();
+}
 
-		void array(const char* data, unsigned int length) override
-		{
-			mStream->Write(data, length);
-		}
+void NetworkOut::seek(unsigned int pos) const
+{
+	mStream->SetWriteOffset(pos);
+}
 
-		RakNet::BitStream* mStream;
-};
+void NetworkOut::array(const char* data, unsigned int length)
+{
+	mStream->Write(data, length);
+}
 
 // -------------------------------------------------------------------------------------------------
 //							Bistream Input Class
 // -------------------------------------------------------------------------------------------------
 
-class NetworkIn : public GenericIn
+void NetworkIn::byte(unsigned char& data)
 {
-	public:
-		explicit NetworkIn(RakNet::BitStream* stream) : mStream(stream)
-		{
-
-		}
-
-	private:
-		void byte(unsigned char& data) override
-		{
-			mStream->Read(data);
-		}
-
-		void boolean(bool& data) override
-		{
-			mStream->Read(data);
-		}
-
-		void uint32( unsigned int& data) override
-		{
-			mStream->Read(data);
-		}
+	mStream->Read(data);
+}
 
-		void number( float& data) override
-		{
-			mStream->Read(data);
-		}
+void NetworkIn::boolean(bool& data)
+{
+	mStream->Read(data);
+}
 
-		void string( std::string& string) override
-		{
-			/// \todo this might be bad performance wise
-			unsigned int ts;
-			uint32(ts);
+void NetworkIn::uint32( unsigned int& data)
+{
+	mStream->Read(data);
+}
 
-			string.resize(ts);
-			for(unsigned int i = 0; i < ts; ++i)
-			{
-				unsigned char nc;
-				byte(nc);
-				string[i] = nc;
-			}
-		}
+void NetworkIn::number( float& data)
+{
+	mStream->Read(data);
+}
 
+void NetworkIn::string( std::string& string)
+{
+	unsigned int ts;
+	uint32(ts);
 
-		unsigned int tell() const override
-		{
-			return mStream->GetReadOffset();
-		}
+	// read directly into the string instead of going through byte() for every character
+	string.resize(ts);
+	if(ts > 0)
+		mStream->Read(&string[0], ts);
+}
 
-		void seek(unsigned int pos) const override
-		{
-			mStream->ResetReadPointer();
-			mStream->IgnoreBits(pos);
-		}
+unsigned int NetworkIn::tell() const
+{
+	return mStream->GetReadOffset();
+}
 
-		void array( char* data, unsigned int length) override
-		{
-			mStream->Read(data, length);
-		}
+void NetworkIn::seek(unsigned int pos) const
+{
+	mStream->ResetReadPointer();
+	mStream->IgnoreBits(pos);
+}
 
-		RakNet::BitStream* mStream;
-};
+void NetworkIn::array( char* data, unsigned int length)
+{
+	mStream->Read(data, length);
+}
 
 // -------------------------------------------------------------------------------------------------
 //							File Output Class
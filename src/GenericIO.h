@@ -143,6 +143,58 @@ class GenericIO
 		typedef tag tag_type;
 };
 
+/*! \class NetworkOut
+	\brief GenericOut that writes to a BitStream
+	\details In contrast to createGenericWriter, this class can be constructed directly
+			(e.g. on the stack), so no memory has to be allocated for serializing a packet.
+			The stream is not owned and has to outlive the writer.
+*/
+class NetworkOut final : public GenericOut
+{
+	public:
+		explicit NetworkOut(RakNet::BitStream* stream) : mStream(stream)
+		{
+		}
+
+		void byte(const unsigned char& data) override;
+		void boolean(const bool& data) override;
+		void uint32(const unsigned int& data) override;
+		void number(const float& data) override;
+		void string(const std::string& string) override;
+		void array(const char* data, unsigned int length) override;
+
+		unsigned int tell() const override;
+		void seek(unsigned int pos) const override;
+
+	private:
+		RakNet::BitStream* mStream;
+};
+
+/*! \class NetworkIn
+	\brief GenericIn that reads from a BitStream
+	\details Stack constructible counterpart to createGenericReader, see NetworkOut.
+*/
+class NetworkIn final : public GenericIn
+{
+	public:
+		explicit NetworkIn(RakNet::BitStream* stream) : mStream(stream)
+		{
+		}
+
+		void byte(unsigned char& data) override;
+		void boolean(bool& data) override;
+		void uint32(unsigned int& data) override;
+		void number(float& data) override;
+		void string(std::string& string) override;
+		void array(char* data, unsigned int length) override;
+
+		unsigned int tell() const override;
+		void seek(unsigned int pos) const override;
+
+	private:
+		RakNet::BitStream* mStream;
+};
+
 /*! \def USER_SERIALIZER_IMPLEMENTATION_HELPER
 	\brief Helper macro for autogenerated user serializers
 	\details use like this:
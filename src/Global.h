@@ -51,7 +51,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 const int BLOBBY_PORT = 1234;
 
 const int BLOBBY_VERSION_MAJOR = 0;
-const int BLOBBY_VERSION_MINOR = 107;
+const int BLOBBY_VERSION_MINOR = 108;
 
 const char AppTitle[] = "Blobby Volley 2 Version 1.1.1";
 const int BASE_RESOLUTION_X = 800;
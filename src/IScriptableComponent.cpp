@@ -9,33 +9,230 @@
 #include "PhysicWorld.h"
 
 #include <iostream>
-
-IScriptableComponent::IScriptableComponent() :
-		mState(luaL_newstate()), mDummyWorld(new PhysicWorld())
+#include <cstdlib>
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace
 {
-	// register this in the lua registry
-	lua_pushliteral(mState, "__C++_ScriptComponent__");
-	lua_pushlightuserdata(mState, (void*)this);
-	lua_settable(mState, LUA_REGISTRYINDEX);
+	const char* const COMPONENT_KEY = "__C++_ScriptComponent__";
+	const char* const SNAPSHOT_KEY = "__C++_GlobalSnapshot__";
+	const char* const TABLE_SNAPSHOT_KEY = "__C++_TableSnapshot__";
 
-	// open math lib
-	luaL_requiref(mState, "math", luaopen_math, 1);
-	luaL_requiref(mState, "base", luaopen_base, 1);
+	// idle states are kept for this many components of each kind
+	const std::size_t MAX_IDLE_STATES = 32;
+
+	// lua states of destroyed components, ready to be handed to the next component of the same kind
+	struct StatePool
+	{
+		std::mutex mutex;
+		std::map<std::string, std::vector<lua_State*>> idle;
+
+		~StatePool()
+		{
+			for(auto& kind : idle)
+				for(lua_State* state : kind.second)
+					lua_close(state);
+		}
+	};
+
+	StatePool& getStatePool()
+	{
+		static StatePool pool;
+		return pool;
+	}
+
+	// pushes a copy of the table at index. Tables inside of it are not copied.
+	void pushShallowCopy(lua_State* state, int index)
+	{
+		index = lua_absindex(state, index);
+		lua_newtable(state);
+		lua_pushnil(state);
+		while(lua_next(state, index))
+		{
+			lua_pushvalue(state, -2);
+			lua_insert(state, -2);
+			lua_rawset(state, -4);
+		}
+	}
+
+	// makes the table at target contain exactly the fields of the table at source
+	void resetTable(lua_State* state, int target, int source)
+	{
+		target = lua_absindex(state, target);
+		source = lua_absindex(state, source);
+
+		// remove the fields that source does not have.
+		// clearing fields is allowed while traversing a table.
+		lua_pushnil(state);
+		while(lua_next(state, target))
+		{
+			lua_pop(state, 1);
+			lua_pushvalue(state, -1);
+			lua_rawget(state, source);
+			bool known = !lua_isnil(state, -1);
+			lua_pop(state, 1);
+			if(!known)
+			{
+				lua_pushvalue(state, -1);
+				lua_pushnil(state);
+				lua_rawset(state, target);
+			}
+		}
+
+		// and reset all others to their old values
+		lua_pushnil(state);
+		while(lua_next(state, source))
+		{
+			lua_pushvalue(state, -2);
+			lua_insert(state, -2);
+			lua_rawset(state, target);
+		}
+	}
+
+	// copies the global table into the registry, and every table it contains, e.g. math,
+	// so a script that changes math.floor does not change it for the next user of the state.
+	void saveGlobals(lua_State* state)
+	{
+		lua_rawgeti(state, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS);
+		pushShallowCopy(state, -1);
+		lua_setfield(state, LUA_REGISTRYINDEX, SNAPSHOT_KEY);
+
+		// maps each table to its copy
+		lua_newtable(state);
+		lua_pushnil(state);
+		while(lua_next(state, -3))
+		{
+			// _G is the global table itself
+			if(lua_istable(state, -1) && !lua_rawequal(state, -1, -4))
+			{
+				pushShallowCopy(state, -1);
+				lua_rawset(state, -4);
+			}
+			else
+			{
+				lua_pop(state, 1);
+			}
+		}
+		lua_setfield(state, LUA_REGISTRYINDEX, TABLE_SNAPSHOT_KEY);
+		lua_pop(state, 1);
+	}
 
-	// disable potentially unsafe functions from base library
-	const char* hide_fns[] = {"dofile", "collectgarbage", "getmetatable", "loadfile", "load", "loadstring",
-							  "rawlen", "rawget", "rawset", "setmetatable"};
-	for(auto& fn : hide_fns) {
-		lua_pushnil(mState);
-		lua_setglobal(mState, fn);
+	// resets the global table and the tables in it to the copies made by saveGlobals
+	void restoreGlobals(lua_State* state)
+	{
+		lua_rawgeti(state, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS);
+		lua_getfield(state, LUA_REGISTRYINDEX, SNAPSHOT_KEY);
+		resetTable(state, -2, -1);
+		lua_pop(state, 2);
+
+		lua_getfield(state, LUA_REGISTRYINDEX, TABLE_SNAPSHOT_KEY);
+		lua_pushnil(state);
+		while(lua_next(state, -2))
+		{
+			resetTable(state, -2, -1);
+			lua_pop(state, 1);
+		}
+		lua_pop(state, 1);
 	}
 }
 
+IScriptableComponent::IScriptableComponent() :
+		mState(nullptr), mDummyWorld(new PhysicWorld()), mLuaRandom(rand())
+{
+}
+
 IScriptableComponent::~IScriptableComponent()
 {
+	if(!mState)
+		return;
+
+	lua_settop(mState, 0);
+	lua_pushstring(mState, COMPONENT_KEY);
+	lua_pushnil(mState);
+	lua_settable(mState, LUA_REGISTRYINDEX);
+
+	{
+		StatePool& pool = getStatePool();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		auto& idle = pool.idle[mStateKind];
+		if(idle.size() < MAX_IDLE_STATES)
+		{
+			idle.push_back(mState);
+			return;
+		}
+	}
+
 	lua_close(mState);
 }
 
+void IScriptableComponent::acquireState(const std::string& kind, const std::function<void()>& prepare)
+{
+	assert(!mState);
+	mStateKind = kind;
+
+	{
+		StatePool& pool = getStatePool();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		auto& idle = pool.idle[kind];
+		if(!idle.empty())
+		{
+			mState = idle.back();
+			idle.pop_back();
+		}
+	}
+
+	if(mState)
+	{
+		restoreGlobals(mState);
+	}
+	else
+	{
+		mState = luaL_newstate();
+
+		// open math lib
+		luaL_requiref(mState, "math", luaopen_math, 1);
+		setRandomFunctions();
+		luaL_requiref(mState, "base", luaopen_base, 1);
+
+		// disable potentially unsafe functions from base library
+		const char* hide_fns[] = {"dofile", "collectgarbage", "getmetatable", "loadfile", "load", "loadstring",
+								  "rawlen", "rawget", "rawset", "setmetatable"};
+		for(auto& fn : hide_fns) {
+			lua_pushnil(mState);
+			lua_setglobal(mState, fn);
+		}
+		lua_settop(mState, 0);
+
+		// register this in the lua registry, prepare might already call into lua
+		lua_pushstring(mState, COMPONENT_KEY);
+		lua_pushlightuserdata(mState, (void*)this);
+		lua_settable(mState, LUA_REGISTRYINDEX);
+
+		try
+		{
+			prepare();
+		}
+		catch(...)
+		{
+			// a half prepared state must not end up in the pool
+			lua_close(mState);
+			mState = nullptr;
+			throw;
+		}
+		lua_settop(mState, 0);
+		saveGlobals(mState);
+	}
+
+	// register this in the lua registry
+	lua_pushstring(mState, COMPONENT_KEY);
+	lua_pushlightuserdata(mState, (void*)this);
+	lua_settable(mState, LUA_REGISTRYINDEX);
+}
+
 void IScriptableComponent::openScript(const std::string& file)
 {
 	int error = FileRead::readLuaScript(file, mState);
@@ -106,7 +303,7 @@ void IScriptableComponent::setGameConstants()
 // helpers
 inline IScriptableComponent* getScriptComponent(lua_State* state)
 {
-	lua_pushliteral(state, "__C++_ScriptComponent__");
+	lua_pushstring(state, COMPONENT_KEY);
 	lua_gettable(state, LUA_REGISTRYINDEX);
 	void* result = lua_touserdata(state, -1);
 	lua_pop(state, 1);
@@ -148,6 +345,18 @@ struct IScriptableComponent::Access
 		auto sc = getScriptComponent( state );
 		return sc->mDummyWorld.get();
 	}
+
+	static BallTrajectory& getTrajectory( lua_State* state )
+	{
+		auto sc = getScriptComponent( state );
+		return sc->mBallTrajectory;
+	}
+
+	static std::mt19937& getRandom( lua_State* state )
+	{
+		auto sc = getScriptComponent( state );
+		return sc->mLuaRandom;
+	}
 };
 
 inline const DuelMatchState getMatchState( lua_State* state )  {
@@ -226,10 +435,64 @@ int get_serving_player( lua_State* state )
 	return 1;
 }
 
+// converts a ball state from lua coordinates into the physic world's coordinates
+inline BallTrajectory::BallState to_ball_state(float x, float y, float vx, float vy)
+{
+	return BallTrajectory::BallState{ Vector2{x, 600 - y}, Vector2{vx, -vy} };
+}
+
+int lua_pushballstate(lua_State* state, const BallTrajectory::BallState& ball)
+{
+	int ret = lua_pushvector(state, ball.position, VectorType::POSITION);
+	ret += lua_pushvector(state, ball.velocity, VectorType::VELOCITY);
+	return ret;
+}
+
+// searches for the step in which the ball crosses coordinate. position(i) has to return
+// the ball position after i steps, and is called for consecutive i starting at 1.
+// returns the number of steps, which is -1 if the coordinate is not crossed within five seconds,
+// and sets last_step to the last step that was evaluated.
+template<class F>
+int find_crossing(F&& position, bool x_axis, float initial, float coordinate, int& last_step)
+{
+	const bool init = initial < coordinate;
+
+	int steps = 0;
+	while(coordinate != initial && steps < 75 * 5)
+	{
+		steps++;
+		// check for the condition
+		auto pos = position(steps);
+		float v = x_axis ? pos.x : 600 - pos.y;
+		if( (v < coordinate) != init )
+			break;
+	}
+	last_step = steps;
+
+	// indicate failure
+	if(steps == 75 * 5)
+		steps = -1;
+
+	return steps;
+}
+
+// simulates the ball from start for steps steps, without the trajectory cache
+BallTrajectory::BallState simulate_uncached( lua_State* state, const BallTrajectory::BallState& start, int steps )
+{
+	PhysicWorld* world = getWorld( state );
+	world->setBallPosition( start.position );
+	world->setBallVelocity( start.velocity );
+	for(int i = 0; i < steps; ++i)
+	{
+		// set ball valid to false to ignore blobby bounces
+		world->step(PlayerInput(), PlayerInput(), false, true);
+	}
+	return {world->getBallPosition(), world->getBallVelocity()};
+}
+
 int simulate_steps( lua_State* state )
 {
 	/// \todo should we gather and return all events that happen to the ball on the way?
-	PhysicWorld* world = getWorld( state );
 	// get the initial ball settings
 	lua_checkstack(state, 5);
 	int steps = lua_tointeger( state, 1);
@@ -239,23 +502,23 @@ int simulate_steps( lua_State* state )
 	float vy = lua_tonumber( state, 5);
 	lua_pop( state, 5);
 
-	world->setBallPosition( Vector2{x, 600 - y} );
-	world->setBallVelocity( Vector2{vx, -vy});
-	for(int i = 0; i < steps; ++i)
+	auto start = to_ball_state(x, y, vx, vy);
+
+	// most of the time, bots simulate the current ball or a state it will reach anyway
+	auto& trajectory = IScriptableComponent::Access::getTrajectory( state );
+	int offset = trajectory.find( start.position, start.velocity );
+	steps = std::max(steps, 0);
+	if( offset >= 0 && steps < BallTrajectory::MAX_STEPS - offset )
 	{
-		// set ball valid to false to ignore blobby bounces
-		world->step(PlayerInput(), PlayerInput(), false, true);
+		return lua_pushballstate(state, trajectory.at( offset + steps ));
 	}
 
-	int ret = lua_pushvector(state, world->getBallPosition(), VectorType::POSITION);
-	ret += lua_pushvector(state, world->getBallVelocity(), VectorType::VELOCITY);
-	return ret;
+	return lua_pushballstate(state, simulate_uncached( state, start, steps ));
 }
 
 int simulate_until(lua_State* state)
 {
 	/// \todo should we gather and return all events that happen to the ball on the way?
-	PhysicWorld* world = getWorld( state );
 	// get the initial ball settings
 	lua_checkstack(state, 6);
 	float x = lua_tonumber( state, 1);
@@ -272,33 +535,120 @@ int simulate_until(lua_State* state)
 		lua_pushstring(state, "invalid condition specified: choose either 'x' or 'y'");
 		lua_error(state);
 	}
-	const bool init = ival < coordinate;
 
-	// set up the world
-	world->setBallPosition( Vector2{x, 600 - y} );
-	world->setBallVelocity( Vector2{vx, -vy});
+	auto start = to_ball_state(x, y, vx, vy);
+	int steps;
+	int last_step;
+	BallTrajectory::BallState result;
 
-	int steps = 0;
-	while(coordinate != ival && steps < 75 * 5)
+	auto& trajectory = IScriptableComponent::Access::getTrajectory( state );
+	int offset = trajectory.find( start.position, start.velocity );
+	// find_crossing looks at most five seconds ahead
+	if( offset >= 0 && offset + 75 * 5 < BallTrajectory::MAX_STEPS )
 	{
-		steps++;
-		// set ball valid to false to ignore blobby bounces
-		world->step(PlayerInput(), PlayerInput(), false, true);
-		// check for the condition
-		auto pos = world->getBallPosition();
-		float v = axis == "x" ? pos.x : 600 - pos.y;
-		if( (v < coordinate) != init )
-			break;
+		steps = find_crossing( [&](int i) { return trajectory.at(offset + i).position; },
+							   axis == "x", ival, coordinate, last_step);
+		result = trajectory.at(offset + last_step);
+	}
+	else
+	{
+		// set up the world
+		PhysicWorld* world = getWorld( state );
+		world->setBallPosition( start.position );
+		world->setBallVelocity( start.velocity );
+		steps = find_crossing( [&](int) {
+			// set ball valid to false to ignore blobby bounces
+			world->step(PlayerInput(), PlayerInput(), false, true);
+			return world->getBallPosition();
+		}, axis == "x", ival, coordinate, last_step);
+		result = {world->getBallPosition(), world->getBallVelocity()};
 	}
-	// indicate failure
-	if(steps == 75 * 5)
-		steps = -1;
 
 	lua_pushinteger(state, steps);
-	int ret = 1;
-	ret += lua_pushvector(state, world->getBallPosition(), VectorType::POSITION);
-	ret += lua_pushvector(state, world->getBallVelocity(), VectorType::VELOCITY);
-	return ret;
+	return 1 + lua_pushballstate(state, result);
+}
+
+int predict_ball(lua_State* state)
+{
+	int steps = std::max(0, lua_to_int( state, 1 ));
+	lua_pop( state, 1 );
+
+	auto& trajectory = IScriptableComponent::Access::getTrajectory( state );
+	if( steps >= BallTrajectory::MAX_STEPS )
+	{
+		return lua_pushballstate(state, simulate_uncached( state, trajectory.at(0), steps ));
+	}
+	return lua_pushballstate(state, trajectory.at(steps));
+}
+
+// time_until_x and time_until_y
+template<bool X_AXIS>
+int time_until(lua_State* state)
+{
+	const float coordinate = lua_tonumber( state, 1 );
+	lua_pop( state, 1 );
+
+	auto& trajectory = IScriptableComponent::Access::getTrajectory( state );
+	auto start = trajectory.at(0);
+	const float ival = X_AXIS ? start.position.x : 600 - start.position.y;
+
+	int last_step;
+	int steps = find_crossing( [&](int i) { return trajectory.at(i).position; },
+							   X_AXIS, ival, coordinate, last_step);
+
+	lua_pushinteger(state, steps);
+	return 1 + lua_pushballstate(state, trajectory.at(last_step));
+}
+
+// replacements for math.random and math.randomseed, which use the component's own generator
+// instead of the global one of the C library. Arguments behave as in the lua standard library.
+int math_random(lua_State* state)
+{
+	auto& random = IScriptableComponent::Access::getRandom(state);
+	double r = (double)random() * (1.0 / ((double)std::mt19937::max() + 1.0));
+	lua_Integer low, up;
+	switch (lua_gettop(state))
+	{
+		case 0:
+			lua_pushnumber(state, r);
+			return 1;
+		case 1:
+			low = 1;
+			up = luaL_checkinteger(state, 1);
+			break;
+		case 2:
+			low = luaL_checkinteger(state, 1);
+			up = luaL_checkinteger(state, 2);
+			break;
+		default:
+			return luaL_error(state, "wrong number of arguments");
+	}
+	luaL_argcheck(state, low <= up, 1, "interval is empty");
+	luaL_argcheck(state, low >= 0 || up <= LUA_MAXINTEGER + low, 1, "interval too large");
+	r *= (double)(up - low) + 1.0;
+	lua_pushinteger(state, (lua_Integer)r + low);
+	return 1;
+}
+
+int math_randomseed(lua_State* state)
+{
+	auto& random = IScriptableComponent::Access::getRandom(state);
+	random.seed( (std::mt19937::result_type)(lua_Integer)luaL_checknumber(state, 1) );
+	return 0;
+}
+
+void IScriptableComponent::setRandomFunctions()
+{
+	// expects the math table on top of the stack
+	lua_pushcfunction(mState, math_random);
+	lua_setfield(mState, -2, "random");
+	lua_pushcfunction(mState, math_randomseed);
+	lua_setfield(mState, -2, "randomseed");
+}
+
+void IScriptableComponent::seedLuaRandom(unsigned seed)
+{
+	mLuaRandom.seed(seed);
 }
 
 void IScriptableComponent::setGameFunctions()
@@ -314,6 +664,9 @@ void IScriptableComponent::setGameFunctions()
 	lua_register(mState, "get_serving_player", get_serving_player);
 	lua_register(mState, "simulate", simulate_steps);
 	lua_register(mState, "simulate_until", simulate_until);
+	lua_register(mState, "predict_ball", predict_ball);
+	lua_register(mState, "time_until_x", time_until<true>);
+	lua_register(mState, "time_until_y", time_until<false>);
 }
 
 const DuelMatchState& IScriptableComponent::getMatchState() const
@@ -323,4 +676,11 @@ const DuelMatchState& IScriptableComponent::getMatchState() const
 
 void IScriptableComponent::setMatchState(const DuelMatchState& state) {
 	mCachedState = state;
+
+	// key the trajectory on the ball as the scripts see it, i.e. after the conversion into
+	// lua coordinates and back that every simulate call performs.
+	const auto& position = state.getBallPosition();
+	const auto& velocity = state.getBallVelocity();
+	auto ball = to_ball_state(position.x, 600 - position.y, velocity.x, -velocity.y);
+	mBallTrajectory.setStart(ball.position, ball.velocity);
 }
\ No newline at end of file
@@ -22,7 +22,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <string>
 #include <memory>
+#include <functional>
+#include <random>
 #include "DuelMatchState.h"
+#include "BallTrajectory.h"
 
 struct lua_State;
 class DuelMatch;
@@ -39,6 +42,8 @@ struct ScriptException : public std::exception
 	\brief Base class for lua scripted objects.
 	\details Use this class as base class for objects that support lua scripting. It defines some commonly used functions to make
 			coding easier. Does not define any public methods.
+			The lua states are recycled: when a component is destroyed, its state is kept in a process wide pool
+			and handed to the next component of the same kind, see acquireState().
 */
 class IScriptableComponent
 {
@@ -51,6 +56,15 @@ class IScriptableComponent
 		IScriptableComponent();
 		virtual ~IScriptableComponent();
 
+		/// \brief provides mState, either recycled from an earlier component of the same \p kind or newly created.
+		/// \details \p prepare is only called for new states, after the base libraries are opened. Everything it
+		///			defines, usually the game constants, functions and api scripts, is kept when the state is recycled.
+		///			All globals that are added or changed afterwards, e.g. by the script of the component, are reset
+		///			before the state is handed out again. So are the fields of the tables that were globals at that
+		///			time, like math, but not tables nested deeper and not metatables.
+		///			Has to be called exactly once, before mState is used.
+		void acquireState(const std::string& kind, const std::function<void()>& prepare);
+
 		void openScript(const std::string& file);
 		void setLuaGlobal(const char* name, double value);
 		bool getLuaFunction(const char* name) const;
@@ -64,12 +78,27 @@ class IScriptableComponent
 
 		void setMatchState(const DuelMatchState& state);
 
+		/// seeds the generator behind the scripts' math.random
+		void seedLuaRandom(unsigned seed);
+
 		lua_State* mState;
 
 	private:
+		// kind of the state, as passed to acquireState
+		std::string mStateKind;
+
 		// we save a dummy physic world here to do simulations
 		std::unique_ptr<PhysicWorld> mDummyWorld;
 
 		DuelMatchState mCachedState;
+
+		// prediction of the current ball's flight, shared by all trajectory queries of one frame
+		BallTrajectory mBallTrajectory;
+
+		// every component has its own generator for math.random, so scripts running in
+		// different threads neither race nor influence each other.
+		std::mt19937 mLuaRandom;
+
+		void setRandomFunctions();
 };
 
@@ -34,7 +34,11 @@ class IUserConfigReader : public ObjectCounter<IUserConfigReader>
 {
 	public:
 		IUserConfigReader() = default;
-		static std::shared_ptr<IUserConfigReader> createUserConfigReader(const std::string& file);
+		/// \brief returns the parsed contents of \p file
+		/// \details The file is only read once; later calls share an immutable snapshot
+		///			of its contents, which is replaced when a UserConfig is saved to
+		///			\p file. Safe to call from multiple threads.
+		static std::shared_ptr<const IUserConfigReader> createUserConfigReader(const std::string& file);
 		virtual ~IUserConfigReader() = default;
 
 		virtual float getFloat(const std::string& name, float default_value = 0.f) const = 0;
@@ -0,0 +1,81 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "MappedFile.h"
+
+/* includes */
+#include <physfs.h>
+
+#if !(defined WIN32) && !(defined __SWITCH__)
+#define BLOBBY_USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "FileRead.h"
+
+/* implementation */
+
+MappedFile::MappedFile(const std::string& filename)
+{
+#ifdef BLOBBY_USE_MMAP
+	// if the file is inside an archive, opening it directly fails and we fall back to physfs
+	const char* directory = PHYSFS_getRealDir(filename.c_str());
+	if(directory)
+	{
+		std::string path = std::string(directory) + PHYSFS_getDirSeparator() + filename;
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if(fd >= 0)
+		{
+			struct stat info;
+			if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+			{
+				void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if(mapping != MAP_FAILED)
+				{
+					mData = static_cast<const char*>(mapping);
+					mSize = info.st_size;
+					mMapped = true;
+				}
+			}
+			::close(fd);
+		}
+	}
+#endif
+
+	if(!mMapped)
+	{
+		FileRead file(filename);
+		mBuffer = file.readRawBytes(file.length());
+		mData = mBuffer.data();
+		mSize = mBuffer.size();
+	}
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef BLOBBY_USE_MMAP
+	if(mMapped)
+		munmap(const_cast<char*>(mData), mSize);
+#endif
+}
@@ -0,0 +1,55 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*! \class MappedFile
+	\brief read only view of a whole file
+	\details Maps the file into memory if it is a plain file on disk and the platform
+			supports it, so large files can be accessed without reading them first.
+			Otherwise, e.g. for files inside archives, the content is read into a buffer.
+			The file is addressed by its physfs name.
+*/
+class MappedFile
+{
+	public:
+		/// opens the file
+		/// \throw FileLoadException if the file could not be opened
+		explicit MappedFile(const std::string& filename);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char* data() const { return mData; }
+		std::size_t size() const { return mSize; }
+
+		/// whether the file is memory mapped or read into a buffer
+		bool isMapped() const { return mMapped; }
+
+	private:
+		const char* mData = nullptr;
+		std::size_t mSize = 0;
+		bool mMapped = false;
+		std::vector<char> mBuffer;
+};
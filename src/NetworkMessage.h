@@ -51,6 +51,11 @@ enum MessageType
 	ID_LOBBY
 };
 
+// flags and size of the parts of a replay sent with ID_REPLAY
+const unsigned char REPLAY_PART_FIRST = 1;
+const unsigned char REPLAY_PART_LAST = 2;
+const unsigned REPLAY_PART_SIZE = 16 * 1024;
+
 // General Information:
 // 	Because the client may choose their side and the server rotates
 // 	everything if necessary, PlayerSide information may not be
@@ -61,26 +66,29 @@ enum MessageType
 // ID_INPUT_UPDATE = 63:
 // 	Description:
 // 		This packet is sent from client to server every frame.
-// 		It contains the current input state as three booleans.
+// 		It contains the current input state and acknowledges the
+// 		last ID_GAME_UPDATE the client has received.
 // 	Structure:
 // 		ID_INPUT_UPDATE
-// 		ID_TIMESTAMP
-// 		timestamp (int)
-// 		left keypress (bool)
-// 		right keypress (bool)
-// 		up keypress (bool)
+// 		timestamp (unsigned)
+// 		input (PlayerInputAbs)
+//		has acknowledged snapshot (bool)
+//		acknowledged snapshot sequence number (unsigned short)
 //
-// ID_PHYSIC_UPDATE:
+// ID_GAME_UPDATE:
 // 	Description:
-// 		The server sends this information of the current physics state
-// 		to all clients every frame. Local physic states will always
+// 		The server sends this information of the current match state
+// 		to all clients every frame. Local match states will always
 // 		be overwritten.
+//		The state is sent as quantized MatchSnapshot, encoded as difference
+//		to the snapshot that was sent age frames earlier. If age is 0, the
+//		packet contains a full snapshot.
 // 	Structure:
-// 		ID_PHYSIC_UPDATE
-// 		ID_TIMESTAMP
-// 		timestamp (int)
-//		packet_number (unsigned char)
-// 		Physic data (analysed by PhysicWorld)
+// 		ID_GAME_UPDATE
+// 		timestamp of last input (unsigned)
+//		sequence number (unsigned short)
+//		age (unsigned char)
+// 		snapshot data (see writeSnapshot)
 //
 // ID_GAME_READY
 // 	Description:
@@ -149,11 +157,14 @@ enum MessageType
 // ID_REPLAY
 // 	Description:
 // 		Sent from client to server to request a replay
-// 		Sent from server to client to transmit the replay
-// 	Structure:
+// 		Sent from server to client to transmit the replay. The replay file is split into a sequence
+//		of packets of at most REPLAY_PART_SIZE bytes of data each.
+// 	Structure (from client to server):
 // 		ID_REPLAY
-//		size (int)
-//		data
+// 	Structure (from server to client):
+// 		ID_REPLAY
+//		flags (unsigned char): REPLAY_PART_FIRST for the first, REPLAY_PART_LAST for the last part
+//		part of the replay file in the binary replay format (all remaining bytes of the packet)
 //
 // ID_RULES_CHECKSUM
 // 	Description:
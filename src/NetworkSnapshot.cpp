@@ -0,0 +1,274 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "NetworkSnapshot.h"
+
+/* includes */
+#include <cmath>
+
+#include "raknet/BitStream.h"
+
+/* implementation */
+
+namespace
+{
+	// fixed point scales. powers of two, so extrapolate can convert between them exactly.
+	const int POSITION_SCALE = 256;
+	const int VELOCITY_SCALE = 1024;
+	const int ANGLE_SCALE = 4096;
+	const int BLOB_STATE_SCALE = 256;
+
+	// bit widths a delta can be written with. selected with two bits per changed field.
+	const int DELTA_WIDTHS[4] = {4, 8, 16, 32};
+
+	std::int32_t quantize(float value, int scale)
+	{
+		return static_cast<std::int32_t>( std::lround(value * scale) );
+	}
+
+	float dequantize(std::int32_t value, int scale)
+	{
+		return static_cast<float>(value) / scale;
+	}
+
+	void writeVector(std::int32_t* target, const Vector2& v, int scale)
+	{
+		target[0] = quantize(v.x, scale);
+		target[1] = quantize(v.y, scale);
+	}
+
+	Vector2 readVector(const std::int32_t* source, int scale)
+	{
+		return Vector2(dequantize(source[0], scale), dequantize(source[1], scale));
+	}
+
+	void writeBits(RakNet::BitStream& stream, std::uint32_t value, int bits)
+	{
+		for(; bits > 0; bits -= 8, value >>= 8)
+		{
+			unsigned char byte = value & 0xFF;
+			stream.WriteBits(&byte, bits < 8 ? bits : 8, true);
+		}
+	}
+
+	bool readBits(RakNet::BitStream& stream, std::uint32_t& value, int bits)
+	{
+		value = 0;
+		for(int shift = 0; shift < bits; shift += 8)
+		{
+			unsigned char byte = 0;
+			if(!stream.ReadBits(&byte, bits - shift < 8 ? bits - shift : 8, true))
+				return false;
+			value |= std::uint32_t(byte) << shift;
+		}
+		return true;
+	}
+
+	// maps signed deltas to unsigned values, so that small deltas of either sign need few bits
+	std::uint32_t zigzag(std::uint32_t delta)
+	{
+		return (delta << 1) ^ (0u - (delta >> 31));
+	}
+
+	std::uint32_t unzigzag(std::uint32_t value)
+	{
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	const MatchSnapshot& zeroSnapshot()
+	{
+		static const MatchSnapshot zero = [](){ MatchSnapshot s; s.fields.fill(0); return s; }();
+		return zero;
+	}
+}
+
+MatchSnapshot MatchSnapshot::fromState(const DuelMatchState& state)
+{
+	MatchSnapshot s;
+	auto& f = s.fields;
+	const PhysicState& world = state.worldState;
+	const GameLogicState& logic = state.logicState;
+
+	writeVector(&f[LEFT_BLOB_POS_X], world.blobPosition[LEFT_PLAYER], POSITION_SCALE);
+	writeVector(&f[LEFT_BLOB_VEL_X], world.blobVelocity[LEFT_PLAYER], VELOCITY_SCALE);
+	writeVector(&f[RIGHT_BLOB_POS_X], world.blobPosition[RIGHT_PLAYER], POSITION_SCALE);
+	writeVector(&f[RIGHT_BLOB_VEL_X], world.blobVelocity[RIGHT_PLAYER], VELOCITY_SCALE);
+	f[LEFT_BLOB_STATE] = quantize(world.blobState[LEFT_PLAYER], BLOB_STATE_SCALE);
+	f[RIGHT_BLOB_STATE] = quantize(world.blobState[RIGHT_PLAYER], BLOB_STATE_SCALE);
+	writeVector(&f[BALL_POS_X], world.ballPosition, POSITION_SCALE);
+	writeVector(&f[BALL_VEL_X], world.ballVelocity, VELOCITY_SCALE);
+	f[BALL_ROTATION] = quantize(world.ballRotation, ANGLE_SCALE);
+	f[BALL_ANGULAR_VELOCITY] = quantize(world.ballAngularVelocity, ANGLE_SCALE);
+
+	f[LEFT_SCORE] = logic.leftScore;
+	f[RIGHT_SCORE] = logic.rightScore;
+	f[LEFT_HIT_COUNT] = logic.hitCount[LEFT_PLAYER];
+	f[RIGHT_HIT_COUNT] = logic.hitCount[RIGHT_PLAYER];
+	f[SERVING_PLAYER] = logic.servingPlayer;
+	f[WINNING_PLAYER] = logic.winningPlayer;
+	f[LEFT_SQUISH] = logic.squish[LEFT_PLAYER];
+	f[RIGHT_SQUISH] = logic.squish[RIGHT_PLAYER];
+	f[SQUISH_WALL] = logic.squishWall;
+	f[SQUISH_GROUND] = logic.squishGround;
+	f[GAME_RUNNING] = logic.isGameRunning;
+	f[BALL_VALID] = logic.isBallValid;
+
+	f[LEFT_INPUT] = state.playerInput[LEFT_PLAYER].getAll();
+	f[RIGHT_INPUT] = state.playerInput[RIGHT_PLAYER].getAll();
+
+	return s;
+}
+
+DuelMatchState MatchSnapshot::toState() const
+{
+	DuelMatchState state;
+	const auto& f = fields;
+	PhysicState& world = state.worldState;
+	GameLogicState& logic = state.logicState;
+
+	world.blobPosition[LEFT_PLAYER] = readVector(&f[LEFT_BLOB_POS_X], POSITION_SCALE);
+	world.blobVelocity[LEFT_PLAYER] = readVector(&f[LEFT_BLOB_VEL_X], VELOCITY_SCALE);
+	world.blobPosition[RIGHT_PLAYER] = readVector(&f[RIGHT_BLOB_POS_X], POSITION_SCALE);
+	world.blobVelocity[RIGHT_PLAYER] = readVector(&f[RIGHT_BLOB_VEL_X], VELOCITY_SCALE);
+	world.blobState[LEFT_PLAYER] = dequantize(f[LEFT_BLOB_STATE], BLOB_STATE_SCALE);
+	world.blobState[RIGHT_PLAYER] = dequantize(f[RIGHT_BLOB_STATE], BLOB_STATE_SCALE);
+	world.ballPosition = readVector(&f[BALL_POS_X], POSITION_SCALE);
+	world.ballVelocity = readVector(&f[BALL_VEL_X], VELOCITY_SCALE);
+	world.ballRotation = dequantize(f[BALL_ROTATION], ANGLE_SCALE);
+	world.ballAngularVelocity = dequantize(f[BALL_ANGULAR_VELOCITY], ANGLE_SCALE);
+
+	logic.leftScore = f[LEFT_SCORE];
+	logic.rightScore = f[RIGHT_SCORE];
+	logic.hitCount[LEFT_PLAYER] = f[LEFT_HIT_COUNT];
+	logic.hitCount[RIGHT_PLAYER] = f[RIGHT_HIT_COUNT];
+	logic.servingPlayer = static_cast<PlayerSide>(f[SERVING_PLAYER]);
+	logic.winningPlayer = static_cast<PlayerSide>(f[WINNING_PLAYER]);
+	logic.squish[LEFT_PLAYER] = f[LEFT_SQUISH];
+	logic.squish[RIGHT_PLAYER] = f[RIGHT_SQUISH];
+	logic.squishWall = f[SQUISH_WALL];
+	logic.squishGround = f[SQUISH_GROUND];
+	logic.isGameRunning = f[GAME_RUNNING] != 0;
+	logic.isBallValid = f[BALL_VALID] != 0;
+
+	state.playerInput[LEFT_PLAYER].setAll( f[LEFT_INPUT] );
+	state.playerInput[RIGHT_PLAYER].setAll( f[RIGHT_INPUT] );
+
+	return state;
+}
+
+MatchSnapshot MatchSnapshot::extrapolate(unsigned steps) const
+{
+	MatchSnapshot s = *this;
+	auto move = [&](Field pos, Field vel, int ratio)
+	{
+		std::int64_t offset = std::int64_t(fields[vel]) * steps / ratio;
+		s.fields[pos] = std::uint32_t(fields[pos]) + std::uint32_t(offset);
+	};
+
+	const int vel_to_pos = VELOCITY_SCALE / POSITION_SCALE;
+	move(LEFT_BLOB_POS_X, LEFT_BLOB_VEL_X, vel_to_pos);
+	move(LEFT_BLOB_POS_Y, LEFT_BLOB_VEL_Y, vel_to_pos);
+	move(RIGHT_BLOB_POS_X, RIGHT_BLOB_VEL_X, vel_to_pos);
+	move(RIGHT_BLOB_POS_Y, RIGHT_BLOB_VEL_Y, vel_to_pos);
+	move(BALL_POS_X, BALL_VEL_X, vel_to_pos);
+	move(BALL_POS_Y, BALL_VEL_Y, vel_to_pos);
+	move(BALL_ROTATION, BALL_ANGULAR_VELOCITY, 1);
+
+	return s;
+}
+
+bool MatchSnapshot::operator==(const MatchSnapshot& other) const
+{
+	return fields == other.fields;
+}
+
+void writeSnapshot(RakNet::BitStream& stream, const MatchSnapshot& snapshot, const MatchSnapshot* base, unsigned age)
+{
+	const MatchSnapshot predicted = base ? base->extrapolate(age) : zeroSnapshot();
+
+	for(int i = 0; i < MatchSnapshot::FIELD_COUNT; ++i)
+	{
+		std::uint32_t delta = zigzag( std::uint32_t(snapshot.fields[i]) - std::uint32_t(predicted.fields[i]) );
+		if(delta == 0)
+		{
+			stream.Write(false);
+			continue;
+		}
+
+		stream.Write(true);
+		unsigned char width = 0;
+		while( width < 3 && (delta >> DELTA_WIDTHS[width]) != 0 )
+			++width;
+		writeBits(stream, width, 2);
+		writeBits(stream, delta, DELTA_WIDTHS[width]);
+	}
+}
+
+bool readSnapshot(RakNet::BitStream& stream, MatchSnapshot& snapshot, const MatchSnapshot* base, unsigned age)
+{
+	const MatchSnapshot predicted = base ? base->extrapolate(age) : zeroSnapshot();
+
+	for(int i = 0; i < MatchSnapshot::FIELD_COUNT; ++i)
+	{
+		bool changed;
+		if(!stream.Read(changed))
+			return false;
+
+		std::uint32_t delta = 0;
+		if(changed)
+		{
+			std::uint32_t width;
+			if(!readBits(stream, width, 2) || !readBits(stream, delta, DELTA_WIDTHS[width]))
+				return false;
+		}
+
+		snapshot.fields[i] = std::uint32_t(predicted.fields[i]) + unzigzag(delta);
+	}
+
+	return true;
+}
+
+SnapshotHistory::SnapshotHistory()
+{
+	clear();
+}
+
+void SnapshotHistory::store(std::uint16_t sequence, const MatchSnapshot& snapshot)
+{
+	Slot& slot = mSlots[sequence % SIZE];
+	slot.valid = true;
+	slot.sequence = sequence;
+	slot.snapshot = snapshot;
+}
+
+const MatchSnapshot* SnapshotHistory::find(std::uint16_t sequence) const
+{
+	const Slot& slot = mSlots[sequence % SIZE];
+	if(!slot.valid || slot.sequence != sequence)
+		return nullptr;
+	return &slot.snapshot;
+}
+
+void SnapshotHistory::clear()
+{
+	for(auto& slot : mSlots)
+		slot.valid = false;
+}
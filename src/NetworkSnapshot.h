@@ -0,0 +1,109 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "DuelMatchState.h"
+
+namespace RakNet
+{
+	class BitStream;
+}
+
+/*! \struct MatchSnapshot
+	\brief quantized DuelMatchState, as it is transmitted in ID_GAME_UPDATE
+	\details Positions, velocities and angles are stored as fixed point integers,
+			the game logic state and the player input are stored as they are.
+			Converting a state into a snapshot and back loses precision, but converting
+			a snapshot into a state and back always yields the same snapshot.
+*/
+struct MatchSnapshot
+{
+	enum Field
+	{
+		// physic state
+		LEFT_BLOB_POS_X, LEFT_BLOB_POS_Y, LEFT_BLOB_VEL_X, LEFT_BLOB_VEL_Y,
+		RIGHT_BLOB_POS_X, RIGHT_BLOB_POS_Y, RIGHT_BLOB_VEL_X, RIGHT_BLOB_VEL_Y,
+		LEFT_BLOB_STATE, RIGHT_BLOB_STATE,
+		BALL_POS_X, BALL_POS_Y, BALL_VEL_X, BALL_VEL_Y,
+		BALL_ROTATION, BALL_ANGULAR_VELOCITY,
+		// game logic state
+		LEFT_SCORE, RIGHT_SCORE, LEFT_HIT_COUNT, RIGHT_HIT_COUNT,
+		SERVING_PLAYER, WINNING_PLAYER,
+		LEFT_SQUISH, RIGHT_SQUISH, SQUISH_WALL, SQUISH_GROUND,
+		GAME_RUNNING, BALL_VALID,
+		// input
+		LEFT_INPUT, RIGHT_INPUT,
+		FIELD_COUNT
+	};
+
+	std::array<std::int32_t, FIELD_COUNT> fields;
+
+	static MatchSnapshot fromState(const DuelMatchState& state);
+	DuelMatchState toState() const;
+
+	/// predicts this snapshot \p steps steps into the future by moving all objects along their velocity.
+	/// Only used to get small deltas, so this does not need to be accurate, but it has to be exact
+	/// in the sense that it gives the same result everywhere.
+	MatchSnapshot extrapolate(unsigned steps) const;
+
+	bool operator==(const MatchSnapshot& other) const;
+};
+
+/// writes \p snapshot into \p stream. If \p base is given, only the difference to
+/// the base snapshot, which has been sent \p age steps earlier, is written. Otherwise,
+/// the snapshot is written as a keyframe.
+void writeSnapshot(RakNet::BitStream& stream, const MatchSnapshot& snapshot, const MatchSnapshot* base, unsigned age);
+
+/// reads a snapshot that has been written with writeSnapshot. \p base and \p age have to be the
+/// same that were used when writing.
+/// \return false, if the stream did not contain enough data.
+bool readSnapshot(RakNet::BitStream& stream, MatchSnapshot& snapshot, const MatchSnapshot* base, unsigned age);
+
+/*! \class SnapshotHistory
+	\brief remembers the last snapshots sent to or received from a peer
+	\details The snapshots are identified by a 16 bit sequence number. Only the latest
+			SIZE snapshots are kept, so that older snapshots can no longer be used as base.
+*/
+class SnapshotHistory
+{
+	public:
+		static const unsigned SIZE = 32;
+
+		SnapshotHistory();
+
+		void store(std::uint16_t sequence, const MatchSnapshot& snapshot);
+		/// \return the snapshot with sequence number \p sequence, or nullptr if it is no longer known.
+		const MatchSnapshot* find(std::uint16_t sequence) const;
+		void clear();
+
+	private:
+		struct Slot
+		{
+			bool valid;
+			std::uint16_t sequence;
+			MatchSnapshot snapshot;
+		};
+
+		std::array<Slot, SIZE> mSlots;
+};
@@ -26,15 +26,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "GameConstants.h"
 #include "MatchEvents.h"
+#include "Tracing.h"
 
 /* implementation */
-// Gamefeeling relevant constants:
-const float BLOBBY_ANIMATION_SPEED = 0.5;
-
-// helper function for setting FPU precision
-inline short set_fpu_single_precision();
-void reset_fpu_flags(short flags);
-
 PhysicWorld::PhysicWorld()
 : mBallPosition(Vector2(200, STANDARD_BALL_HEIGHT))
 , mBallRotation(0)
@@ -211,6 +205,8 @@ bool PhysicWorld::handleBlobbyBallCollision(PlayerSide player)
 void PhysicWorld::step(const PlayerInput& leftInput, const PlayerInput& rightInput,
 					bool isBallValid, bool isGameRunning)
 {
+	TRACE_SCOPE("PhysicWorld::step");
+
 	// Deterministic IEEE 754 floating point computations
 	short fpf = set_fpu_single_precision();
 
@@ -403,7 +399,7 @@ void PhysicWorld::setEventCallback( event_callback_fn cb )
 	mCallback = std::move(cb);
 }
 
-inline short set_fpu_single_precision()
+short set_fpu_single_precision()
 {
 	short fl = 0;
 	#if defined(i386) || defined(__x86_64) // We need to set a precision for diverse x86 hardware
@@ -28,6 +28,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "MatchEvents.h"
 #include <functional>	// for std::function used for the callback
 
+// helper functions for setting FPU precision, so that the physics are deterministic
+// on x87 FPUs. set_fpu_single_precision returns the previous flags.
+short set_fpu_single_precision();
+void reset_fpu_flags(short flags);
+
 /*! \brief blobby world
 	\details This class encapsulates the physical world where blobby happens. It manages the two blobs,
 			the ball and collisions between them and the environment, it calculates object movements etc.
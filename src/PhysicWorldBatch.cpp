@@ -0,0 +1,579 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "PhysicWorldBatch.h"
+
+/* includes */
+#include <cassert>
+#include <cmath>
+
+#include "GameConstants.h"
+#include "PhysicWorld.h"
+#include "Tracing.h"
+
+#if defined(__AVX__)
+#define BLOBBY_PHYSICS_AVX
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define BLOBBY_PHYSICS_SSE
+#include <xmmintrin.h>
+#endif
+
+/* implementation */
+namespace
+{
+	// the arrays are padded to this many matches, so every vector width steps full vectors
+	const std::size_t BATCH_PADDING = 8;
+
+	/// the smallest float that is greater than \p value
+	float smallestFloatAbove(double value)
+	{
+		float candidate = static_cast<float>(value);
+		return candidate > value ? candidate : std::nextafter(candidate, 1.f);
+	}
+
+	// Vector2::normalise compares the float length with the double 1e-08
+	const float NORMALISE_MIN_LENGTH = smallestFloatAbove(1e-08);
+
+	/// one float per match, with the conditions as booleans
+	struct ScalarLanes
+	{
+		typedef float Pack;
+		typedef bool Mask;
+		static constexpr int WIDTH = 1;
+
+		static Pack load(const float* source) { return *source; }
+		static void store(float* target, Pack value) { *target = value; }
+		static Pack set(float value) { return value; }
+
+		static Pack add(Pack a, Pack b) { return a + b; }
+		static Pack sub(Pack a, Pack b) { return a - b; }
+		static Pack mul(Pack a, Pack b) { return a * b; }
+		static Pack div(Pack a, Pack b) { return a / b; }
+		static Pack sqrt(Pack a) { return std::sqrt(a); }
+		static Pack neg(Pack a) { return -a; }
+		static Pack abs(Pack a) { return std::fabs(a); }
+
+		static Mask less(Pack a, Pack b) { return a < b; }
+		static Mask lessEqual(Pack a, Pack b) { return a <= b; }
+		static Mask greater(Pack a, Pack b) { return a > b; }
+		static Mask greaterEqual(Pack a, Pack b) { return a >= b; }
+		static Mask equal(Pack a, Pack b) { return a == b; }
+
+		static Mask both(Mask a, Mask b) { return a && b; }
+		static Mask either(Mask a, Mask b) { return a || b; }
+		/// \p a and not \p b
+		static Mask butNot(Mask a, Mask b) { return a && !b; }
+		static Pack select(Mask condition, Pack a, Pack b) { return condition ? a : b; }
+		/// one bit per lane
+		static int bits(Mask m) { return m ? 1 : 0; }
+	};
+
+#ifdef BLOBBY_PHYSICS_SSE
+	struct SSELanes
+	{
+		typedef __m128 Pack;
+		typedef __m128 Mask;
+		static constexpr int WIDTH = 4;
+
+		static Pack load(const float* source) { return _mm_loadu_ps(source); }
+		static void store(float* target, Pack value) { _mm_storeu_ps(target, value); }
+		static Pack set(float value) { return _mm_set1_ps(value); }
+
+		static Pack add(Pack a, Pack b) { return _mm_add_ps(a, b); }
+		static Pack sub(Pack a, Pack b) { return _mm_sub_ps(a, b); }
+		static Pack mul(Pack a, Pack b) { return _mm_mul_ps(a, b); }
+		static Pack div(Pack a, Pack b) { return _mm_div_ps(a, b); }
+		static Pack sqrt(Pack a) { return _mm_sqrt_ps(a); }
+		static Pack neg(Pack a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+		static Pack abs(Pack a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+
+		static Mask less(Pack a, Pack b) { return _mm_cmplt_ps(a, b); }
+		static Mask lessEqual(Pack a, Pack b) { return _mm_cmple_ps(a, b); }
+		static Mask greater(Pack a, Pack b) { return _mm_cmpgt_ps(a, b); }
+		static Mask greaterEqual(Pack a, Pack b) { return _mm_cmpge_ps(a, b); }
+		static Mask equal(Pack a, Pack b) { return _mm_cmpeq_ps(a, b); }
+
+		static Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+		static Mask either(Mask a, Mask b) { return _mm_or_ps(a, b); }
+		static Mask butNot(Mask a, Mask b) { return _mm_andnot_ps(b, a); }
+		static Pack select(Mask condition, Pack a, Pack b)
+		{
+			return _mm_or_ps(_mm_and_ps(condition, a), _mm_andnot_ps(condition, b));
+		}
+		static int bits(Mask m) { return _mm_movemask_ps(m); }
+	};
+#endif
+
+#ifdef BLOBBY_PHYSICS_AVX
+	struct AVXLanes
+	{
+		typedef __m256 Pack;
+		typedef __m256 Mask;
+		static constexpr int WIDTH = 8;
+
+		static Pack load(const float* source) { return _mm256_loadu_ps(source); }
+		static void store(float* target, Pack value) { _mm256_storeu_ps(target, value); }
+		static Pack set(float value) { return _mm256_set1_ps(value); }
+
+		static Pack add(Pack a, Pack b) { return _mm256_add_ps(a, b); }
+		static Pack sub(Pack a, Pack b) { return _mm256_sub_ps(a, b); }
+		static Pack mul(Pack a, Pack b) { return _mm256_mul_ps(a, b); }
+		static Pack div(Pack a, Pack b) { return _mm256_div_ps(a, b); }
+		static Pack sqrt(Pack a) { return _mm256_sqrt_ps(a); }
+		static Pack neg(Pack a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.f)); }
+		static Pack abs(Pack a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+
+		static Mask less(Pack a, Pack b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static Mask lessEqual(Pack a, Pack b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		static Mask greater(Pack a, Pack b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		static Mask greaterEqual(Pack a, Pack b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+		static Mask equal(Pack a, Pack b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+
+		static Mask both(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+		static Mask either(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+		static Mask butNot(Mask a, Mask b) { return _mm256_andnot_ps(b, a); }
+		// not _mm256_blendv_ps, which gcc splits into single lanes when AVX2 is not available
+		static Pack select(Mask condition, Pack a, Pack b)
+		{
+			return _mm256_or_ps(_mm256_and_ps(condition, a), _mm256_andnot_ps(condition, b));
+		}
+		static int bits(Mask m) { return _mm256_movemask_ps(m); }
+	};
+#endif
+
+#if defined(BLOBBY_PHYSICS_AVX)
+	typedef AVXLanes BatchLanes;
+#elif defined(BLOBBY_PHYSICS_SSE)
+	typedef SSELanes BatchLanes;
+#else
+	typedef ScalarLanes BatchLanes;
+#endif
+
+	/// the ball hits the top of the net. This happens rarely, so it is calculated for a single match,
+	/// with exactly the operations of PhysicWorld::handleBallWorldCollisions
+	void bounceOffNetTop(Vector2& position, Vector2& velocity)
+	{
+		Vector2 normal = Vector2(position, Vector2(NET_POSITION_X, NET_SPHERE_POSITION)).normalise();
+
+		// normal component of kinetic energy
+		float perp_ekin = normal.dotProduct(velocity);
+		perp_ekin *= perp_ekin;
+		// parallel component of kinetic energy
+		float para_ekin = velocity.lengthSQ() - perp_ekin;
+
+		// these are double multiplications in PhysicWorld, too
+		perp_ekin *= 0.7;
+		para_ekin *= 0.9;
+
+		float new_speed = sqrt( perp_ekin + para_ekin );
+
+		velocity = Vector2(velocity.reflect(normal).normalise().scale(new_speed));
+		position = (Vector2(NET_POSITION_X, NET_SPHERE_POSITION) - normal * (NET_RADIUS + BALL_RADIUS));
+	}
+}
+
+PhysicWorldBatch::PhysicWorldBatch(std::size_t count) : mCount(count)
+{
+	std::size_t padded = (count + BATCH_PADDING - 1) / BATCH_PADDING * BATCH_PADDING;
+
+	mBallPositionX.assign(padded, 200);
+	mBallPositionY.assign(padded, STANDARD_BALL_HEIGHT);
+	mBallVelocityX.assign(padded, 0);
+	mBallVelocityY.assign(padded, 0);
+	mBallRotation.assign(padded, 0);
+	mBallAngularVelocity.assign(padded, STANDARD_BALL_ANGULAR_VELOCITY);
+
+	for(int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+	{
+		mBlobPositionX[player].assign(padded, player == LEFT_PLAYER ? 200 : 600);
+		mBlobPositionY[player].assign(padded, GROUND_PLANE_HEIGHT);
+		mBlobVelocityX[player].assign(padded, 0);
+		mBlobVelocityY[player].assign(padded, 0);
+		mBlobState[player].assign(padded, 0);
+		mCurrentBlobbyAnimationSpeed[player].assign(padded, 0);
+
+		mInputLeft[player].assign(padded, 0);
+		mInputRight[player].assign(padded, 0);
+		mInputUp[player].assign(padded, 0);
+	}
+
+	mBallValid.assign(padded, 1);
+	mGameRunning.assign(padded, 1);
+}
+
+PhysicWorldBatch::~PhysicWorldBatch() = default;
+
+std::size_t PhysicWorldBatch::size() const
+{
+	return mCount;
+}
+
+Vector2 PhysicWorldBatch::getBallPosition(std::size_t match) const
+{
+	return Vector2(mBallPositionX[match], mBallPositionY[match]);
+}
+
+Vector2 PhysicWorldBatch::getBallVelocity(std::size_t match) const
+{
+	return Vector2(mBallVelocityX[match], mBallVelocityY[match]);
+}
+
+Vector2 PhysicWorldBatch::getBlobPosition(std::size_t match, PlayerSide player) const
+{
+	return Vector2(mBlobPositionX[player][match], mBlobPositionY[player][match]);
+}
+
+void PhysicWorldBatch::setBallValid(std::size_t match, bool isBallValid)
+{
+	mBallValid[match] = isBallValid;
+}
+
+void PhysicWorldBatch::setGameRunning(std::size_t match, bool isGameRunning)
+{
+	mGameRunning[match] = isGameRunning;
+}
+
+void PhysicWorldBatch::step(const std::vector<PlayerInput>& leftInput, const std::vector<PlayerInput>& rightInput)
+{
+	TRACE_SCOPE("PhysicWorldBatch::step");
+	assert(leftInput.size() == mCount && rightInput.size() == mCount);
+
+	const std::vector<PlayerInput>* inputs[MAX_PLAYERS] = {&leftInput, &rightInput};
+	for(int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+	{
+		for(std::size_t match = 0; match < mCount; ++match)
+		{
+			const PlayerInput& input = (*inputs[player])[match];
+			mInputLeft[player][match] = input.left;
+			mInputRight[player][match] = input.right;
+			mInputUp[player][match] = input.up;
+		}
+	}
+
+	mEvents.clear();
+
+	// Deterministic IEEE 754 floating point computations
+	short fpf = set_fpu_single_precision();
+
+	for(std::size_t first = 0; first < mCount; first += BatchLanes::WIDTH)
+	{
+		stepLanes<BatchLanes>(first);
+	}
+
+	reset_fpu_flags(fpf);
+}
+
+const std::vector<PhysicWorldBatch::Event>& PhysicWorldBatch::getEvents() const
+{
+	return mEvents;
+}
+
+PhysicState PhysicWorldBatch::getState(std::size_t match) const
+{
+	PhysicState st;
+	for(int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+	{
+		st.blobPosition[player] = Vector2(mBlobPositionX[player][match], mBlobPositionY[player][match]);
+		st.blobVelocity[player] = Vector2(mBlobVelocityX[player][match], mBlobVelocityY[player][match]);
+		st.blobState[player] = mBlobState[player][match];
+	}
+
+	st.ballPosition = getBallPosition(match);
+	st.ballVelocity = getBallVelocity(match);
+	st.ballRotation = mBallRotation[match];
+	st.ballAngularVelocity = mBallAngularVelocity[match];
+	return st;
+}
+
+void PhysicWorldBatch::setState(std::size_t match, const PhysicState& ps)
+{
+	for(int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+	{
+		mBlobPositionX[player][match] = ps.blobPosition[player].x;
+		mBlobPositionY[player][match] = ps.blobPosition[player].y;
+		mBlobVelocityX[player][match] = ps.blobVelocity[player].x;
+		mBlobVelocityY[player][match] = ps.blobVelocity[player].y;
+		mBlobState[player][match] = ps.blobState[player];
+	}
+
+	mBallPositionX[match] = ps.ballPosition.x;
+	mBallPositionY[match] = ps.ballPosition.y;
+	mBallVelocityX[match] = ps.ballVelocity.x;
+	mBallVelocityY[match] = ps.ballVelocity.y;
+	mBallRotation[match] = ps.ballRotation;
+	mBallAngularVelocity[match] = ps.ballAngularVelocity;
+}
+
+// this follows PhysicWorld::step operation by operation. Branches become selects,
+// so the order of the additions and multiplications has to stay exactly the same.
+template<class L>
+void PhysicWorldBatch::stepLanes(std::size_t first)
+{
+	typedef typename L::Pack Pack;
+	typedef typename L::Mask Mask;
+
+	const Pack zero = L::set(0);
+	const Mask ball_valid = L::greater(L::load(&mBallValid[first]), zero);
+	const Mask game_running = L::greater(L::load(&mGameRunning[first]), zero);
+
+	auto startAnimation = [&](Pack speed, Mask start)
+	{
+		return L::select(L::both(start, L::equal(speed, zero)), L::set(BLOBBY_ANIMATION_SPEED), speed);
+	};
+
+	Pack blob_x[MAX_PLAYERS];
+	Pack blob_y[MAX_PLAYERS];
+	Pack blob_vx[MAX_PLAYERS];
+	Pack blob_vy[MAX_PLAYERS];
+
+	// Compute independent actions
+	for(int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+	{
+		const Mask left = L::greater(L::load(&mInputLeft[player][first]), zero);
+		const Mask right = L::greater(L::load(&mInputRight[player][first]), zero);
+		const Mask up = L::greater(L::load(&mInputUp[player][first]), zero);
+
+		Pack x = L::load(&mBlobPositionX[player][first]);
+		Pack y = L::load(&mBlobPositionY[player][first]);
+		Pack vy = L::load(&mBlobVelocityY[player][first]);
+		Pack state = L::load(&mBlobState[player][first]);
+		Pack speed = L::load(&mCurrentBlobbyAnimationSpeed[player][first]);
+
+		const Pack gravitation = L::set(GRAVITATION);
+		const Mask on_ground = L::greaterEqual(y, L::set(GROUND_PLANE_HEIGHT));
+
+		const Mask jump = L::both(up, on_ground);
+		vy = L::select(jump, L::set(BLOBBY_JUMP_ACCELERATION), vy);
+		speed = startAnimation(speed, jump);
+		Pack current_gravity = L::select(up, L::sub(gravitation, L::set(BLOBBY_JUMP_BUFFER)), gravitation);
+
+		speed = startAnimation(speed, L::both(L::either(left, right), on_ground));
+
+		Pack vx = L::sub(L::select(right, L::set(BLOBBY_SPEED), zero), L::select(left, L::set(BLOBBY_SPEED), zero));
+
+		// ds = a/2 * dt^2 + v * dt
+		x = L::add(x, L::add(zero, vx));
+		y = L::add(y, L::add(L::mul(L::set(0.5f), current_gravity), vy));
+		// dv = a * dt
+		vy = L::add(vy, current_gravity);
+
+		// Hitting the ground
+		const Mask landed = L::greater(y, L::set(GROUND_PLANE_HEIGHT));
+		speed = startAnimation(speed, L::both(landed, L::greater(vy, L::set(3.5f))));
+		y = L::select(landed, L::set(GROUND_PLANE_HEIGHT), y);
+		vy = L::select(landed, zero, vy);
+
+		// animation step
+		const Mask below_zero = L::less(state, zero);
+		speed = L::select(below_zero, zero, speed);
+		state = L::select(below_zero, zero, state);
+		speed = L::select(L::greaterEqual(state, L::set(4.5f)), L::set(-BLOBBY_ANIMATION_SPEED), speed);
+		state = L::add(state, speed);
+		state = L::select(L::greaterEqual(state, L::set(5)), L::set(static_cast<float>(4.99)), state);
+
+		blob_x[player] = x;
+		blob_y[player] = y;
+		blob_vx[player] = vx;
+		blob_vy[player] = vy;
+		L::store(&mBlobState[player][first], state);
+		L::store(&mCurrentBlobbyAnimationSpeed[player][first], speed);
+	}
+
+	Pack ball_x = L::load(&mBallPositionX[first]);
+	Pack ball_y = L::load(&mBallPositionY[first]);
+	Pack ball_vx = L::load(&mBallVelocityX[first]);
+	Pack ball_vy = L::load(&mBallVelocityY[first]);
+
+	// Move ball when game is running
+	ball_x = L::select(game_running, L::add(ball_x, L::add(zero, ball_vx)), ball_x);
+	ball_y = L::select(game_running, L::add(ball_y, L::add(L::set(0.5f * BALL_GRAVITATION), ball_vy)), ball_y);
+	ball_vy = L::select(game_running, L::add(ball_vy, L::set(BALL_GRAVITATION)), ball_vy);
+
+	// Collision detection, the right blob sees the ball as the left one left it
+	int hit_bits[MAX_PLAYERS];
+	float intensity[MAX_PLAYERS][L::WIDTH];
+	for(int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+	{
+		auto overlaps = [&](Pack center_y, float radius)
+		{
+			Pack dx = L::sub(ball_x, blob_x[player]);
+			Pack dy = L::sub(ball_y, center_y);
+			float sum_radii = BALL_RADIUS + radius;
+			return L::less(L::add(L::mul(dx, dx), L::mul(dy, dy)), L::set(sum_radii * sum_radii));
+		};
+
+		const Pack lower_center = L::add(blob_y[player], L::set(BLOBBY_LOWER_SPHERE));
+		const Pack upper_center = L::sub(blob_y[player], L::set(BLOBBY_UPPER_SPHERE));
+		const Mask lower_hit = overlaps(lower_center, BLOBBY_LOWER_RADIUS);
+		const Mask hit = L::both(ball_valid, L::either(lower_hit, overlaps(upper_center, BLOBBY_UPPER_RADIUS)));
+		hit_bits[player] = L::bits(hit);
+		if(!hit_bits[player])
+			continue;
+
+		// calculate hit intensity
+		Pack rel_vx = L::sub(blob_vx[player], ball_vx);
+		Pack rel_vy = L::sub(blob_vy[player], ball_vy);
+		Pack hit_intensity = L::div(L::sqrt(L::add(L::mul(rel_vx, rel_vx), L::mul(rel_vy, rel_vy))), L::set(25.f));
+		L::store(intensity[player], L::select(L::less(hit_intensity, L::set(1.f)), hit_intensity, L::set(1.f)));
+
+		// set ball velocity
+		Pack vx = L::neg(L::sub(blob_x[player], ball_x));
+		Pack vy = L::neg(L::sub(L::select(lower_hit, lower_center, upper_center), ball_y));
+		Pack length = L::sqrt(L::add(L::mul(vx, vx), L::mul(vy, vy)));
+		Mask normalise = L::greaterEqual(length, L::set(NORMALISE_MIN_LENGTH));
+		vx = L::mul(L::select(normalise, L::div(vx, length), vx), L::set(BALL_COLLISION_VELOCITY));
+		vy = L::mul(L::select(normalise, L::div(vy, length), vy), L::set(BALL_COLLISION_VELOCITY));
+
+		ball_vx = L::select(hit, vx, ball_vx);
+		ball_vy = L::select(hit, vy, ball_vy);
+		ball_x = L::select(hit, L::add(ball_x, vx), ball_x);
+		ball_y = L::select(hit, L::add(ball_y, vy), ball_y);
+	}
+
+	// Ball to ground Collision
+	const Mask ground = L::greater(L::add(ball_y, L::set(BALL_RADIUS)), L::set(GROUND_PLANE_HEIGHT_MAX));
+	const int ground_bits = L::bits(ground);
+	ball_vx = L::select(ground, L::mul(ball_vx, L::set(0.95f)), ball_vx);
+	ball_vy = L::select(ground, L::mul(L::neg(ball_vy), L::set(0.95f)), ball_vy);
+	ball_y = L::select(ground, L::set(GROUND_PLANE_HEIGHT_MAX - BALL_RADIUS), ball_y);
+	const int ground_right_bits = L::bits(L::greater(ball_x, L::set(NET_POSITION_X)));
+
+	// Border and net Collision
+	const Mask left_wall = L::both(L::lessEqual(L::sub(ball_x, L::set(BALL_RADIUS)), L::set(LEFT_PLANE)),
+									L::less(ball_vx, zero));
+	const Mask right_wall = L::butNot(L::both(L::greaterEqual(L::add(ball_x, L::set(BALL_RADIUS)), L::set(RIGHT_PLANE)),
+												L::greater(ball_vx, zero)), left_wall);
+	const Mask walls = L::either(left_wall, right_wall);
+	const Pack net_offset = L::sub(ball_x, L::set(NET_POSITION_X));
+	const Mask net = L::butNot(L::both(L::greater(ball_y, L::set(NET_SPHERE_POSITION)),
+									L::less(L::abs(net_offset), L::set(BALL_RADIUS + NET_RADIUS))), walls);
+	const Mask net_right = L::greater(net_offset, zero);
+
+	const Pack net_dx = L::sub(L::set(NET_POSITION_X), ball_x);
+	const Pack net_dy = L::sub(L::set(NET_SPHERE_POSITION), ball_y);
+	const Pack net_distance = L::sqrt(L::add(L::mul(net_dx, net_dx), L::mul(net_dy, net_dy)));
+	const Mask net_top = L::butNot(L::less(net_distance, L::set(NET_RADIUS + BALL_RADIUS)), L::either(walls, net));
+
+	const int left_wall_bits = L::bits(left_wall);
+	const int right_wall_bits = L::bits(right_wall);
+	const int net_bits = L::bits(net);
+	const int net_right_bits = L::bits(net_right);
+	const int net_top_bits = L::bits(net_top);
+
+	ball_vx = L::select(L::either(walls, net), L::neg(ball_vx), ball_vx);
+	ball_x = L::select(left_wall, L::set(LEFT_PLANE + BALL_RADIUS), ball_x);
+	ball_x = L::select(right_wall, L::set(RIGHT_PLANE - BALL_RADIUS), ball_x);
+	ball_x = L::select(net, L::add(L::set(NET_POSITION_X), L::select(net_right, L::set(BALL_RADIUS + NET_RADIUS),
+														L::set(-BALL_RADIUS - NET_RADIUS))), ball_x);
+
+	L::store(&mBallPositionX[first], ball_x);
+	L::store(&mBallPositionY[first], ball_y);
+	L::store(&mBallVelocityX[first], ball_vx);
+	L::store(&mBallVelocityY[first], ball_vy);
+
+	for(int lane = 0; lane < L::WIDTH; ++lane)
+	{
+		if(net_top_bits & (1 << lane))
+		{
+			std::size_t match = first + lane;
+			Vector2 position(mBallPositionX[match], mBallPositionY[match]);
+			Vector2 velocity(mBallVelocityX[match], mBallVelocityY[match]);
+			bounceOffNetTop(position, velocity);
+			mBallPositionX[match] = position.x;
+			mBallPositionY[match] = position.y;
+			mBallVelocityX[match] = velocity.x;
+			mBallVelocityY[match] = velocity.y;
+		}
+	}
+
+	if(net_top_bits)
+	{
+		ball_vx = L::load(&mBallVelocityX[first]);
+		ball_vy = L::load(&mBallVelocityY[first]);
+	}
+
+	// Collision between blobby and the net, and between blobby and the border
+	Pack left_x = blob_x[LEFT_PLAYER];
+	left_x = L::select(L::greater(L::add(left_x, L::set(BLOBBY_LOWER_RADIUS)), L::set(NET_POSITION_X - NET_RADIUS)),
+						L::set(NET_POSITION_X - NET_RADIUS - BLOBBY_LOWER_RADIUS), left_x);
+	left_x = L::select(L::less(left_x, L::set(LEFT_PLANE)), L::set(LEFT_PLANE), left_x);
+
+	Pack right_x = blob_x[RIGHT_PLAYER];
+	right_x = L::select(L::less(L::sub(right_x, L::set(BLOBBY_LOWER_RADIUS)), L::set(NET_POSITION_X + NET_RADIUS)),
+						L::set(NET_POSITION_X + NET_RADIUS + BLOBBY_LOWER_RADIUS), right_x);
+	right_x = L::select(L::greater(right_x, L::set(RIGHT_PLANE)), L::set(RIGHT_PLANE), right_x);
+
+	blob_x[LEFT_PLAYER] = left_x;
+	blob_x[RIGHT_PLAYER] = right_x;
+	for(int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+	{
+		L::store(&mBlobPositionX[player][first], blob_x[player]);
+		L::store(&mBlobPositionY[player][first], blob_y[player]);
+		L::store(&mBlobVelocityX[player][first], blob_vx[player]);
+		L::store(&mBlobVelocityY[player][first], blob_vy[player]);
+	}
+
+	// Velocity Integration
+	const Pack angular_velocity = L::load(&mBallAngularVelocity[first]);
+	Pack rotation = L::load(&mBallRotation[first]);
+	const Pack ball_speed = L::sqrt(L::add(L::mul(ball_vx, ball_vx), L::mul(ball_vy, ball_vy)));
+	const Pack spin = L::mul(angular_velocity, L::div(ball_speed, L::set(6)));
+	rotation = L::select(game_running,
+						L::select(L::greater(ball_vx, zero), L::add(rotation, spin), L::sub(rotation, spin)),
+						L::sub(rotation, angular_velocity));
+
+	// Overflow-Protection
+	const Pack full_turn = L::set(6.25f);
+	rotation = L::select(L::lessEqual(rotation, zero), L::add(full_turn, rotation),
+						L::select(L::greaterEqual(rotation, full_turn), L::sub(rotation, full_turn), rotation));
+	L::store(&mBallRotation[first], rotation);
+
+	// events, in the order of PhysicWorld
+	const int event_bits = hit_bits[LEFT_PLAYER] | hit_bits[RIGHT_PLAYER] | ground_bits |
+							left_wall_bits | right_wall_bits | net_bits | net_top_bits;
+	for(int lane = 0; lane < L::WIDTH; ++lane)
+	{
+		const int bit = 1 << lane;
+		const std::size_t match = first + lane;
+		// the padding is stepped, too, but nobody is interested in it
+		if(!(event_bits & bit) || match >= mCount)
+			continue;
+
+		for(int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+		{
+			if(hit_bits[player] & bit)
+				mEvents.push_back(Event{match, MatchEvent{MatchEvent::BALL_HIT_BLOB, (PlayerSide)player, intensity[player][lane]}});
+		}
+
+		if(ground_bits & bit)
+			mEvents.push_back(Event{match, MatchEvent{MatchEvent::BALL_HIT_GROUND, ground_right_bits & bit ? RIGHT_PLAYER : LEFT_PLAYER, 0}});
+
+		if(left_wall_bits & bit)
+			mEvents.push_back(Event{match, MatchEvent{MatchEvent::BALL_HIT_WALL, LEFT_PLAYER, 0}});
+		else if(right_wall_bits & bit)
+			mEvents.push_back(Event{match, MatchEvent{MatchEvent::BALL_HIT_WALL, RIGHT_PLAYER, 0}});
+		else if(net_bits & bit)
+			mEvents.push_back(Event{match, MatchEvent{MatchEvent::BALL_HIT_NET, net_right_bits & bit ? RIGHT_PLAYER : LEFT_PLAYER, 0}});
+		else if(net_top_bits & bit)
+			mEvents.push_back(Event{match, MatchEvent{MatchEvent::BALL_HIT_NET_TOP, NO_PLAYER, 0}});
+	}
+}
@@ -0,0 +1,110 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Global.h"
+#include "Vector.h"
+#include "PlayerInput.h"
+#include "BlobbyDebug.h"
+#include "PhysicState.h"
+#include "MatchEvents.h"
+
+/*! \brief many independent blobby worlds, stepped together
+	\details Does the same as a PhysicWorld for each of its matches, but stores the state of all matches
+			as structure of arrays, so one step is calculated for several matches at once. Uses AVX or SSE
+			when the compiler targets them, and plain floats otherwise. The results are bit identical to
+			PhysicWorld::step.
+			Instead of calling a callback, the events of the last step are collected together with the
+			index of their match.
+*/
+class PhysicWorldBatch : public ObjectCounter<PhysicWorldBatch>
+{
+	public:
+		/// an event of the last step, and the match it happened in
+		struct Event
+		{
+			std::size_t match;
+			MatchEvent event;
+		};
+
+		/// creates \p count worlds, which start like a new PhysicWorld
+		explicit PhysicWorldBatch(std::size_t count);
+		~PhysicWorldBatch();
+
+		/// number of matches
+		std::size_t size() const;
+
+		// ball information queries
+		Vector2 getBallPosition(std::size_t match) const;
+		Vector2 getBallVelocity(std::size_t match) const;
+
+		// blobby information queries
+		Vector2 getBlobPosition(std::size_t match, PlayerSide player) const;
+
+		/// the arguments of PhysicWorld::step that only change when a point is made.
+		/// Both are true for a new batch.
+		void setBallValid(std::size_t match, bool isBallValid);
+		void setGameRunning(std::size_t match, bool isGameRunning);
+
+		/// steps every match. \p leftInput and \p rightInput contain one input per match.
+		void step(const std::vector<PlayerInput>& leftInput, const std::vector<PlayerInput>& rightInput);
+
+		/// the events of the last step, ordered by match. The events of a match are in the
+		/// order in which PhysicWorld reports them.
+		const std::vector<Event>& getEvents() const;
+
+		// gets and sets the physic state of a single match
+		PhysicState getState(std::size_t match) const;
+		void setState(std::size_t match, const PhysicState& state);
+
+	private:
+		template<class Lanes>
+		void stepLanes(std::size_t first);
+
+		std::size_t mCount;
+
+		// one entry per match, padded to a multiple of the vector width
+		std::vector<float> mBallPositionX;
+		std::vector<float> mBallPositionY;
+		std::vector<float> mBallVelocityX;
+		std::vector<float> mBallVelocityY;
+		std::vector<float> mBallRotation;
+		std::vector<float> mBallAngularVelocity;
+
+		std::vector<float> mBlobPositionX[MAX_PLAYERS];
+		std::vector<float> mBlobPositionY[MAX_PLAYERS];
+		std::vector<float> mBlobVelocityX[MAX_PLAYERS];
+		std::vector<float> mBlobVelocityY[MAX_PLAYERS];
+		std::vector<float> mBlobState[MAX_PLAYERS];
+		std::vector<float> mCurrentBlobbyAnimationSpeed[MAX_PLAYERS];
+
+		// flags are stored as 0 and 1
+		std::vector<float> mInputLeft[MAX_PLAYERS];
+		std::vector<float> mInputRight[MAX_PLAYERS];
+		std::vector<float> mInputUp[MAX_PLAYERS];
+		std::vector<float> mBallValid;
+		std::vector<float> mGameRunning;
+
+		std::vector<Event> mEvents;
+};
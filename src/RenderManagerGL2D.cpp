@@ -28,6 +28,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Color.h"
 #include "Global.h"
 #include "DuelMatchState.h"
+#include "Tracing.h"
 
 /* implementation */
 RenderManagerGL2D::Texture::Texture( GLuint tex, int x, int y, int width, int height, int tw, int th ) :
@@ -552,6 +553,8 @@ void RenderManagerGL2D::endDrawParticles()
 
 void RenderManagerGL2D::refresh()
 {
+	TRACE_SCOPE("RenderManager::refresh");
+
 	//std::cout << debugStateChanges << "\n";
 	SDL_GL_SwapWindow(mWindow);
 	debugStateChanges = 0;
@@ -562,6 +565,8 @@ void RenderManagerGL2D::refresh()
 
 void RenderManagerGL2D::drawGame(const DuelMatchState& gameState)
 {
+	TRACE_SCOPE("RenderManager::drawGame");
+
 // Background
 	glDisable(GL_ALPHA_TEST);
 	glColor4f(1.0, 1.0, 1.0, 1.0);
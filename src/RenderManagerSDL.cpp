@@ -22,54 +22,17 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "RenderManagerSDL.h"
 
 /* includes */
+#include <algorithm>
+#include <iterator>
+
+#include "BlobColorizer.h"
 #include "FileExceptions.h"
 #include "DuelMatchState.h"
+#include "Tracing.h"
 
 /* implementation */
-SDL_Surface* RenderManagerSDL::colorSurface(SDL_Surface *surface, Color color)
-{
-	// Create new surface
-	SDL_Surface *newSurface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ABGR8888, 0);
-
-	SDL_LockSurface(newSurface);
-
-	Uint32* surface_pixels = (Uint32*)newSurface->pixels;
-
-	for (int p = 0; p < newSurface->w * newSurface->h; ++p)
-	{
-		SDL_Color pixel;
-		SDL_GetRGBA(surface_pixels[p], newSurface->format, &pixel.r, &pixel.g, &pixel.b, &pixel.a);
-
-		const bool color_key = !(pixel.r | pixel.g | pixel.b);
-
-		if(!color_key)
-		{
-			int rr = (int(pixel.r) * int(color.r)) >> 8;
-			int rg = (int(pixel.g) * int(color.g)) >> 8;
-			int rb = (int(pixel.b) * int(color.b)) >> 8;
-			int fak = int(pixel.r) * 5 - 4 * 256 - 138;
-
-			auto clamp = [fak](int value) {
-				// Bright pixels in the original image should remain bright!
-				if (fak > 0)
-					value += fak;
-				// This is clamped to 1 because dark colors may would be
-				// color-keyed otherwise
-				return std::max(1, std::min(value, 255));
-			};
-
-			surface_pixels[p] = SDL_MapRGBA(newSurface->format, clamp(rr), clamp(rg), clamp(rb), pixel.a);
-		}
-
-
-	}
-	SDL_UnlockSurface(newSurface);
-
-	// Use a black color-key
-	SDL_SetColorKey(newSurface, SDL_TRUE, SDL_MapRGB(newSurface->format, 0, 0, 0));
-
-	return newSurface;
-}
+// number of blob colors whose textures are kept
+const int BLOB_TEXTURE_SETS = 6;
 
 RenderManagerSDL::RenderManagerSDL() = default;
 
@@ -222,50 +185,6 @@ void RenderManagerSDL::init(int xResolution, int yResolution, bool fullscreen)
 		}
 
 		mStandardBlobShadow.push_back(formatedBlobShadowImage);
-
-		// Prepare blobby textures
-		SDL_Texture* leftBlobTex = SDL_CreateTexture(mRenderer,
-				SDL_PIXELFORMAT_ABGR8888,
-				SDL_TEXTUREACCESS_STREAMING,
-				formattedBlobImage->w, formattedBlobImage->h);
-		SDL_SetTextureBlendMode(leftBlobTex, SDL_BLENDMODE_BLEND);
-		SDL_UpdateTexture(leftBlobTex, nullptr, formattedBlobImage->pixels, formattedBlobImage->pitch);
-
-		mLeftBlob.emplace_back(
-				leftBlobTex,
-				Color(255, 255, 255));
-
-		SDL_Texture* rightBlobTex = SDL_CreateTexture(mRenderer,
-				SDL_PIXELFORMAT_ABGR8888,
-				SDL_TEXTUREACCESS_STREAMING,
-				formattedBlobImage->w, formattedBlobImage->h);
-		SDL_SetTextureBlendMode(rightBlobTex, SDL_BLENDMODE_BLEND);
-		SDL_UpdateTexture(rightBlobTex, nullptr, formattedBlobImage->pixels, formattedBlobImage->pitch);
-
-		mRightBlob.emplace_back(
-				rightBlobTex,
-				Color(255, 255, 255));
-
-		// Prepare blobby shadow textures
-		SDL_Texture* leftBlobShadowTex = SDL_CreateTexture(mRenderer,
-				SDL_PIXELFORMAT_ABGR8888,
-				SDL_TEXTUREACCESS_STREAMING,
-				formatedBlobShadowImage->w, formatedBlobShadowImage->h);
-		SDL_SetTextureBlendMode(leftBlobShadowTex, SDL_BLENDMODE_BLEND);
-		mLeftBlobShadow.emplace_back(
-				leftBlobShadowTex,
-				Color(255, 255, 255));
-		SDL_UpdateTexture(leftBlobShadowTex, nullptr, formatedBlobShadowImage->pixels, formatedBlobShadowImage->pitch);
-
-		SDL_Texture* rightBlobShadowTex = SDL_CreateTexture(mRenderer,
-				SDL_PIXELFORMAT_ABGR8888,
-				SDL_TEXTUREACCESS_STREAMING,
-				formatedBlobShadowImage->w, formatedBlobShadowImage->h);
-		SDL_SetTextureBlendMode(rightBlobShadowTex, SDL_BLENDMODE_BLEND);
-		mRightBlobShadow.emplace_back(
-				rightBlobShadowTex,
-				Color(255, 255, 255));
-		SDL_UpdateTexture(rightBlobShadowTex, nullptr, formatedBlobShadowImage->pixels, formatedBlobShadowImage->pitch);
 	}
 
 	// Load font
@@ -302,26 +221,35 @@ void RenderManagerSDL::init(int xResolution, int yResolution, bool fullscreen)
 
 	mStandardBlobBlood = formatedBlobStandardBlood;
 
-	// Create streamed textures for blood
-	SDL_Texture* leftBlobBlood = SDL_CreateTexture(mRenderer,
-			SDL_PIXELFORMAT_ABGR8888,
-			SDL_TEXTUREACCESS_STREAMING,
-			formatedBlobStandardBlood->w, formatedBlobStandardBlood->h);
-	SDL_SetTextureBlendMode(leftBlobBlood, SDL_BLENDMODE_BLEND);
-	mLeftBlobBlood = DynamicColoredTexture(
-			leftBlobBlood,
-			Color(255, 0, 0));
-	SDL_UpdateTexture(leftBlobBlood, nullptr, formatedBlobStandardBlood->pixels, formatedBlobStandardBlood->pitch);
-
-	SDL_Texture* rightBlobBlood = SDL_CreateTexture(mRenderer,
-			SDL_PIXELFORMAT_ABGR8888,
-			SDL_TEXTUREACCESS_STREAMING,
-			formatedBlobStandardBlood->w, formatedBlobStandardBlood->h);
-	SDL_SetTextureBlendMode(rightBlobBlood, SDL_BLENDMODE_BLEND);
-	mRightBlobBlood = DynamicColoredTexture(
-			rightBlobBlood,
-			Color(255, 0, 0));
-	SDL_UpdateTexture(rightBlobBlood, nullptr, formatedBlobStandardBlood->pixels, formatedBlobStandardBlood->pitch);
+	// Create streamed textures for coloring, initially showing the uncolored images
+	auto createColoredTexture = [this](SDL_Surface* image)
+	{
+		SDL_Texture* texture = SDL_CreateTexture(mRenderer,
+				SDL_PIXELFORMAT_ABGR8888,
+				SDL_TEXTUREACCESS_STREAMING,
+				image->w, image->h);
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+		SDL_UpdateTexture(texture, nullptr, image->pixels, image->pitch);
+		return DynamicColoredTexture(texture, Color(255, 255, 255));
+	};
+
+	for (int set = 0; set < BLOB_TEXTURE_SETS; ++set)
+	{
+		ColoredBlobTextures textures;
+		textures.color = Color(255, 255, 255);
+		for (unsigned int i = 0; i < mStandardBlob.size(); ++i)
+		{
+			textures.blob.push_back(createColoredTexture(mStandardBlob[i]));
+			textures.shadow.push_back(createColoredTexture(mStandardBlobShadow[i]));
+		}
+		textures.blood = createColoredTexture(mStandardBlobBlood);
+		mBlobTextures.push_back(textures);
+	}
+
+	for (int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+	{
+		mPlayerBlobTextures[player] = &findBlobTextures(mBlobColor[player], player);
+	}
 
 SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
 }
@@ -344,15 +272,18 @@ RenderManagerSDL::~RenderManagerSDL()
 	{
 		SDL_FreeSurface(mStandardBlob[i]);
 		SDL_FreeSurface(mStandardBlobShadow[i]);
-		SDL_DestroyTexture(mLeftBlob[i].mSDLsf);
-		SDL_DestroyTexture(mLeftBlobShadow[i].mSDLsf);
-		SDL_DestroyTexture(mRightBlob[i].mSDLsf);
-		SDL_DestroyTexture(mRightBlobShadow[i].mSDLsf);
 	}
 
 	SDL_FreeSurface(mStandardBlobBlood);
-	SDL_DestroyTexture(mLeftBlobBlood.mSDLsf);
-	SDL_DestroyTexture(mRightBlobBlood.mSDLsf);
+
+	for (auto& textures : mBlobTextures)
+	{
+		for (auto& texture : textures.blob)
+			SDL_DestroyTexture(texture.mSDLsf);
+		for (auto& texture : textures.shadow)
+			SDL_DestroyTexture(texture.mSDLsf);
+		SDL_DestroyTexture(textures.blood.mSDLsf);
+	}
 
 	for (unsigned int i = 0; i < mFont.size(); ++i)
 	{
@@ -396,57 +327,49 @@ bool RenderManagerSDL::setBackground(const std::string& filename)
 
 void RenderManagerSDL::setBlobColor(int player, Color color)
 {
-	if (color != mBlobColor[player]) {
-		mBlobColor[player] = color;
-	} else {
+	if (color == mBlobColor[player])
 		return;
-	}
 
-	DynamicColoredTexture* handledBlobBlood;
+	mBlobColor[player] = color;
+	mPlayerBlobTextures[player] = &findBlobTextures(color, player);
+}
 
-	if (player == LEFT_PLAYER)
-	{
-		handledBlobBlood = &mLeftBlobBlood;
-	}
-	if (player == RIGHT_PLAYER)
+RenderManagerSDL::ColoredBlobTextures& RenderManagerSDL::findBlobTextures(Color color, int player)
+{
+	auto found = std::find_if(mBlobTextures.begin(), mBlobTextures.end(),
+			[color](const ColoredBlobTextures& textures) { return textures.color == color; });
+
+	if (found == mBlobTextures.end())
 	{
-		handledBlobBlood = &mRightBlobBlood;
+		// the textures are recolored when they are drawn the next time
+		found = std::prev(mBlobTextures.end());
+		if (&*found == mPlayerBlobTextures[player == LEFT_PLAYER ? RIGHT_PLAYER : LEFT_PLAYER])
+			--found;
+		found->color = color;
 	}
 
-	SDL_Surface* tempSurface = colorSurface(mStandardBlobBlood, mBlobColor[player]);
-	SDL_UpdateTexture(handledBlobBlood->mSDLsf, nullptr, tempSurface->pixels, tempSurface->pitch);
-	SDL_FreeSurface(tempSurface);
+	mBlobTextures.splice(mBlobTextures.begin(), mBlobTextures, found);
+	return *found;
 }
 
-
-void RenderManagerSDL::colorizeBlobs(int player, int frame)
+SDL_Texture* RenderManagerSDL::colorizedTexture(DynamicColoredTexture& texture, SDL_Surface* source, Color color)
 {
-	std::vector<DynamicColoredTexture> *handledBlob = nullptr;
-	std::vector<DynamicColoredTexture> *handledBlobShadow = nullptr;
-
-	if (player == LEFT_PLAYER)
-	{
-		handledBlob = &mLeftBlob;
-		handledBlobShadow = &mLeftBlobShadow;
-	}
-	if (player == RIGHT_PLAYER)
+	void* pixels;
+	int pitch;
+	if (texture.mColor != color && SDL_LockTexture(texture.mSDLsf, nullptr, &pixels, &pitch) == 0)
 	{
-		handledBlob = &mRightBlob;
-		handledBlobShadow = &mRightBlobShadow;
+		for (int y = 0; y < source->h; ++y)
+		{
+			colorizeBlobPixels(
+					reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(source->pixels) + y * source->pitch),
+					reinterpret_cast<Uint32*>(static_cast<Uint8*>(pixels) + y * pitch),
+					source->w, color);
+		}
+		SDL_UnlockTexture(texture.mSDLsf);
+		texture.mColor = color;
 	}
 
-	if( (*handledBlob)[frame].mColor != mBlobColor[player])
-	{
-		SDL_Surface* tempSurface = colorSurface(mStandardBlob[frame], mBlobColor[player]);
-		SDL_UpdateTexture((*handledBlob)[frame].mSDLsf, nullptr, tempSurface->pixels, tempSurface->pitch);
-		SDL_FreeSurface(tempSurface);
-
-		SDL_Surface* tempSurface2 = colorSurface(mStandardBlobShadow[frame], mBlobColor[player]);
-		SDL_UpdateTexture((*handledBlobShadow)[frame].mSDLsf, nullptr, tempSurface2->pixels, tempSurface2->pitch);
-		SDL_FreeSurface(tempSurface2);
-
-		(*handledBlob)[frame].mColor = mBlobColor[player];
-	}
+	return texture.mSDLsf;
 }
 
 
@@ -570,27 +493,15 @@ void RenderManagerSDL::drawBlob(const Vector2& pos, const Color& col)
 	static int toDraw = 0;
 
 	setBlobColor(toDraw, col);
-	/// \todo this recolores the current frame (0)
-	/// + shadows; that's not exactly what we want
-	colorizeBlobs(toDraw, 0);
-
+	SDL_Texture* blob = colorizedTexture(mPlayerBlobTextures[toDraw]->blob[0], mStandardBlob[0], col);
 
 	//  Second dirty workaround in the function to have the right position of blobs in the GUI
 	position.x = position.x - (int)(75/2);
 	position.y = position.y - (int)(89/2);
 
-	if(toDraw == 1)
-	{
-		SDL_QueryTexture(mRightBlob[0].mSDLsf, nullptr, nullptr, &position.w, &position.h);
-		SDL_RenderCopy(mRenderer, mRightBlob[0].mSDLsf, nullptr, &position);
-		toDraw = 0;
-	}
-	else
-	{
-		SDL_QueryTexture(mLeftBlob[0].mSDLsf, nullptr, nullptr, &position.w, &position.h);
-		SDL_RenderCopy(mRenderer, mLeftBlob[0].mSDLsf, nullptr, &position);
-		toDraw = 1;
-	}
+	SDL_QueryTexture(blob, nullptr, nullptr, &position.w, &position.h);
+	SDL_RenderCopy(mRenderer, blob, nullptr, &position);
+	toDraw = toDraw == 1 ? 0 : 1;
 }
 
 void RenderManagerSDL::drawParticle(const Vector2& pos, int player)
@@ -602,13 +513,15 @@ void RenderManagerSDL::drawParticle(const Vector2& pos, int player)
 		(short)9,
 	};
 
-	DynamicColoredTexture blood = player == LEFT_PLAYER ? mLeftBlobBlood : mRightBlobBlood;
+	SDL_Texture* blood = colorizedTexture(mPlayerBlobTextures[player]->blood, mStandardBlobBlood, mBlobColor[player]);
 
-	SDL_RenderCopy(mRenderer, blood.mSDLsf, nullptr, &blitRect);
+	SDL_RenderCopy(mRenderer, blood, nullptr, &blitRect);
 }
 
 void RenderManagerSDL::refresh()
 {
+	TRACE_SCOPE("RenderManager::refresh");
+
 	SDL_SetRenderTarget(mRenderer, nullptr);
 
 	// We have a resizeable window
@@ -633,6 +546,8 @@ void RenderManagerSDL::refresh()
 
 void RenderManagerSDL::drawGame(const DuelMatchState& gameState)
 {
+	TRACE_SCOPE("RenderManager::drawGame");
+
 	SDL_RenderCopy(mRenderer, mBackground, nullptr, nullptr);
 
 	SDL_Rect position;
@@ -660,12 +575,14 @@ void RenderManagerSDL::drawGame(const DuelMatchState& gameState)
 		// Left blob shadow
 		position = blobShadowRect(blobShadowPosition(gameState.getBlobPosition(LEFT_PLAYER)));
 		int animationState = int(gameState.getBlobState(LEFT_PLAYER)) % 5;
-		SDL_RenderCopy(mRenderer, mLeftBlobShadow[animationState].mSDLsf, nullptr, &position);
+		SDL_RenderCopy(mRenderer, colorizedTexture(mPlayerBlobTextures[LEFT_PLAYER]->shadow[animationState],
+				mStandardBlobShadow[animationState], mBlobColor[LEFT_PLAYER]), nullptr, &position);
 
 		// Right blob shadow
 		position = blobShadowRect(blobShadowPosition(gameState.getBlobPosition(RIGHT_PLAYER)));
 		animationState = int(gameState.getBlobState(RIGHT_PLAYER)) % 5;
-		SDL_RenderCopy(mRenderer, mRightBlobShadow[animationState].mSDLsf, nullptr, &position);
+		SDL_RenderCopy(mRenderer, colorizedTexture(mPlayerBlobTextures[RIGHT_PLAYER]->shadow[animationState],
+				mStandardBlobShadow[animationState], mBlobColor[RIGHT_PLAYER]), nullptr, &position);
 	}
 
 	// Restore the rod
@@ -683,17 +600,16 @@ void RenderManagerSDL::drawGame(const DuelMatchState& gameState)
 	int animationState = int(gameState.getBallRotation() / M_PI / 2 * 16) % 16;
 	SDL_RenderCopy(mRenderer, mBall[animationState], nullptr, &position);
 
-	// update blob colors
 	int leftFrame = int(gameState.getBlobState(LEFT_PLAYER)) % 5;
 	int rightFrame = int(gameState.getBlobState(RIGHT_PLAYER)) % 5;
-	colorizeBlobs(LEFT_PLAYER, leftFrame);
-	colorizeBlobs(RIGHT_PLAYER, rightFrame);
 
 	// Drawing left blob
 	position = blobRect(gameState.getBlobPosition(LEFT_PLAYER));
-	SDL_RenderCopy( mRenderer, mLeftBlob[leftFrame].mSDLsf, nullptr, &position);
+	SDL_RenderCopy(mRenderer, colorizedTexture(mPlayerBlobTextures[LEFT_PLAYER]->blob[leftFrame],
+			mStandardBlob[leftFrame], mBlobColor[LEFT_PLAYER]), nullptr, &position);
 
 	// Drawing right blob
 	position = blobRect(gameState.getBlobPosition(RIGHT_PLAYER));
-	SDL_RenderCopy(mRenderer, mRightBlob[rightFrame].mSDLsf, nullptr, &position);
+	SDL_RenderCopy(mRenderer, colorizedTexture(mPlayerBlobTextures[RIGHT_PLAYER]->blob[rightFrame],
+			mStandardBlob[rightFrame], mBlobColor[RIGHT_PLAYER]), nullptr, &position);
 }
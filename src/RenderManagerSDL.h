@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #pragma once
 
 #include <SDL.h>
+#include <list>
 #include <vector>
 
 #include "RenderManager.h"
@@ -65,6 +66,16 @@ class RenderManagerSDL : public RenderManager
 			Color mColor;
 		};
 
+		// blob, shadow and blood textures for one blob color. The textures are
+		// colored when they are drawn for the first time.
+		struct ColoredBlobTextures
+		{
+			Color color;
+			std::vector<DynamicColoredTexture> blob;
+			std::vector<DynamicColoredTexture> shadow;
+			DynamicColoredTexture blood;
+		};
+
 
 		SDL_Texture* mBackground;
 		SDL_Texture* mBallShadow;
@@ -74,13 +85,11 @@ class RenderManagerSDL : public RenderManager
 		std::vector<SDL_Surface*> mStandardBlob;
 		std::vector<SDL_Surface*> mStandardBlobShadow;
 		SDL_Surface* mStandardBlobBlood;
-		std::vector<DynamicColoredTexture> mLeftBlob;
-		std::vector<DynamicColoredTexture> mLeftBlobShadow;
-		DynamicColoredTexture mLeftBlobBlood;
 
-		std::vector<DynamicColoredTexture> mRightBlob;
-		std::vector<DynamicColoredTexture> mRightBlobShadow;
-		DynamicColoredTexture mRightBlobBlood;
+		// textures of the recently used blob colors, most recently used first
+		std::list<ColoredBlobTextures> mBlobTextures;
+		// textures of the current color of each player
+		ColoredBlobTextures* mPlayerBlobTextures[MAX_PLAYERS] = {nullptr, nullptr};
 
 		std::vector<SDL_Texture*> mFont;
 		std::vector<SDL_Texture*> mHighlightFont;
@@ -97,11 +106,12 @@ class RenderManagerSDL : public RenderManager
 		// Rendertarget to make windowmode resizeable
 		SDL_Texture* mRenderTarget = nullptr;
 
-		// colors a surface
-		// the returned SDL_Surface* is already converted into DisplayFormat
-		SDL_Surface* colorSurface(SDL_Surface *surface, Color color);
+		// finds the textures for a blob color. If there are none, the least recently
+		// used textures that are not drawn for the other player are taken over.
+		ColoredBlobTextures& findBlobTextures(Color color, int player);
+		// returns the texture, after coloring it from source if it does not have the color yet
+		SDL_Texture* colorizedTexture(DynamicColoredTexture& texture, SDL_Surface* source, Color color);
 
 		void drawTextImpl(const std::string& text, Vector2 position, unsigned int flags);
-		void colorizeBlobs(int player, int frame);
 };
 
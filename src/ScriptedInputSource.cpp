@@ -24,13 +24,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 /* includes */
 #include <boost/exception/all.hpp>
 
-#include <SDL.h>
-
 #include "lua.hpp"
 
 #include "DuelMatch.h"
 #include "DuelMatchState.h"
 #include "GameConstants.h"
+#include "SimulationClock.h"
+#include "Tracing.h"
 
 /* implementation */
 
@@ -40,11 +40,17 @@ ScriptedInputSource::ScriptedInputSource(const std::string& filename, PlayerSide
 , mDifficulty(difficulty)
 , mMatch(match)
 {
-	mStartTime = SDL_GetTicks();
+	mStartTime = mMatch->getSimulationClock().now();
+
+	acquireState("bot", [this]()
+	{
+		// set game constants
+		setGameConstants();
+		setGameFunctions();
 
-	// set game constants
-	setGameConstants();
-	setGameFunctions();
+		openScript("api");
+		openScript("bot_api");
+	});
 
 	// push infos into script
 	lua_pushnumber(mState, mDifficulty / 25.0);
@@ -52,8 +58,6 @@ ScriptedInputSource::ScriptedInputSource(const std::string& filename, PlayerSide
 	lua_pushinteger(mState, mSide);
 	lua_setglobal(mState, "__SIDE");
 
-	openScript("api");
-	openScript("bot_api");
 	openScript(filename);
 
 	// check whether all required lua functions are available
@@ -78,8 +82,15 @@ void ScriptedInputSource::setWaitTime(int wait_in_ms) {
 	mWaitTime = wait_in_ms;
 }
 
+void ScriptedInputSource::setRandomSeed(unsigned seed) {
+	mRandom.seed(seed);
+	seedLuaRandom(seed);
+}
+
 PlayerInputAbs ScriptedInputSource::getNextInput()
 {
+	TRACE_SCOPE("ScriptedInputSource::getNextInput");
+
 	DuelMatchState state = mMatch->getState();
 	if(mSide == RIGHT_PLAYER) {
 		state.swapSides();
@@ -160,7 +171,7 @@ PlayerInputAbs ScriptedInputSource::getNextInput()
 		lua_pop(mState, stacksize);
 	}
 
-	if (mStartTime + mWaitTime > SDL_GetTicks() && serving)
+	if (mStartTime + std::chrono::milliseconds(mWaitTime) > mMatch->getSimulationClock().now() && serving)
 		return {};
 
 	if(!mMatch->getBallActive())
@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <string>
 #include <random>
+#include <chrono>
 #include <deque>
 
 #include "Global.h"
@@ -59,6 +60,9 @@ class ScriptedInputSource : public InputSource, public IScriptableComponent
 		~ScriptedInputSource() override;
 
 		void setWaitTime(int wait_in_ms);
+		/// reseeds the random number generators used for input delays and errors
+		/// and by the script itself, so that benchmark runs can be reproduced.
+		void setRandomSeed(unsigned seed);
 
 		PlayerInputAbs getNextInput() override;
 
@@ -68,7 +72,8 @@ class ScriptedInputSource : public InputSource, public IScriptableComponent
 		void setBallError(int duration, float amount);
 		int getCurrentDifficulty() const;
 
-		unsigned int mStartTime;
+		/// time of the match clock when the bot was created
+		std::chrono::steady_clock::time_point mStartTime;
 		unsigned int mWaitTime = WAITING_TIME;
 
 
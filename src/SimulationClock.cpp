@@ -0,0 +1,80 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "SimulationClock.h"
+
+/* includes */
+
+/* implementation */
+
+namespace {
+	class RealTimeClock : public SimulationClock
+	{
+		public:
+			time_point now() const override
+			{
+				return clock_t::now();
+			}
+
+			void advance() override
+			{
+			}
+	};
+
+	class FixedStepClock : public SimulationClock
+	{
+		public:
+			explicit FixedStepClock(std::chrono::duration<double> step) : mStep(step)
+			{
+			}
+
+			time_point now() const override
+			{
+				// multiply instead of accumulating, so steps that are not a whole number
+				// of clock ticks do not add up rounding errors
+				return time_point( std::chrono::duration_cast<duration_t>(mStep * double(mSteps)) );
+			}
+
+			void advance() override
+			{
+				++mSteps;
+			}
+
+		private:
+			std::chrono::duration<double> mStep;
+			unsigned long long mSteps = 0;
+	};
+}
+
+std::shared_ptr<SimulationClock> SimulationClock::createRealTimeClock()
+{
+	return std::make_shared<RealTimeClock>();
+}
+
+std::shared_ptr<SimulationClock> SimulationClock::createFixedStepClock(duration_t step)
+{
+	return std::make_shared<FixedStepClock>(step);
+}
+
+std::shared_ptr<SimulationClock> SimulationClock::createFixedStepClock(float game_speed)
+{
+	return std::make_shared<FixedStepClock>( std::chrono::duration<double>(1.0 / game_speed) );
+}
@@ -0,0 +1,57 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+/*! \class SimulationClock
+	\brief Time source for match simulation
+	\details Everything inside a DuelMatch that depends on time (the game clock,
+			the serve delay of bots) asks this clock instead of reading the system time.
+			The real time clock is used for interactive games, the fixed step clock
+			advances by a constant amount for every simulated step, so headless matches
+			can run at full speed and are reproducible.
+*/
+class SimulationClock
+{
+	public:
+		using clock_t = std::chrono::steady_clock;
+		using duration_t = clock_t::duration;
+		using time_point = clock_t::time_point;
+
+		virtual ~SimulationClock() = default;
+
+		/// gets the current time
+		virtual time_point now() const = 0;
+
+		/// this function is called by the DuelMatch once per simulation step.
+		virtual void advance() = 0;
+
+		/// creates a clock that follows the system time
+		static std::shared_ptr<SimulationClock> createRealTimeClock();
+
+		/// creates a clock that advances by \p step on every call to advance()
+		static std::shared_ptr<SimulationClock> createFixedStepClock(duration_t step);
+
+		/// creates a clock that advances by the duration of one step at \p game_speed steps per second
+		static std::shared_ptr<SimulationClock> createFixedStepClock(float game_speed);
+};
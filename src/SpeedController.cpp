@@ -26,6 +26,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <SDL.h>
 
+#include "Tracing.h"
+
 /* implementation */
 /// this is required to reduce rounding errors. now we have a resolution of
 /// 1�s. This is much better than SDL_Delay can handle, but we prevent 
@@ -66,6 +68,8 @@ bool SpeedController::doFramedrop() const
 
 void SpeedController::update()
 {
+	TRACE_SCOPE("SpeedController::update");
+
 	int rateTicks = std::max( static_cast<int>(PRECISION_FACTOR * 1000 / mGameFPS), 1);
 	
 	static int lastTicks = SDL_GetTicks();
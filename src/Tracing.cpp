@@ -0,0 +1,261 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "Tracing.h"
+
+/* includes */
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+/* implementation */
+
+std::atomic<bool> gTracingEnabled(false);
+
+namespace
+{
+	// times are stored in nanoseconds relative to the start of the trace
+	struct TraceEvent
+	{
+		const char* name;
+		std::int64_t start;
+		std::int64_t duration;
+	};
+
+	// ring buffer of the events of a single thread. Only the owning thread writes into it,
+	// the mutex is needed for writing the trace from another thread.
+	struct ThreadTrace
+	{
+		std::mutex mutex;
+		int id = 0;
+		const char* name = nullptr;
+		unsigned generation = 0;
+		std::vector<TraceEvent> events;
+		std::size_t next = 0;
+		bool wrapped = false;
+	};
+
+	// the events of a thread that has finished, in the order they were recorded
+	struct FinishedTrace
+	{
+		int id;
+		const char* name;
+		unsigned generation;
+		std::vector<TraceEvent> events;
+	};
+
+	// the traces of running threads. when a thread exits, its events are moved to gFinishedTraces,
+	// so threads that are started again and again (e.g. for loading replays) don't keep their
+	// ring buffers alive. At most as many events as a single thread may record are kept for them.
+	std::mutex gThreadTracesMutex;
+	std::vector<std::shared_ptr<ThreadTrace>> gThreadTraces;
+	std::deque<FinishedTrace> gFinishedTraces;
+	std::size_t gFinishedEvents = 0;
+	int gNextThreadId = 1;
+
+	// each start of the trace increases the generation, which makes the threads discard their old events
+	std::atomic<unsigned> gTraceGeneration(0);
+	std::atomic<std::size_t> gTraceEventsPerThread(DEFAULT_TRACE_EVENTS_PER_THREAD);
+	std::atomic<std::chrono::steady_clock::rep> gTraceOrigin(0);
+
+	// unregisters the trace of its thread when the thread exits
+	struct ThreadTraceOwner
+	{
+		~ThreadTraceOwner();
+		std::shared_ptr<ThreadTrace> trace;
+	};
+
+	thread_local ThreadTraceOwner threadTrace;
+
+	ThreadTrace& getThreadTrace()
+	{
+		if(!threadTrace.trace)
+		{
+			auto trace = std::make_shared<ThreadTrace>();
+			std::lock_guard<std::mutex> lock(gThreadTracesMutex);
+			trace->id = gNextThreadId++;
+			gThreadTraces.push_back(trace);
+			threadTrace.trace = trace;
+		}
+		return *threadTrace.trace;
+	}
+
+	ThreadTraceOwner::~ThreadTraceOwner()
+	{
+		if(!trace)
+			return;
+
+		FinishedTrace finished{trace->id, nullptr, 0, {}};
+		{
+			std::lock_guard<std::mutex> lock(trace->mutex);
+			finished.name = trace->name;
+			finished.generation = trace->generation;
+			if(trace->generation == gTraceGeneration)
+			{
+				// oldest events first
+				auto next = trace->events.begin() + trace->next;
+				if(trace->wrapped)
+					finished.events.assign(next, trace->events.end());
+				finished.events.insert(finished.events.end(), trace->events.begin(), next);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(gThreadTracesMutex);
+		gThreadTraces.erase(std::find(gThreadTraces.begin(), gThreadTraces.end(), trace));
+		if(finished.events.empty())
+			return;
+
+		gFinishedEvents += finished.events.size();
+		gFinishedTraces.push_back(std::move(finished));
+		while(gFinishedEvents > gTraceEventsPerThread && gFinishedTraces.size() > 1)
+		{
+			gFinishedEvents -= gFinishedTraces.front().events.size();
+			gFinishedTraces.pop_front();
+		}
+	}
+}
+
+void startTracing(std::size_t events_per_thread)
+{
+	gTracingEnabled = false;
+	gTraceEventsPerThread = events_per_thread > 0 ? events_per_thread : 1;
+	gTraceOrigin = std::chrono::steady_clock::now().time_since_epoch().count();
+	{
+		std::lock_guard<std::mutex> lock(gThreadTracesMutex);
+		++gTraceGeneration;
+		gFinishedTraces.clear();
+		gFinishedEvents = 0;
+	}
+	gTracingEnabled = true;
+}
+
+void stopTracing()
+{
+	gTracingEnabled = false;
+}
+
+void setTraceThreadName(const char* name)
+{
+	ThreadTrace& trace = getThreadTrace();
+	std::lock_guard<std::mutex> lock(trace.mutex);
+	trace.name = name;
+}
+
+void recordTraceEvent(const char* name, std::chrono::steady_clock::time_point start,
+						std::chrono::steady_clock::time_point end)
+{
+	ThreadTrace& trace = getThreadTrace();
+	std::lock_guard<std::mutex> lock(trace.mutex);
+
+	unsigned generation = gTraceGeneration;
+	if(trace.generation != generation)
+	{
+		trace.generation = generation;
+		trace.events.assign(gTraceEventsPerThread, TraceEvent());
+		trace.next = 0;
+		trace.wrapped = false;
+	}
+
+	std::chrono::steady_clock::duration origin(gTraceOrigin.load());
+	TraceEvent& event = trace.events[trace.next];
+	event.name = name;
+	event.start = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch() - origin).count();
+	event.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+	if(++trace.next == trace.events.size())
+	{
+		trace.next = 0;
+		trace.wrapped = true;
+	}
+}
+
+void writeChromeTrace(std::ostream& stream)
+{
+	std::vector<std::shared_ptr<ThreadTrace>> traces;
+	std::deque<FinishedTrace> finished;
+	{
+		std::lock_guard<std::mutex> lock(gThreadTracesMutex);
+		traces = gThreadTraces;
+		finished = gFinishedTraces;
+	}
+
+	auto flags = stream.flags();
+	auto precision = stream.precision();
+	stream << std::fixed << std::setprecision(3);
+
+	stream << "{\"traceEvents\":[";
+	bool first = true;
+	auto separate = [&]()
+	{
+		stream << (first ? "\n" : ",\n");
+		first = false;
+	};
+	auto writeName = [&](int id, const char* name)
+	{
+		if(!name)
+			return;
+		separate();
+		stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << id
+				<< ",\"args\":{\"name\":\"" << name << "\"}}";
+	};
+	auto writeEvent = [&](int id, const TraceEvent& event)
+	{
+		separate();
+		stream << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << id
+				<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+	};
+
+	const unsigned generation = gTraceGeneration;
+	for(const auto& trace : finished)
+	{
+		if(trace.generation != generation)
+			continue;
+
+		writeName(trace.id, trace.name);
+		for(const TraceEvent& event : trace.events)
+			writeEvent(trace.id, event);
+	}
+
+	for(const auto& trace : traces)
+	{
+		std::lock_guard<std::mutex> lock(trace->mutex);
+
+		writeName(trace->id, trace->name);
+		if(trace->generation != generation)
+			continue;
+
+		// oldest events first
+		std::size_t count = trace->wrapped ? trace->events.size() : trace->next;
+		std::size_t begin = trace->wrapped ? trace->next : 0;
+		for(std::size_t i = 0; i < count; ++i)
+			writeEvent(trace->id, trace->events[(begin + i) % trace->events.size()]);
+	}
+
+	stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	stream.flags(flags);
+	stream.precision(precision);
+}
@@ -0,0 +1,101 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+
+/*! \file Tracing.h
+	\brief scoped trace instrumentation of the game loop
+	\details Code sections are marked with TRACE_SCOPE("Class::function"). While tracing is
+			enabled, each thread records the start and duration of these sections into its own
+			ring buffer of fixed size, so only the most recent events are kept and memory does
+			not grow during long sessions. When a thread exits, its buffer is released and its
+			events are moved to a shared buffer of the same size. The recorded events can be written in the Chrome trace
+			event format, which can be viewed in chrome://tracing or ui.perfetto.dev.
+			While tracing is disabled, a scope costs a single relaxed atomic load.
+*/
+
+/// number of events each thread keeps, if not specified otherwise
+const std::size_t DEFAULT_TRACE_EVENTS_PER_THREAD = 1 << 16;
+
+/// set while trace events are recorded. Use isTracing() to query it.
+extern std::atomic<bool> gTracingEnabled;
+
+inline bool isTracing()
+{
+	return gTracingEnabled.load(std::memory_order_relaxed);
+}
+
+/// \brief starts recording trace events, discarding all previously recorded events.
+/// \param events_per_thread Size of the ring buffer of each thread. When it is full, the oldest
+///			events are overwritten.
+void startTracing(std::size_t events_per_thread = DEFAULT_TRACE_EVENTS_PER_THREAD);
+
+/// stops recording trace events. The recorded events are kept until tracing is started again.
+void stopTracing();
+
+/// \brief names the calling thread in the written trace
+/// \param name has to stay valid for the rest of the program, e.g. a string literal.
+void setTraceThreadName(const char* name);
+
+/// records an event for the calling thread. Usually called by TraceScope.
+void recordTraceEvent(const char* name, std::chrono::steady_clock::time_point start,
+						std::chrono::steady_clock::time_point end);
+
+/// writes all recorded events in the Chrome trace event (JSON) format to \p stream
+void writeChromeTrace(std::ostream& stream);
+
+/*! \class TraceScope
+	\brief records the lifetime of this object as a trace event, if tracing is enabled
+	\details The name is only stored as a pointer, so it has to stay valid for the rest of the
+			program. Use the TRACE_SCOPE macro instead of creating objects of this class directly.
+*/
+class TraceScope
+{
+	public:
+		explicit TraceScope(const char* name) : mName(isTracing() ? name : nullptr)
+		{
+			if(mName)
+				mStart = std::chrono::steady_clock::now();
+		}
+
+		~TraceScope()
+		{
+			if(mName)
+				recordTraceEvent(mName, mStart, std::chrono::steady_clock::now());
+		}
+
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
+
+	private:
+		const char* mName;
+		std::chrono::steady_clock::time_point mStart;
+};
+
+#define TRACE_SCOPE_CONCAT_IMPL(a, b) a##b
+#define TRACE_SCOPE_CONCAT(a, b) TRACE_SCOPE_CONCAT_IMPL(a, b)
+
+/// traces the enclosing scope under the name \p name, which has to be a string literal
+#define TRACE_SCOPE(name) TraceScope TRACE_SCOPE_CONCAT(trace_scope_, __LINE__)(name)
@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <map>
 #include <limits>
+#include <mutex>
 #include <utility>
 
 #include "tinyxml2.h"
@@ -37,17 +38,31 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 
 /* implementation */
-std::map<std::string, std::shared_ptr<IUserConfigReader> >& userConfigCache()
+namespace
 {
-	static std::map<std::string, std::shared_ptr<IUserConfigReader> > cache;
-	return cache;
+	/// Parsed config files, shared by all readers of the same file. Entries are
+	/// immutable, saving a config replaces the entry with a new snapshot.
+	struct UserConfigCache
+	{
+		std::mutex mutex;
+		std::map<std::string, std::shared_ptr<const IUserConfigReader> > configs;
+	};
+
+	UserConfigCache& userConfigCache()
+	{
+		static UserConfigCache cache;
+		return cache;
+	}
 }
 
-std::shared_ptr<IUserConfigReader> IUserConfigReader::createUserConfigReader(const std::string& file)
+std::shared_ptr<const IUserConfigReader> IUserConfigReader::createUserConfigReader(const std::string& file)
 {
+	auto& cache = userConfigCache();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
 	// if we have this userconfig already cached, just return from cache
-	auto cfg_cached = userConfigCache().find(file);
-	if( cfg_cached != userConfigCache().end() )
+	auto cfg_cached = cache.configs.find(file);
+	if( cfg_cached != cache.configs.end() )
 	{
 		return cfg_cached->second;
 	}
@@ -57,7 +72,7 @@ std::shared_ptr<IUserConfigReader> IUserConfigReader::createUserConfigReader(con
 	config->loadFile(file);
 
 	// ... and add to cache
-	userConfigCache()[file] = config;
+	cache.configs[file] = config;
 
 	return config;
 }
@@ -144,12 +159,11 @@ bool UserConfig::saveFile(const std::string& filename) const
 	file.write(printer.CStr(), printer.CStrSize() - 1);  // do not write terminating \0 character
 	file.close();
 
-	// we have to make sure that we don't cache any outdated user configs
-	auto cfg_cached = userConfigCache().find(filename);
-	if( cfg_cached != userConfigCache().end() )
-	{
-		userConfigCache().erase(cfg_cached);
-	}
+	// we have to make sure that we don't cache any outdated user configs. Readers
+	// that still hold the old snapshot keep it alive until they are done.
+	auto& cache = userConfigCache();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	cache.configs[filename] = std::make_shared<const UserConfig>(*this);
 
 	return true;
 }
@@ -223,30 +237,17 @@ void UserConfig::setInteger(const std::string& name, int var)
 	setValue(name, writeBuffer);
 }
 
-namespace
-{
-	/// Helper function to find a `UserConfigVar` with a given name. Implemented
-	/// as a template to generate const and non-const versions.
-	template<class C>
-	auto findByName(C&& container, const std::string& name) -> decltype(&container.back())
-	{
-		auto found = std::find_if(begin(container), end(container),
-								  [&](const UserConfigVar& var){ return var.Name == name; });
-		if(found == end(container)) return nullptr;
-		return &(*found);
-	}
-}
-
 UserConfigVar* UserConfig::createVar(std::string name, std::string value)
 {
-	if (findByName(mVars, name)) return nullptr;
+	if (mIndex.count(name)) return nullptr;
+	mIndex.emplace(name, mVars.size());
 	mVars.emplace_back(std::move(name), std::move(value));
 	return &mVars.back();
 }
 
 void UserConfig::setValue(const std::string& name, std::string value)
 {
-	UserConfigVar* var = findByName(mVars, name);
+	UserConfigVar* var = findVar(name);
 	if (!var)
 	{
 		std::cerr << "Warning: impossible to set value of " <<
@@ -259,9 +260,17 @@ void UserConfig::setValue(const std::string& name, std::string value)
 	var->Value = std::move(value);
 }
 
+UserConfigVar* UserConfig::findVar(const std::string& name)
+{
+	auto found = mIndex.find(name);
+	if(found == mIndex.end()) return nullptr;
+	return &mVars[found->second];
+}
+
 const UserConfigVar* UserConfig::checkVarByName(const std::string& name) const
 {
-	auto var = findByName(mVars, name);
+	auto found = mIndex.find(name);
+	const UserConfigVar* var = found == mIndex.end() ? nullptr : &mVars[found->second];
 	if( !var )
 	{
 		std::cerr << "Warning: impossible to get value of " <<
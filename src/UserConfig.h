@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "BlobbyDebug.h"
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /*!
@@ -48,7 +49,8 @@ struct UserConfigVar : public ObjectCounter<UserConfigVar>
     \brief user configuration from xml data
     \details This class manages user configurations read from/written to xml data.
              It allows saving/loading from disk and getting/setting floats, booleans,
-             strings and integers by name
+             strings and integers by name. Variables are looked up through a hash index,
+             while the vector keeps the order in which they are written to disk.
 */
 class UserConfig: public IUserConfigReader, public ObjectCounter<UserConfig>
 {
@@ -72,6 +74,9 @@ class UserConfig: public IUserConfigReader, public ObjectCounter<UserConfig>
 	private:
 
 		std::vector<UserConfigVar> mVars;
+		/// maps variable names to their position in mVars
+		std::unordered_map<std::string, std::size_t> mIndex;
 		const UserConfigVar* checkVarByName(const std::string& name) const;
+		UserConfigVar* findVar(const std::string& name);
 		UserConfigVar* createVar(std::string name, std::string value);
 };
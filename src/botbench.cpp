@@ -20,56 +20,170 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 /* includes */
 #include <ctime>
+#include <cstdio>
+#include <algorithm>
 #include <cstring>
 #include <sstream>
 #include <atomic>
+#include <chrono>
 #include <thread>
+#include <mutex>
+#include <vector>
 #include <iostream>
 
-#include <SDL.h>
+#include <unistd.h>
 
 #include "Global.h"
 #include "UserConfig.h"
 #include "FileSystem.h"
 #include "ScriptedInputSource.h"
 #include "DuelMatch.h"
+#include "SimulationClock.h"
 #include "replays/ReplayRecorder.h"
 #include "FileWrite.h"
 
 /* implementation */
 
+struct DuelSetup {
+	std::string LeftPlayer;
+	std::string RightPlayer;
+	unsigned Seed;
+};
+
 struct DuelResult {
 	std::string LeftPlayer;
 	std::string RightPlayer;
+	unsigned Seed;
 	int LeftScore;
 	int RightScore;
 	int Duration;
+	long Steps;
+	double WallTime;
+};
+
+struct BenchOptions {
+	std::vector<std::string> Bots;
+	unsigned Seeds = 1;
+	unsigned Jobs = 0;
+	std::string Format = "text";
+	std::string Rules = "default.lua";
+	int ScoreToWin = 0;
+	bool SaveReplays = false;
+	bool Verbose = false;
 };
 
-DuelResult duel(std::string left, std::string right, bool verbose=false);
+DuelResult duel(const DuelSetup& setup, const BenchOptions& options);
+std::vector<DuelResult> tournament(const std::vector<DuelSetup>& duels, const BenchOptions& options);
 void present(const DuelResult& result);
+void presentCSV(const std::vector<DuelResult>& results);
+void presentJSON(const std::vector<DuelResult>& results, const BenchOptions& options, double wall_time);
+
+void printUsage(const char* program)
+{
+	std::cerr << "Usage: " << program << " [OPTIONS] BOT1 BOT2 [BOT3 ...]\n"
+			  << "Lets every bot play against every bot (including itself) once per seed,\n"
+			  << "and against every other bot once from each side.\n"
+			  << "Options:\n"
+			  << "  --seeds N        number of seeds to play every pairing with (default 1)\n"
+			  << "  --jobs N         number of duels to run in parallel (default: number of cores)\n"
+			  << "  --format FORMAT  output format: text, csv or json (default text)\n"
+			  << "  --rules FILE     rules to play with (default default.lua)\n"
+			  << "  --score N        score to win (default: as configured)\n"
+			  << "  --replays        save a replay of every duel\n"
+			  << "  --verbose        print progress while playing\n";
+}
 
 int main(int argc, char* argv[])
 {
-	if(argc < 3) {
-		std::cerr << "Usage: " << argv[0] << " [LEFT] [RIGHT]\n";
+	BenchOptions options;
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if(arg == "--seeds" && has_value) {
+			options.Seeds = std::max(1, std::atoi(argv[++i]));
+		} else if(arg == "--jobs" && has_value) {
+			options.Jobs = std::max(0, std::atoi(argv[++i]));
+		} else if(arg == "--format" && has_value) {
+			options.Format = argv[++i];
+		} else if(arg == "--rules" && has_value) {
+			options.Rules = argv[++i];
+		} else if(arg == "--score" && has_value) {
+			options.ScoreToWin = std::max(0, std::atoi(argv[++i]));
+		} else if(arg == "--replays") {
+			options.SaveReplays = true;
+		} else if(arg == "--verbose") {
+			options.Verbose = true;
+		} else if(arg.compare(0, 2, "--") == 0) {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		} else {
+			options.Bots.push_back(arg);
+		}
+	}
+
+	if(options.Bots.size() < 2 || (options.Format != "text" && options.Format != "csv" && options.Format != "json")) {
+		printUsage(argv[0]);
 		return EXIT_FAILURE;
 	}
 
-	std::string left_bot = argv[1];
-	std::string right_bot = argv[2];
+	// the results are collected by bot name, so every bot may only take part once
+	for(auto bot = options.Bots.begin(); bot != options.Bots.end(); ++bot) {
+		if(std::find(options.Bots.begin(), bot, *bot) != bot) {
+			std::cerr << "Bot " << *bot << " is given more than once\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(options.Jobs == 0)
+		options.Jobs = std::max(1u, std::thread::hardware_concurrency());
 
 	FileSystem filesys(argv[0]);
 	filesys.setWriteDir("/tmp");
 	filesys.addToSearchPath("data");
 
-	SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_JOYSTICK);
-	srand(SDL_GetTicks());
+	// read the config only once, instead of in every DuelMatch
+	if(options.ScoreToWin == 0)
+		options.ScoreToWin = IUserConfigReader::createUserConfigReader("config.xml")->getInteger("scoretowin");
+
+	// round robin: every pairing once per seed. The game is not symmetric, so two different
+	// bots play twice, each of them once on the left side.
+	std::vector<DuelSetup> duels;
+	for(unsigned seed = 0; seed < options.Seeds; ++seed)
+		for(std::size_t left = 0; left < options.Bots.size(); ++left)
+			for(std::size_t right = left; right < options.Bots.size(); ++right) {
+				duels.push_back( DuelSetup{options.Bots[left], options.Bots[right], seed} );
+				if(right != left)
+					duels.push_back( DuelSetup{options.Bots[right], options.Bots[left], seed} );
+			}
 
 	try
 	{
-		auto result = duel( left_bot, right_bot, true );
-		present( result );
+		// lua's print writes straight to stdout, so a bot that prints would corrupt the csv or
+		// json document. While the duels are played, stdout is sent to stderr.
+		int output = -1;
+		if(options.Format != "text") {
+			std::fflush(stdout);
+			output = dup(STDOUT_FILENO);
+			dup2(STDERR_FILENO, STDOUT_FILENO);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		auto results = tournament( duels, options );
+		std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+
+		if(output != -1) {
+			std::cout.flush();
+			std::fflush(stdout);
+			dup2(output, STDOUT_FILENO);
+			close(output);
+		}
+
+		if(options.Format == "csv") {
+			presentCSV( results );
+		} else if(options.Format == "json") {
+			presentJSON( results, options, wall_time.count() );
+		}
 	} catch (const boost::exception& ex) {
 		// error handling
 		std::cerr <<  boost::diagnostic_information(ex);
@@ -82,32 +196,82 @@ int main(int argc, char* argv[])
 	return EXIT_SUCCESS;
 }
 
+std::vector<DuelResult> tournament(const std::vector<DuelSetup>& duels, const BenchOptions& options)
+{
+	std::vector<DuelResult> results(duels.size());
+	std::atomic<std::size_t> next_duel{0};
+	std::mutex output_mutex;
+	std::exception_ptr error;
+
+	// every worker takes the next duel that has not been started yet. The Lua states are not
+	// shared between duels, so the workers need no synchronisation besides the output.
+	auto worker = [&]() {
+		for(std::size_t index = next_duel++; index < duels.size(); index = next_duel++)
+		{
+			try {
+				results[index] = duel( duels[index], options );
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(output_mutex);
+				if(!error)
+					error = std::current_exception();
+				next_duel = duels.size();
+				return;
+			}
+
+			if(options.Format == "text") {
+				std::lock_guard<std::mutex> lock(output_mutex);
+				present( results[index] );
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for(unsigned i = 1; i < std::min<std::size_t>(options.Jobs, duels.size()); ++i)
+		workers.emplace_back(worker);
+	worker();
+	for(auto& thread : workers)
+		thread.join();
+
+	if(error)
+		std::rethrow_exception(error);
 
-DuelResult duel(std::string left, std::string right, bool verbose) {
-	DuelMatch match{false, "default.lua"};
+	return results;
+}
+
+DuelResult duel(const DuelSetup& setup, const BenchOptions& options) {
+	const std::string& left = setup.LeftPlayer;
+	const std::string& right = setup.RightPlayer;
+
+	// the match is simulated as fast as possible, so all timing has to follow the simulated steps
+	DuelMatch match{false, options.Rules, options.ScoreToWin, SimulationClock::createFixedStepClock(75.f)};
 	auto leftInput = std::make_shared<ScriptedInputSource>("scripts/" + left, LEFT_PLAYER, 0, &match);
 	auto rightInput = std::make_shared<ScriptedInputSource>("scripts/" + right, RIGHT_PLAYER, 0, &match);
 	leftInput->setWaitTime(5);
 	rightInput->setWaitTime(5);
+	leftInput->setRandomSeed(2 * setup.Seed);
+	rightInput->setRandomSeed(2 * setup.Seed + 1);
 
 	match.setPlayers(PlayerIdentity{}, PlayerIdentity{});
 	match.setInputSources(leftInput, rightInput);
 
 	ReplayRecorder recorder;
 	recorder.setGameSpeed( 75 );
-	recorder.setGameRules( "default.lua" );
+	recorder.setGameRules( options.Rules );
 	recorder.setPlayerNames(left, right);
 
-	int timer = 0;
+	long timer = 0;
+	auto start = std::chrono::steady_clock::now();
 
 	while (match.winningPlayer() == NO_PLAYER)
 	{
 		++timer;
 		recorder.record(match.getState());
 		match.step();
-		if(verbose && timer % 10000 == 0) {
-			std::cout << timer / 1000 << "k steps: ";
-			std::cout << match.getScore(LEFT_PLAYER) << " - " << match.getScore(RIGHT_PLAYER) << "\n";
+		if(options.Verbose && timer % 10000 == 0) {
+			std::stringstream progress;
+			progress << left << " vs " << right << " (" << setup.Seed << "), " << timer / 1000 << "k steps: ";
+			progress << match.getScore(LEFT_PLAYER) << " - " << match.getScore(RIGHT_PLAYER) << "\n";
+			std::cerr << progress.str();
 		}
 
 		// stop at 12 hours
@@ -116,17 +280,78 @@ DuelResult duel(std::string left, std::string right, bool verbose) {
 		}
 	}
 
+	std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+
 	recorder.record( match.getState() );
 	recorder.finalize( match.getScore(LEFT_PLAYER), match.getScore(RIGHT_PLAYER) );
 
-	FileWrite save_target{"bot-fight.bvr"};
-	recorder.save(save_target);
+	if(options.SaveReplays) {
+		std::stringstream name;
+		name << "bot-fight-" << left << "-" << right << "-" << setup.Seed << ".bvr";
+		FileWrite save_target{name.str()};
+		recorder.save(save_target);
+	}
 
-	return {std::move(left), std::move(right), match.getScore(LEFT_PLAYER), match.getScore(RIGHT_PLAYER), timer / 75};
+	return {left, right, setup.Seed, match.getScore(LEFT_PLAYER), match.getScore(RIGHT_PLAYER),
+			int(timer / 75), timer, wall_time.count()};
 }
 
 void present(const DuelResult& result) {
 	std::cout << result.LeftPlayer << " vs " << result.RightPlayer << ": "
 	          << result.LeftScore << " - " << result.RightScore << " in "
-			  << result.Duration << " seconds of game time\n";
-}
\ No newline at end of file
+			  << result.Duration << " seconds of game time"
+			  << " (seed " << result.Seed << ", " << int(result.Steps / std::max(result.WallTime, 1e-6)) << " steps/s)\n";
+}
+
+void presentCSV(const std::vector<DuelResult>& results) {
+	std::cout << "left,right,seed,left_score,right_score,game_seconds,steps,wall_seconds,steps_per_second\n";
+	for(const auto& r : results) {
+		std::cout << r.LeftPlayer << "," << r.RightPlayer << "," << r.Seed << ","
+				  << r.LeftScore << "," << r.RightScore << "," << r.Duration << ","
+				  << r.Steps << "," << r.WallTime << "," << r.Steps / std::max(r.WallTime, 1e-6) << "\n";
+	}
+}
+
+void presentJSON(const std::vector<DuelResult>& results, const BenchOptions& options, double wall_time) {
+	long total_steps = 0;
+	for(const auto& r : results)
+		total_steps += r.Steps;
+
+	// points[i][j]: points bot i scored against bot j, summed over all seeds and sides
+	std::size_t bot_count = options.Bots.size();
+	std::vector<std::vector<int>> points(bot_count, std::vector<int>(bot_count, 0));
+	auto index_of = [&](const std::string& bot) {
+		return std::find(options.Bots.begin(), options.Bots.end(), bot) - options.Bots.begin();
+	};
+	for(const auto& r : results) {
+		points[index_of(r.LeftPlayer)][index_of(r.RightPlayer)] += r.LeftScore;
+		points[index_of(r.RightPlayer)][index_of(r.LeftPlayer)] += r.RightScore;
+	}
+
+	std::cout << "{\n  \"bots\": [";
+	for(std::size_t i = 0; i < bot_count; ++i)
+		std::cout << (i ? ", " : "") << "\"" << options.Bots[i] << "\"";
+	std::cout << "],\n  \"rules\": \"" << options.Rules << "\",\n  \"seeds\": " << options.Seeds
+			  << ",\n  \"jobs\": " << options.Jobs
+			  << ",\n  \"total_steps\": " << total_steps
+			  << ",\n  \"wall_seconds\": " << wall_time
+			  << ",\n  \"steps_per_second\": " << total_steps / std::max(wall_time, 1e-6)
+			  << ",\n  \"points\": [\n";
+	for(std::size_t i = 0; i < bot_count; ++i) {
+		std::cout << "    [";
+		for(std::size_t j = 0; j < bot_count; ++j)
+			std::cout << (j ? ", " : "") << points[i][j];
+		std::cout << "]" << (i + 1 < bot_count ? ",\n" : "\n");
+	}
+	std::cout << "  ],\n  \"duels\": [\n";
+	for(std::size_t i = 0; i < results.size(); ++i) {
+		const auto& r = results[i];
+		std::cout << "    {\"left\": \"" << r.LeftPlayer << "\", \"right\": \"" << r.RightPlayer
+				  << "\", \"seed\": " << r.Seed << ", \"left_score\": " << r.LeftScore
+				  << ", \"right_score\": " << r.RightScore << ", \"game_seconds\": " << r.Duration
+				  << ", \"steps\": " << r.Steps << ", \"wall_seconds\": " << r.WallTime
+				  << ", \"steps_per_second\": " << r.Steps / std::max(r.WallTime, 1e-6) << "}"
+				  << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	std::cout << "  ]\n}\n";
+}
@@ -0,0 +1,642 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* includes */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "raknet/RakClient.h"
+#include "raknet/BitStream.h"
+#include "raknet/PacketEnumerations.h"
+#include "raknet/RakNetStatistics.h"
+
+#include "Global.h"
+#include "GenericIO.h"
+#include "NetworkMessage.h"
+#include "NetworkSnapshot.h"
+#include "PlayerIdentity.h"
+#include "PlayerInput.h"
+
+/* implementation */
+
+// Opens many synthetic clients against a blobby server. Every pair of clients opens and joins
+// a game in the lobby, just like players would do it, and then sends inputs at game speed.
+// All clients are polled from a single thread; RakNet receives for each of them in its own thread.
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadOptions {
+	std::string Host = "127.0.0.1";
+	unsigned short Port = BLOBBY_PORT;
+	unsigned Clients = 100;
+	double Duration = 30;
+	unsigned ConnectInterval = 5;
+	unsigned Speed = 0;
+	unsigned Rules = 0;
+	unsigned ScoreToWin = 25;
+	bool RequestRules = true;
+	std::string Format = "text";
+	bool Verbose = false;
+};
+
+enum class ClientState {
+	CONNECTING,		// waiting for the connection to be accepted
+	PROBING,		// sent ID_BLOBBY_SERVER_PRESENT, waiting for the answer
+	LOBBY,			// entered the server, waiting for the first lobby status
+	WAITING,		// opened or joined a game, waiting for the opponent
+	STARTING,		// answered the rules checksum, waiting for ID_GAME_READY
+	PLAYING,
+	FINISHED,		// the game was won by one of the players
+	FAILED
+};
+
+const char* stateName(ClientState state)
+{
+	switch(state) {
+		case ClientState::CONNECTING: return "connecting";
+		case ClientState::PROBING: return "probing";
+		case ClientState::LOBBY: return "lobby";
+		case ClientState::WAITING: return "waiting";
+		case ClientState::STARTING: return "starting";
+		case ClientState::PLAYING: return "playing";
+		case ClientState::FINISHED: return "finished";
+		case ClientState::FAILED: return "failed";
+	}
+	return "unknown";
+}
+
+struct FakeClient {
+	std::unique_ptr<RakClient> Client;
+	unsigned Index = 0;
+	ClientState State = ClientState::CONNECTING;
+
+	// lobby: even clients open a game, which the next client joins
+	bool Host = false;
+	bool GameJoined = false;
+	bool GameStarted = false;
+	unsigned GameId = 0;
+	bool HasGameId = false;
+
+	// game
+	int GameSpeed = 0;
+	unsigned Step = 0;
+	unsigned FirstInput = 0;
+	Clock::time_point NextInput;
+	SnapshotHistory Snapshots;
+	bool HasSnapshot = false;
+	std::uint16_t LastSnapshot = 0;
+	bool HasUpdate = false;
+	Clock::time_point LastUpdate;
+};
+
+struct LoadStats {
+	std::vector<float> RoundTrips;		// ms between sending an input and the update that answered it
+	std::vector<float> Jitter;			// ms the update interval differed from the game step
+	unsigned long InputsSent = 0;
+	unsigned long UpdatesReceived = 0;
+	unsigned long UpdatesLost = 0;		// gaps in the snapshot sequence numbers
+	unsigned long UpdatesUndecodable = 0;	// deltas against a snapshot we no longer know
+	unsigned long RulesBytes = 0;
+	unsigned long MessageResends = 0;
+	unsigned long SequencedOutOfOrder = 0;
+	unsigned GamesStarted = 0;
+	unsigned GamesFinished = 0;
+	std::map<std::string, unsigned> Failures;
+	std::map<std::string, unsigned> FinalStates;
+};
+
+struct Summary {
+	float Mean, P50, P99, Max;
+};
+
+void printUsage(const char* program)
+{
+	std::cerr << "Usage: " << program << " [OPTIONS]\n"
+			  << "Connects synthetic players to a blobby server, lets them play against each other in pairs\n"
+			  << "and reports the update jitter, input to update round trip time and packet loss.\n"
+			  << "Options:\n"
+			  << "  --host HOST      server to connect to (default 127.0.0.1)\n"
+			  << "  --port PORT      port of the server (default " << BLOBBY_PORT << ")\n"
+			  << "  --clients N      number of players, rounded up to an even number (default 100)\n"
+			  << "  --duration S     seconds to run after the first client connected (default 30)\n"
+			  << "  --interval MS    milliseconds between two connection attempts (default 5)\n"
+			  << "  --speed N        index of the game speed offered by the server (default 0)\n"
+			  << "  --rules N        index of the rules offered by the server (default 0)\n"
+			  << "  --score N        score to win (default 25)\n"
+			  << "  --cached-rules   pretend to have the rules already, so the server does not send them\n"
+			  << "  --format FORMAT  output format: text or json (default text)\n"
+			  << "  --verbose        print progress every second\n";
+}
+
+void connectClient(FakeClient& client, const LoadOptions& options);
+void processPackets(FakeClient& client, std::vector<FakeClient>& clients, const LoadOptions& options, LoadStats& stats);
+void sendInput(FakeClient& client, LoadStats& stats);
+void fail(FakeClient& client, const std::string& reason, LoadStats& stats);
+void presentProgress(const std::vector<FakeClient>& clients, double elapsed);
+void present(const LoadStats& stats, const LoadOptions& options, double wall_time);
+void presentJSON(const LoadStats& stats, const LoadOptions& options, double wall_time);
+
+int main(int argc, char* argv[])
+{
+	LoadOptions options;
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if(arg == "--host" && has_value) {
+			options.Host = argv[++i];
+		} else if(arg == "--port" && has_value) {
+			options.Port = std::atoi(argv[++i]);
+		} else if(arg == "--clients" && has_value) {
+			options.Clients = std::max(2, std::atoi(argv[++i]));
+		} else if(arg == "--duration" && has_value) {
+			options.Duration = std::max(1.0, std::atof(argv[++i]));
+		} else if(arg == "--interval" && has_value) {
+			options.ConnectInterval = std::max(0, std::atoi(argv[++i]));
+		} else if(arg == "--speed" && has_value) {
+			options.Speed = std::max(0, std::atoi(argv[++i]));
+		} else if(arg == "--rules" && has_value) {
+			options.Rules = std::max(0, std::atoi(argv[++i]));
+		} else if(arg == "--score" && has_value) {
+			options.ScoreToWin = std::max(1, std::atoi(argv[++i]));
+		} else if(arg == "--cached-rules") {
+			options.RequestRules = false;
+		} else if(arg == "--format" && has_value) {
+			options.Format = argv[++i];
+		} else if(arg == "--verbose") {
+			options.Verbose = true;
+		} else {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(options.Format != "text" && options.Format != "json") {
+		printUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// every game needs two players
+	options.Clients += options.Clients % 2;
+
+	std::vector<FakeClient> clients(options.Clients);
+	for(unsigned i = 0; i < clients.size(); ++i)
+	{
+		clients[i].Index = i;
+		clients[i].Host = i % 2 == 0;
+	}
+
+	// raknet logs every new socket to stdout, which would be mixed into the results
+	std::streambuf* output = std::cout.rdbuf();
+	std::cout.rdbuf(std::cerr.rdbuf());
+
+	LoadStats stats;
+	unsigned connected = 0;
+	auto start = Clock::now();
+	auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.Duration));
+	auto next_connect = start;
+	auto next_progress = start + std::chrono::seconds(1);
+
+	while(Clock::now() < end)
+	{
+		auto now = Clock::now();
+		// spread the connection attempts, a real server does not see hundreds of players at once
+		while(connected < clients.size() && now >= next_connect)
+		{
+			connectClient(clients[connected++], options);
+			next_connect += std::chrono::milliseconds(options.ConnectInterval);
+		}
+
+		for(auto& client : clients)
+		{
+			if(!client.Client)
+				continue;
+
+			processPackets(client, clients, options, stats);
+			if(client.State == ClientState::PLAYING && Clock::now() >= client.NextInput)
+				sendInput(client, stats);
+		}
+
+		if(options.Verbose && now >= next_progress)
+		{
+			presentProgress(clients, std::chrono::duration<double>(now - start).count());
+			next_progress += std::chrono::seconds(1);
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	std::chrono::duration<double> wall_time = Clock::now() - start;
+
+	for(auto& client : clients)
+	{
+		stats.FinalStates[stateName(client.State)]++;
+		if(!client.Client)
+			continue;
+
+		if(RakNetStatisticsStruct* statistics = client.Client->GetStatistics())
+		{
+			stats.MessageResends += statistics->messageResends;
+			stats.SequencedOutOfOrder += statistics->sequencedMessagesOutOfOrder;
+		}
+		client.Client->Disconnect(10);
+	}
+
+	std::cout.rdbuf(output);
+
+	if(options.Format == "json") {
+		presentJSON(stats, options, wall_time.count());
+	} else {
+		present(stats, options, wall_time.count());
+	}
+
+	return stats.Failures.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void connectClient(FakeClient& client, const LoadOptions& options)
+{
+	client.Client.reset(new RakClient());
+	if(!client.Client->Connect(options.Host.c_str(), options.Port, 0, 0, RAKNET_THREAD_SLEEP_TIME))
+	{
+		client.State = ClientState::FAILED;
+		std::cerr << "could not start client " << client.Index << "\n";
+	}
+}
+
+void fail(FakeClient& client, const std::string& reason, LoadStats& stats)
+{
+	if(client.State == ClientState::FAILED)
+		return;
+
+	client.State = ClientState::FAILED;
+	stats.Failures[reason]++;
+}
+
+void processPackets(FakeClient& client, std::vector<FakeClient>& clients, const LoadOptions& options, LoadStats& stats)
+{
+	packet_ptr packet;
+	while (nullptr != (packet = client.Client->Receive()))
+	{
+		auto now = Clock::now();
+		switch(packet->data[0])
+		{
+			case ID_CONNECTION_REQUEST_ACCEPTED:
+			{
+				// ask for the server info first, like the server search does
+				RakNet::BitStream stream;
+				stream.Write((unsigned char)ID_BLOBBY_SERVER_PRESENT);
+				stream.Write(BLOBBY_VERSION_MAJOR);
+				stream.Write(BLOBBY_VERSION_MINOR);
+				client.Client->Send(&stream, LOW_PRIORITY, RELIABLE_ORDERED, 0);
+				client.State = ClientState::PROBING;
+				break;
+			}
+			case ID_BLOBBY_SERVER_PRESENT:
+			{
+				if(client.State != ClientState::PROBING)
+					break;
+
+				PlayerIdentity identity("loadgen " + std::to_string(client.Index));
+				identity.setPreferredSide(client.Host ? LEFT_PLAYER : RIGHT_PLAYER);
+				identity.setStaticColor(Color(client.Index * 37 % 256, 100, 200));
+
+				RakNet::BitStream stream;
+				makeEnterServerPacket(stream, identity);
+				client.Client->Send(&stream, LOW_PRIORITY, RELIABLE_ORDERED, 0);
+				client.State = ClientState::LOBBY;
+				break;
+			}
+			case ID_VERSION_MISMATCH:
+				fail(client, "version mismatch", stats);
+				break;
+			case ID_CONNECTION_ATTEMPT_FAILED:
+				fail(client, "connection attempt failed", stats);
+				break;
+			case ID_NO_FREE_INCOMING_CONNECTIONS:
+				fail(client, "server full", stats);
+				break;
+			case ID_CONNECTION_LOST:
+			case ID_DISCONNECTION_NOTIFICATION:
+				fail(client, "disconnected", stats);
+				break;
+			case ID_OPPONENT_DISCONNECTED:
+				if(client.State != ClientState::FINISHED)
+					fail(client, "opponent disconnected", stats);
+				break;
+			case ID_LOBBY:
+			{
+				RakNet::BitStream stream(packet->data, packet->length, false);
+				auto in = createGenericReader( &stream );
+				unsigned char t;
+				in->byte(t);
+				in->byte(t);
+
+				if((LobbyPacketType)t == LobbyPacketType::SERVER_STATUS && client.State == ClientState::LOBBY)
+				{
+					client.State = ClientState::WAITING;
+					if(client.Host)
+					{
+						RakNet::BitStream open;
+						open.Write((unsigned char)ID_LOBBY);
+						open.Write((unsigned char)LobbyPacketType::OPEN_GAME);
+						auto writer = createGenericWriter(&open);
+						writer->generic<unsigned int>(options.Speed);
+						writer->generic<unsigned int>(options.ScoreToWin);
+						writer->generic<unsigned int>(options.Rules);
+						writer->generic<std::string>("");
+						client.Client->Send(&open, HIGH_PRIORITY, RELIABLE_ORDERED, 0);
+					}
+				}
+				else if((LobbyPacketType)t == LobbyPacketType::GAME_STATUS && client.Host && !client.GameStarted)
+				{
+					uint32_t id, speed, rules, score;
+					PlayerID creator;
+					std::string name;
+					std::vector<PlayerID> others;
+					in->uint32( id );
+					in->generic<PlayerID>( creator );
+					in->string( name );
+					in->uint32( speed );
+					in->uint32( rules );
+					in->uint32( score );
+					in->generic<std::vector<PlayerID>>( others );
+
+					// our partner joins as soon as it knows which game to join
+					client.GameId = id;
+					client.HasGameId = true;
+
+					if(!others.empty())
+					{
+						RakNet::BitStream begin;
+						begin.Write((unsigned char)ID_LOBBY);
+						begin.Write((unsigned char)LobbyPacketType::START_GAME);
+						auto writer = createGenericWriter(&begin);
+						writer->generic<PlayerID>( others.front() );
+						client.Client->Send(&begin, LOW_PRIORITY, RELIABLE_ORDERED, 0);
+						client.GameStarted = true;
+					}
+				}
+				break;
+			}
+			case ID_RULES_CHECKSUM:
+			{
+				RakNet::BitStream stream;
+				stream.Write((unsigned char)ID_RULES);
+				stream.Write(options.RequestRules);
+				client.Client->Send(&stream, HIGH_PRIORITY, RELIABLE_ORDERED, 0);
+				client.State = ClientState::STARTING;
+				break;
+			}
+			case ID_RULES:
+				stats.RulesBytes += packet->length;
+				break;
+			case ID_GAME_READY:
+			{
+				RakNet::BitStream stream(packet->data, packet->length, false);
+				stream.IgnoreBytes(1);	// ignore ID_GAME_READY
+				stream.Read(client.GameSpeed);
+				client.GameSpeed = std::max(client.GameSpeed, 1);
+
+				client.State = ClientState::PLAYING;
+				client.NextInput = now;
+				if(client.Host)
+					stats.GamesStarted++;
+				break;
+			}
+			case ID_GAME_UPDATE:
+			{
+				// updates are unreliable, so they may overtake ID_GAME_READY
+				if(client.State != ClientState::PLAYING)
+					break;
+
+				RakNet::BitStream stream(packet->data, packet->length, false);
+				stream.IgnoreBytes(1);	//ID_GAME_UPDATE
+				unsigned timeBack;
+				stream.Read(timeBack);
+				stats.UpdatesReceived++;
+
+				// until the server has seen our first input, it sends back a time we never sent
+				unsigned millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+				if(client.Step != 0 && millis - timeBack <= millis - client.FirstInput)
+					stats.RoundTrips.push_back(float(millis - timeBack));
+
+				// the server sends one update per step
+				if(client.HasUpdate)
+				{
+					std::chrono::duration<float, std::milli> interval = now - client.LastUpdate;
+					stats.Jitter.push_back(std::abs(interval.count() - 1000.f / client.GameSpeed));
+				}
+				client.HasUpdate = true;
+				client.LastUpdate = now;
+
+				std::uint16_t sequence;
+				unsigned char age;
+				stream.Read(sequence);
+				stream.Read(age);
+
+				if(client.HasSnapshot)
+				{
+					// updates are sent unreliable sequenced, so older ones never arrive after newer ones
+					std::uint16_t gap = sequence - client.LastSnapshot;
+					if(gap > 1 && gap < 0x8000)
+						stats.UpdatesLost += gap - 1;
+				}
+
+				const MatchSnapshot* base = nullptr;
+				if(age != 0)
+				{
+					base = client.Snapshots.find(sequence - age);
+					if(!base)
+					{
+						stats.UpdatesUndecodable++;
+						break;
+					}
+				}
+
+				MatchSnapshot snapshot;
+				if(!readSnapshot(stream, snapshot, base, age))
+				{
+					stats.UpdatesUndecodable++;
+					break;
+				}
+
+				client.Snapshots.store(sequence, snapshot);
+				client.HasSnapshot = true;
+				client.LastSnapshot = sequence;
+				break;
+			}
+			case ID_WIN_NOTIFICATION:
+				if(client.State == ClientState::PLAYING && client.Host)
+					stats.GamesFinished++;
+				client.State = ClientState::FINISHED;
+				break;
+			default:
+				// game events, chat and remote connection notifications are not interesting here
+				break;
+		}
+	}
+
+	// the joining player has to wait until its partner has opened the game
+	if(!client.Host && client.State == ClientState::WAITING && !client.GameJoined)
+	{
+		const FakeClient& partner = clients[client.Index - 1];
+		if(partner.HasGameId)
+		{
+			RakNet::BitStream stream;
+			stream.Write((unsigned char)ID_LOBBY);
+			stream.Write((unsigned char)LobbyPacketType::JOIN_GAME);
+			auto writer = createGenericWriter(&stream);
+			writer->generic<unsigned int>(partner.GameId);
+			writer->generic<std::string>("");
+			client.Client->Send(&stream, LOW_PRIORITY, RELIABLE_ORDERED, 0);
+			client.GameJoined = true;
+		}
+	}
+}
+
+void sendInput(FakeClient& client, LoadStats& stats)
+{
+	// moves back and forth and jumps regularly, the partners are out of phase
+	int phase = (client.Step++ + client.Index * 37) % 120;
+	PlayerInputAbs input(phase < 50, phase >= 60 && phase < 110, phase % 40 < 15);
+
+	// the server echoes this time in its updates, so it only has to be consistent for this process
+	unsigned time = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count();
+
+	if(client.Step == 1)
+		client.FirstInput = time;
+
+	RakNet::BitStream stream;
+	stream.Write((unsigned char)ID_INPUT_UPDATE);
+	stream.Write( time );
+	input.writeTo(stream);
+	stream.Write( client.HasSnapshot );
+	stream.Write( client.LastSnapshot );
+	client.Client->Send(&stream, HIGH_PRIORITY, UNRELIABLE_SEQUENCED, 0);
+	stats.InputsSent++;
+
+	// keep the schedule, but do not try to catch up after a long stall
+	client.NextInput += std::chrono::microseconds(1000000 / client.GameSpeed);
+	client.NextInput = std::max(client.NextInput, Clock::now() - std::chrono::milliseconds(100));
+}
+
+Summary summarize(std::vector<float> samples)
+{
+	if(samples.empty())
+		return {0, 0, 0, 0};
+
+	std::sort(samples.begin(), samples.end());
+	double sum = 0;
+	for(float sample : samples)
+		sum += sample;
+
+	return {float(sum / samples.size()), samples[samples.size() / 2],
+			samples[std::min(samples.size() - 1, samples.size() * 99 / 100)], samples.back()};
+}
+
+void presentProgress(const std::vector<FakeClient>& clients, double elapsed)
+{
+	std::map<std::string, unsigned> states;
+	for(const auto& client : clients)
+		if(client.Client)
+			states[stateName(client.State)]++;
+
+	std::cerr << int(elapsed) << "s:";
+	for(const auto& state : states)
+		std::cerr << " " << state.second << " " << state.first;
+	std::cerr << "\n";
+}
+
+void present(const LoadStats& stats, const LoadOptions& options, double wall_time)
+{
+	auto rtt = summarize(stats.RoundTrips);
+	auto jitter = summarize(stats.Jitter);
+	unsigned long expected = stats.UpdatesReceived + stats.UpdatesLost;
+
+	std::cout << options.Clients << " clients against " << options.Host << ":" << options.Port
+			  << " for " << wall_time << " seconds\n";
+	std::cout << "final states:";
+	for(const auto& state : stats.FinalStates)
+		std::cout << " " << state.second << " " << state.first;
+	std::cout << "\n";
+	for(const auto& failure : stats.Failures)
+		std::cout << "failed: " << failure.second << " " << failure.first << "\n";
+	std::cout << "games: " << stats.GamesStarted << " started, " << stats.GamesFinished << " finished\n"
+			  << "inputs sent: " << stats.InputsSent << ", rules received: " << stats.RulesBytes << " bytes\n"
+			  << "updates: " << stats.UpdatesReceived << " received, " << stats.UpdatesLost << " lost ("
+			  << 100.0 * stats.UpdatesLost / std::max(expected, 1ul) << "%), "
+			  << stats.UpdatesUndecodable << " undecodable\n"
+			  << "raknet: " << stats.MessageResends << " resends, "
+			  << stats.SequencedOutOfOrder << " sequenced messages out of order\n"
+			  << "round trip [ms]: mean " << rtt.Mean << ", p50 " << rtt.P50
+			  << ", p99 " << rtt.P99 << ", max " << rtt.Max << "\n"
+			  << "update jitter [ms]: mean " << jitter.Mean << ", p50 " << jitter.P50
+			  << ", p99 " << jitter.P99 << ", max " << jitter.Max << "\n";
+}
+
+void presentJSON(const LoadStats& stats, const LoadOptions& options, double wall_time)
+{
+	auto rtt = summarize(stats.RoundTrips);
+	auto jitter = summarize(stats.Jitter);
+	auto print_summary = [](const Summary& s) {
+		std::cout << "{\"mean\": " << s.Mean << ", \"p50\": " << s.P50
+				  << ", \"p99\": " << s.P99 << ", \"max\": " << s.Max << "}";
+	};
+	auto print_counts = [](const std::map<std::string, unsigned>& counts) {
+		std::cout << "{";
+		bool first = true;
+		for(const auto& entry : counts) {
+			std::cout << (first ? "" : ", ") << "\"" << entry.first << "\": " << entry.second;
+			first = false;
+		}
+		std::cout << "}";
+	};
+
+	std::cout << "{\n  \"host\": \"" << options.Host << "\",\n  \"port\": " << options.Port
+			  << ",\n  \"clients\": " << options.Clients
+			  << ",\n  \"wall_seconds\": " << wall_time
+			  << ",\n  \"final_states\": ";
+	print_counts(stats.FinalStates);
+	std::cout << ",\n  \"failures\": ";
+	print_counts(stats.Failures);
+	std::cout << ",\n  \"games_started\": " << stats.GamesStarted
+			  << ",\n  \"games_finished\": " << stats.GamesFinished
+			  << ",\n  \"inputs_sent\": " << stats.InputsSent
+			  << ",\n  \"rules_bytes\": " << stats.RulesBytes
+			  << ",\n  \"updates_received\": " << stats.UpdatesReceived
+			  << ",\n  \"updates_lost\": " << stats.UpdatesLost
+			  << ",\n  \"updates_undecodable\": " << stats.UpdatesUndecodable
+			  << ",\n  \"message_resends\": " << stats.MessageResends
+			  << ",\n  \"sequenced_out_of_order\": " << stats.SequencedOutOfOrder
+			  << ",\n  \"round_trip_ms\": ";
+	print_summary(rtt);
+	std::cout << ",\n  \"jitter_ms\": ";
+	print_summary(jitter);
+	std::cout << "\n}\n";
+}
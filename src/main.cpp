@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <atomic>
 #include <thread>
 #include <iostream>
+#include <fstream>
 
 #include <SDL.h>
 
@@ -45,6 +46,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "FileSystem.h"
 #include "state/State.h"
 #include "BlobbyApp.h"
+#include "Tracing.h"
 
 // this global allows the host game thread to be killed
 extern std::atomic<bool> gKillHostThread;
@@ -172,6 +174,14 @@ int main(int argc, char* argv[])
 		SpeedController::setMainInstance(&scontroller);
 		scontroller.setDrawFPS(gameConfig.getBool("showfps"));
 
+		// the trace of the last frames is written on exit
+		std::string traceFile = gameConfig.getString("trace_file", "");
+		if(!traceFile.empty())
+		{
+			setTraceThreadName("main");
+			startTracing();
+		}
+
 		int running = 1;
 
 		DEBUG_STATUS("starting mainloop");
@@ -180,6 +190,8 @@ int main(int argc, char* argv[])
 
 		while (running)
 		{
+			TRACE_SCOPE("frame");
+
 			app.getInputManager().updateInput();
 			running = app.getInputManager().running();
 
@@ -226,6 +238,13 @@ int main(int argc, char* argv[])
 			}
 			scontroller.update();
 		}
+
+		if(isTracing())
+		{
+			stopTracing();
+			std::ofstream trace(traceFile);
+			writeChromeTrace(trace);
+		}
 	}
 	catch (std::exception& e)
 	{
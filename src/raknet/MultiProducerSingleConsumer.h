@@ -0,0 +1,119 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <atomic>
+
+namespace BasicDataStructures
+{
+	/**
+	* @brief Unbounded queue with any number of producers and a single consumer.
+	*
+	* A linked list of nodes, where producers append with a single atomic exchange on the
+	* head, so Push never blocks and never waits for another producer. The consumer reads
+	* from the tail, which only it touches. A Push that is still in progress hides the
+	* elements pushed after it from the consumer until it is finished, so Pop might report
+	* an empty queue a little early; these elements are returned by the next Pop.
+	*/
+	template <class T>
+	class MultiProducerSingleConsumer
+	{
+	public:
+		MultiProducerSingleConsumer();
+		~MultiProducerSingleConsumer();
+
+		MultiProducerSingleConsumer( const MultiProducerSingleConsumer& ) = delete;
+		MultiProducerSingleConsumer& operator=( const MultiProducerSingleConsumer& ) = delete;
+
+		/**
+		* Appends a copy of @em value. Can be called from any thread.
+		*/
+		void Push( const T& value );
+
+		/**
+		* Removes the oldest element and stores it in @em value.
+		* Must only be called from the consumer thread.
+		* @return false if there is no element
+		*/
+		bool Pop( T& value );
+
+		/**
+		* Removes all elements. Must only be called from the consumer thread.
+		*/
+		void Clear( void );
+
+	private:
+		struct Node
+		{
+			std::atomic<Node*> next{nullptr};
+			T value;
+		};
+
+		// the last pushed node, shared by all producers
+		std::atomic<Node*> head;
+		// the node before the next element to pop, only used by the consumer
+		Node* tail;
+	};
+
+	template <class T>
+	MultiProducerSingleConsumer<T>::MultiProducerSingleConsumer()
+	{
+		tail = new Node;
+		head.store( tail, std::memory_order_relaxed );
+	}
+
+	template <class T>
+	MultiProducerSingleConsumer<T>::~MultiProducerSingleConsumer()
+	{
+		Clear();
+		delete tail;
+	}
+
+	template <class T>
+	void MultiProducerSingleConsumer<T>::Push( const T& value )
+	{
+		Node* node = new Node;
+		node->value = value;
+		Node* previous = head.exchange( node, std::memory_order_acq_rel );
+		previous->next.store( node, std::memory_order_release );
+	}
+
+	template <class T>
+	bool MultiProducerSingleConsumer<T>::Pop( T& value )
+	{
+		Node* next = tail->next.load( std::memory_order_acquire );
+		if ( next == nullptr )
+			return false;
+
+		value = next->value;
+		delete tail;
+		tail = next;
+		return true;
+	}
+
+	template <class T>
+	void MultiProducerSingleConsumer<T>::Clear( void )
+	{
+		T value;
+		while ( Pop( value ) )
+			;
+	}
+}
@@ -149,7 +149,24 @@ struct Packet
 	unsigned char* data;
 };
 
-typedef std::shared_ptr<Packet> packet_ptr;
+class PacketPool;
+
+/**
+* @brief Gives a packet back to the pool it was taken from
+*/
+struct PacketDeleter
+{
+	explicit PacketDeleter( PacketPool* pool = 0 ) : pool( pool ) {}
+	void operator()( Packet* packet ) const;
+
+	PacketPool* pool;
+};
+
+/**
+* A received packet. It has a single owner, so it can be moved between threads
+* without any reference counting.
+*/
+typedef std::unique_ptr<Packet, PacketDeleter> packet_ptr;
 
 /**
 *  Index of an unassigned player
@@ -0,0 +1,222 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#include "PacketDataPool.h"
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+namespace
+{
+	const unsigned int NUMBER_OF_SIZE_CLASSES = 4;
+	// inputs and acknowledgements fit into the first class, full datagrams into the last one
+	const unsigned int SIZE_CLASS_BYTES[ NUMBER_OF_SIZE_CLASSES ] = { 32, 128, 512, 2048 };
+	// buffers larger than the largest size class come directly from the heap
+	const unsigned char HEAP_ALLOCATED = 0xFF;
+	// a thread cache keeps at most this many bytes per size class
+	const unsigned int MAXIMUM_CACHED_BYTES = 64 * 1024;
+	// the shared lists keep at most this many bytes per size class, the rest is freed
+	const unsigned int MAXIMUM_SHARED_BYTES = 4 * 1024 * 1024;
+
+	// stored in front of every buffer
+	union Header
+	{
+		unsigned char sizeClass;
+		std::max_align_t alignment;
+	};
+
+	// a free buffer reuses its header for the link to the next free buffer
+	struct FreeBuffer
+	{
+		FreeBuffer* next;
+	};
+
+	static_assert( sizeof( FreeBuffer ) <= sizeof( Header ), "free buffer link does not fit into the header" );
+
+	struct FreeList
+	{
+		FreeBuffer* first;
+		unsigned int count;
+
+		void Push( FreeBuffer* buffer )
+		{
+			buffer->next = first;
+			first = buffer;
+			++count;
+		}
+
+		FreeBuffer* Pop( void )
+		{
+			FreeBuffer* buffer = first;
+			if ( buffer )
+			{
+				first = buffer->next;
+				--count;
+			}
+			return buffer;
+		}
+	};
+
+	struct SharedLists
+	{
+		std::mutex mutex[ NUMBER_OF_SIZE_CLASSES ];
+		FreeList lists[ NUMBER_OF_SIZE_CLASSES ];
+	};
+
+	SharedLists& GetSharedLists( void )
+	{
+		// never destroyed, so threads can still return their buffers while the program shuts down
+		static SharedLists* shared = new SharedLists();
+		return *shared;
+	}
+
+	unsigned int CacheLimit( unsigned char sizeClass )
+	{
+		return MAXIMUM_CACHED_BYTES / SIZE_CLASS_BYTES[ sizeClass ];
+	}
+
+	void FreeChain( FreeBuffer* buffer )
+	{
+		while ( buffer )
+		{
+			FreeBuffer* next = buffer->next;
+			::operator delete( buffer );
+			buffer = next;
+		}
+	}
+
+	// moves @em count buffers from @em list to the shared list
+	void GiveToShared( unsigned char sizeClass, FreeList& list, unsigned int count )
+	{
+		if ( count == 0 )
+			return;
+
+		// unlink the chain before taking the lock
+		FreeBuffer* first = list.first;
+		FreeBuffer* last = first;
+		for ( unsigned int i = 1; i < count; ++i )
+			last = last->next;
+		list.first = last->next;
+		list.count -= count;
+
+		SharedLists& shared = GetSharedLists();
+		{
+			std::lock_guard<std::mutex> lock( shared.mutex[ sizeClass ] );
+			FreeList& target = shared.lists[ sizeClass ];
+			if ( target.count * SIZE_CLASS_BYTES[ sizeClass ] < MAXIMUM_SHARED_BYTES )
+			{
+				last->next = target.first;
+				target.first = first;
+				target.count += count;
+				return;
+			}
+		}
+
+		last->next = 0;
+		FreeChain( first );
+	}
+
+	// moves up to half a cache worth of buffers from the shared list to @em list
+	void TakeFromShared( unsigned char sizeClass, FreeList& list )
+	{
+		SharedLists& shared = GetSharedLists();
+		std::lock_guard<std::mutex> lock( shared.mutex[ sizeClass ] );
+		FreeList& source = shared.lists[ sizeClass ];
+		unsigned int count = CacheLimit( sizeClass ) / 2;
+		while ( count-- > 0 && source.count > 0 )
+			list.Push( source.Pop() );
+	}
+
+	struct ThreadCache
+	{
+		FreeList lists[ NUMBER_OF_SIZE_CLASSES ];
+
+		~ThreadCache();
+	};
+
+	thread_local ThreadCache threadCache;
+	// set once the cache of this thread is destroyed. buffers released afterwards go to the shared lists.
+	thread_local bool threadCacheDestroyed = false;
+
+	ThreadCache::~ThreadCache()
+	{
+		for ( unsigned char sizeClass = 0; sizeClass < NUMBER_OF_SIZE_CLASSES; ++sizeClass )
+			GiveToShared( sizeClass, lists[ sizeClass ], lists[ sizeClass ].count );
+		threadCacheDestroyed = true;
+	}
+}
+
+char* PacketDataPool::Allocate( unsigned int numberOfBytes )
+{
+	unsigned char sizeClass = 0;
+	while ( sizeClass < NUMBER_OF_SIZE_CLASSES && SIZE_CLASS_BYTES[ sizeClass ] < numberOfBytes )
+		++sizeClass;
+
+	Header* header = 0;
+	if ( sizeClass == NUMBER_OF_SIZE_CLASSES )
+	{
+		header = static_cast<Header*>( ::operator new( sizeof( Header ) + numberOfBytes ) );
+		header->sizeClass = HEAP_ALLOCATED;
+		return reinterpret_cast<char*>( header + 1 );
+	}
+
+	if ( !threadCacheDestroyed )
+	{
+		FreeList& list = threadCache.lists[ sizeClass ];
+		if ( list.count == 0 )
+			TakeFromShared( sizeClass, list );
+		header = reinterpret_cast<Header*>( list.Pop() );
+	}
+
+	if ( header == 0 )
+		header = static_cast<Header*>( ::operator new( sizeof( Header ) + SIZE_CLASS_BYTES[ sizeClass ] ) );
+
+	header->sizeClass = sizeClass;
+	return reinterpret_cast<char*>( header + 1 );
+}
+
+void PacketDataPool::Release( void* data )
+{
+	if ( data == 0 )
+		return;
+
+	Header* header = static_cast<Header*>( data ) - 1;
+	unsigned char sizeClass = header->sizeClass;
+	if ( sizeClass == HEAP_ALLOCATED )
+	{
+		::operator delete( header );
+		return;
+	}
+
+	FreeBuffer* buffer = reinterpret_cast<FreeBuffer*>( header );
+	if ( threadCacheDestroyed )
+	{
+		FreeList single = { 0, 0 };
+		single.Push( buffer );
+		GiveToShared( sizeClass, single, 1 );
+		return;
+	}
+
+	FreeList& list = threadCache.lists[ sizeClass ];
+	list.Push( buffer );
+	if ( list.count > CacheLimit( sizeClass ) )
+		GiveToShared( sizeClass, list, list.count / 2 );
+}
@@ -0,0 +1,49 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+/**
+* @brief Allocator for the payload of packets.
+*
+* Every buffer that carries packet data through RakPeer and the ReliabilityLayer is
+* allocated here: the copies of buffered sends, the data of internal packets and the data
+* of the Packet structs handed to the user. Buffers are taken from a few size classes and
+* recycled instead of being returned to the heap. Each thread keeps a small cache of free
+* buffers, so the common case does neither lock nor touch any shared state. Buffers are
+* typically allocated by the network thread and released by the thread that handled the
+* packet, so a cache that grows too large hands half of its buffers to a shared list, from
+* which the other threads refill their caches.
+*
+* Buffers are always released with Release, never with delete [].
+*/
+class PacketDataPool
+{
+public:
+	/**
+	* @return a buffer of at least @em numberOfBytes bytes
+	*/
+	static char* Allocate( unsigned int numberOfBytes );
+
+	/**
+	* Gives a buffer back to the pool. @em data may be 0.
+	*/
+	static void Release( void* data );
+};
@@ -30,6 +30,7 @@
  */
 
 #include "PacketPool.h"
+#include "PacketDataPool.h"
 #include <cassert>
 
 PacketPool::PacketPool()
@@ -60,7 +61,7 @@ void PacketPool::ClearPool( void )
 	{
 		Packet* p = pool.top();
 		pool.pop();
-		delete [] p->data;
+		PacketDataPool::Release( p->data );
 		delete p;
 	}
 
@@ -107,7 +108,7 @@ void PacketPool::ReleasePointer( Packet *p )
 		return ;
 	}
 
-	delete [] p->data;
+	PacketDataPool::Release( p->data );
 	p->data = 0;
 
 	poolMutex.Lock();
@@ -121,3 +122,8 @@ void PacketPool::ReleasePointer( Packet *p )
 	poolMutex.Unlock();
 }
 
+void PacketDeleter::operator()( Packet* packet ) const
+{
+	if ( packet )
+		pool->ReleasePointer( packet );
+}
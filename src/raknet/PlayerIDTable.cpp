@@ -0,0 +1,137 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#include "PlayerIDTable.h"
+
+void PlayerIDTable::Reset( unsigned short maximumEntries )
+{
+	// keep the load factor at or below one half, so probe sequences stay short
+	unsigned capacity = 8;
+	while ( capacity < 2u * maximumEntries )
+		capacity *= 2;
+
+	entries.assign( capacity, Entry{ UNASSIGNED_PLAYER_ID, 0 } );
+	mask = capacity - 1;
+}
+
+void PlayerIDTable::Clear( void )
+{
+	version.fetch_add( 1, std::memory_order_acq_rel );
+	for ( auto& entry : entries )
+		entry.playerId = UNASSIGNED_PLAYER_ID;
+	version.fetch_add( 1, std::memory_order_release );
+}
+
+unsigned PlayerIDTable::Hash( PlayerID playerId ) const
+{
+	// binaryAddress is in network byte order, so on little endian machines the host part of the
+	// address ends up in the high bits. mix all bits down with the murmur3 finalizer.
+	unsigned hash = playerId.binaryAddress ^ ( playerId.port * 0x9E3779B1u );
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6Bu;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35u;
+	hash ^= hash >> 16;
+	return hash & mask;
+}
+
+void PlayerIDTable::Insert( PlayerID playerId, unsigned short index )
+{
+	if ( entries.empty() || playerId == UNASSIGNED_PLAYER_ID )
+		return;
+
+	unsigned slot = Hash( playerId );
+	while ( entries[ slot ].playerId != UNASSIGNED_PLAYER_ID )
+		slot = ( slot + 1 ) & mask;
+
+	// the fields are written non-atomically, so a concurrent reader has to retry
+	version.fetch_add( 1, std::memory_order_acq_rel );
+	entries[ slot ].index = index;
+	entries[ slot ].playerId = playerId;
+	version.fetch_add( 1, std::memory_order_release );
+}
+
+void PlayerIDTable::Remove( PlayerID playerId )
+{
+	int found = FindEntry( playerId );
+	if ( found < 0 )
+		return;
+
+	version.fetch_add( 1, std::memory_order_acq_rel );
+
+	// backward shift deletion: move following entries of the probe sequence into the gap,
+	// so we don't need tombstones
+	unsigned gap = found;
+	unsigned slot = ( gap + 1 ) & mask;
+	while ( entries[ slot ].playerId != UNASSIGNED_PLAYER_ID )
+	{
+		unsigned home = Hash( entries[ slot ].playerId );
+		// the entry may be moved if its home slot is not in the cyclic range (gap, slot]
+		bool inRange = gap <= slot ? ( gap < home && home <= slot ) : ( gap < home || home <= slot );
+		if ( !inRange )
+		{
+			entries[ gap ] = entries[ slot ];
+			gap = slot;
+		}
+		slot = ( slot + 1 ) & mask;
+	}
+	entries[ gap ].playerId = UNASSIGNED_PLAYER_ID;
+
+	version.fetch_add( 1, std::memory_order_release );
+}
+
+int PlayerIDTable::FindEntry( PlayerID playerId ) const
+{
+	if ( entries.empty() || playerId == UNASSIGNED_PLAYER_ID )
+		return -1;
+
+	unsigned slot = Hash( playerId );
+	// the load factor guarantees an empty slot, the bound only protects against concurrent modifications
+	for ( unsigned probes = 0; probes <= mask; ++probes )
+	{
+		const Entry& entry = entries[ slot ];
+		if ( entry.playerId == playerId )
+			return slot;
+		if ( entry.playerId == UNASSIGNED_PLAYER_ID )
+			return -1;
+		slot = ( slot + 1 ) & mask;
+	}
+
+	return -1;
+}
+
+int PlayerIDTable::Find( PlayerID playerId ) const
+{
+	while ( true )
+	{
+		unsigned before = version.load( std::memory_order_acquire );
+		if ( before & 1 )
+			continue;
+
+		int found = FindEntry( playerId );
+		int index = found >= 0 ? entries[ found ].index : -1;
+
+		// the result is only valid if the table was not changed while we read it. this also
+		// catches entries that were moved past us, or copied while we read them.
+		std::atomic_thread_fence( std::memory_order_acquire );
+		if ( version.load( std::memory_order_relaxed ) == before )
+			return index;
+	}
+}
@@ -0,0 +1,81 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+
+#include "NetworkTypes.h"
+
+/**
+* @brief Maps player ids to their slot in the remote system list of RakPeer.
+*
+* An open addressing hash table with linear probing. The capacity is fixed when the table
+* is reset, so the entries are never reallocated while the peer is running.
+* Modifications are only done by the network thread. Lookups from other threads might
+* run concurrently, so every modification is bracketed by a version increment, and a lookup
+* is repeated if the version was odd or changed while it was running.
+* A found slot has to be checked against the remote system list by the caller anyway.
+*/
+class PlayerIDTable
+{
+public:
+	/**
+	* Removes all entries and prepares the table to hold up to @em maximumEntries entries
+	*/
+	void Reset( unsigned short maximumEntries );
+
+	/**
+	* Removes all entries
+	*/
+	void Clear( void );
+
+	/**
+	* Adds @em playerId, which is stored in slot @em index
+	* @pre @em playerId is not in the table
+	*/
+	void Insert( PlayerID playerId, unsigned short index );
+
+	/**
+	* Removes @em playerId, if it is in the table
+	*/
+	void Remove( PlayerID playerId );
+
+	/**
+	* @return the slot of @em playerId, or -1 if it is not in the table
+	*/
+	int Find( PlayerID playerId ) const;
+
+private:
+	struct Entry
+	{
+		PlayerID playerId;
+		unsigned short index;
+	};
+
+	unsigned Hash( PlayerID playerId ) const;
+	int FindEntry( PlayerID playerId ) const;
+
+	std::vector<Entry> entries;
+	unsigned mask = 0;
+	// odd while the table is modified
+	std::atomic<unsigned> version{0};
+};
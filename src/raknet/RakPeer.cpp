@@ -37,12 +37,15 @@
 #define closesocket close
 #include <unistd.h>
 #include <pthread.h>
+#include <poll.h>
+#include <fcntl.h>
 #endif
 #include <ctype.h> // toupper
 
 #include "GetTime.h"
 #include "PacketEnumerations.h"
 #include "PacketPool.h"
+#include "PacketDataPool.h"
 
 // alloca
 #ifdef _WIN32
@@ -121,6 +124,20 @@ RakPeer::RakPeer()
 	myPlayerId = UNASSIGNED_PLAYER_ID;
 	allowConnectionResponseIPMigration = false;
 	incomingPacketQueue.clearAndForceAllocation(128);
+
+#ifndef _WIN32
+	wakeupPending = false;
+	if ( pipe( wakeupPipe ) == 0 )
+	{
+		fcntl( wakeupPipe[ 0 ], F_SETFL, O_NONBLOCK );
+		fcntl( wakeupPipe[ 1 ], F_SETFL, O_NONBLOCK );
+	}
+	else
+	{
+		// poll ignores negative descriptors, so we just fall back to waking up every threadSleepTimer ms
+		wakeupPipe[ 0 ] = wakeupPipe[ 1 ] = -1;
+	}
+#endif
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -129,6 +146,14 @@ RakPeer::RakPeer()
 RakPeer::~RakPeer()
 {
 	Disconnect( 0 );
+
+#ifndef _WIN32
+	if ( wakeupPipe[ 0 ] >= 0 )
+	{
+		close( wakeupPipe[ 0 ] );
+		close( wakeupPipe[ 1 ] );
+	}
+#endif
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -186,6 +211,7 @@ bool RakPeer::Initialize( unsigned short MaximumNumberOfPeers, unsigned short lo
 			remoteSystemList[ i ].playerId = UNASSIGNED_PLAYER_ID;
 	//		remoteSystemList[ i ].allowPlayerIdAssigment=true;
 		}
+		remoteSystemLookup.Reset( remoteSystemListSize );
 	}
 
 	// For histogram statistics
@@ -335,7 +361,7 @@ bool RakPeer::Connect( const char* host, unsigned short remotePort )
 			Packet * p;
 			p = packetPool.GetPointer();
 
-			p->data = new unsigned char [ 1 ];
+			p->data = ( unsigned char* ) PacketDataPool::Allocate( 1 );
 			p->data[ 0 ] = (unsigned char) ID_NO_FREE_INCOMING_CONNECTIONS;
 			p->playerId = myPlayerId;
 			p->playerIndex = ( PlayerIndex ) GetIndexFromPlayerID( myPlayerId );
@@ -423,6 +449,7 @@ void RakPeer::Disconnect( unsigned int blockDuration )
 	{
 		// Stop the threads
 		endThreads = true;
+		WakeUpdateThread();
 
 		// Normally the thread will call DecreaseUserCount on termination but if we aren't using threads just do it
 		// manually
@@ -445,6 +472,7 @@ void RakPeer::Disconnect( unsigned int blockDuration )
 		// Remove any remaining packets
 		remoteSystemList[ i ].reliabilityLayer.Reset();
 	}
+	remoteSystemLookup.Clear();
 	//rakPeerMutexes[ remoteSystemList_Mutex ].Unlock();
 
 	// Setting maximumNumberOfPeers to 0 allows remoteSystemList to be reallocated in Initialize.
@@ -545,7 +573,7 @@ bool RakPeer::GetConnectionList( PlayerID *remoteSystems, unsigned short *number
 // playerId: Who to send this packet to, or in the case of broadcasting who not to send it to. Use UNASSIGNED_PLAYER_ID to specify none
 // broadcast: True to send this packet to all connected systems.  If true, then playerId specifies who not to send the packet to.
 // Returns:
-// False if we are not connected to the specified recipient.  True otherwise
+// False if the packet could not be queued. Sends to recipients we are not connected to are dropped by the update thread.
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 bool RakPeer::Send( const char *data, const long length, PacketPriority priority, PacketReliability reliability, char orderingChannel, PlayerID playerId, bool broadcast )
 {
@@ -576,15 +604,11 @@ bool RakPeer::Send( const RakNet::BitStream * bitStream, PacketPriority priority
 	if ( broadcast == false && playerId == UNASSIGNED_PLAYER_ID )
 		return false;
 
-	if (ValidSendTarget(playerId, broadcast))
-	{
-		// Sends need to be buffered and processed in the update thread because the playerID associated with the reliability layer can change,
-		// from that thread, resulting in a send to the wrong player!  While I could mutex the playerID, that is much slower than doing this
-		SendBuffered(bitStream, priority, reliability, orderingChannel, playerId, broadcast, RemoteSystemStruct::NO_ACTION);
-		return true;
-	}
-
-	return false;
+	// Sends need to be buffered and processed in the update thread because the playerID associated with the reliability layer can change,
+	// from that thread, resulting in a send to the wrong player!  While I could mutex the playerID, that is much slower than doing this.
+	// For the same reason, the target is only validated by the update thread, when the send is taken from the buffer.
+	SendBuffered(bitStream, priority, reliability, orderingChannel, playerId, broadcast, RemoteSystemStruct::NO_ACTION);
+	return true;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -633,21 +657,7 @@ packet_ptr RakPeer::Receive( void )
 	assert( val->data );
 #endif
 
-	struct deleter
-	{
-		RakPeer* peer;
-		void operator()(Packet* p)
-		{
-			if ( p == 0 )
-				return ;
-
-			peer->packetPool.ReleasePointer( p );
-		}
-	};
-
-	deleter del;
-	del.peer = this;
-	return packet_ptr(val, del);
+	return packet_ptr( val, PacketDeleter( &packetPool ) );
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -689,9 +699,9 @@ int RakPeer::GetIndexFromPlayerID( PlayerID playerId )
 	if ( playerId == UNASSIGNED_PLAYER_ID )
 		return -1;
 
-	for ( i = 0; i < maximumNumberOfPeers; i++ )
-		if ( remoteSystemList[ i ].playerId == playerId )
-			return i;
+	i = remoteSystemLookup.Find( playerId );
+	if ( i < maximumNumberOfPeers && remoteSystemList[ i ].playerId == playerId )
+		return i;
 
 	return -1;
 }
@@ -1120,9 +1130,9 @@ RakPeer::RemoteSystemStruct *RakPeer::GetRemoteSystemFromPlayerID( PlayerID play
 	if ( playerID == UNASSIGNED_PLAYER_ID )
 		return 0;
 
-	for ( i = 0; i < remoteSystemListSize; i++ )
-		if ( remoteSystemList[ i ].playerId == playerID )
-			return remoteSystemList + i;
+	i = remoteSystemLookup.Find( playerID );
+	if ( i < remoteSystemListSize && remoteSystemList[ i ].playerId == playerID )
+		return remoteSystemList + i;
 
 	return 0;
 }
@@ -1215,13 +1225,8 @@ RakPeer::RemoteSystemStruct * RakPeer::AssignPlayerIDToRemoteSystemList( PlayerI
 
 	// If this guy is already connected, return 0. This needs to be checked inside the mutex
 	// because threads may call the connection routine multiple times at the same time
-	for ( i = 0; i < remoteSystemListSize; i++ )
-	{
-		if ( remoteSystemList[ i ].playerId == playerId )
-		{
-			return 0;
-		}
-	}
+	if ( GetRemoteSystemFromPlayerID( playerId ) )
+		return 0;
 
 	for ( i = 0; i < remoteSystemListSize; i++ )
 	{
@@ -1229,6 +1234,7 @@ RakPeer::RemoteSystemStruct * RakPeer::AssignPlayerIDToRemoteSystemList( PlayerI
 		{
 			remoteSystem=remoteSystemList+i;
 			remoteSystem->playerId = playerId; // This one line causes future incoming packets to go through the reliability layer
+			remoteSystemLookup.Insert( playerId, i );
 
 			remoteSystem->pingTime = -1;
 
@@ -1256,7 +1262,7 @@ void RakPeer::PushPortRefused( PlayerID target )
 	// Tell the game we can't connect to this host
 	Packet * p;
 	p = packetPool.GetPointer();
-	p->data = new unsigned char[ 1 ];
+	p->data = ( unsigned char* ) PacketDataPool::Allocate( 1 );
 	p->data[ 0 ] = ID_REMOTE_PORT_REFUSED;
 	p->length = sizeof( char );
 	p->playerId = target; // We don't know this!
@@ -1303,12 +1309,12 @@ void RakPeer::CloseConnectionInternalBuffered( PlayerID target, bool sendDisconn
 	}
 	else
 	{
-		BufferedCommandStruct *bcs;
-		bcs=bufferedCommands.WriteLock();
-		bcs->command=BufferedCommandStruct::BCS_CLOSE_CONNECTION;
-		bcs->playerId=target;
-		bcs->data=0;
-		bufferedCommands.WriteUnlock();
+		BufferedCommandStruct bcs;
+		bcs.command=BufferedCommandStruct::BCS_CLOSE_CONNECTION;
+		bcs.playerId=target;
+		bcs.data=0;
+		bufferedCommands.Push(bcs);
+		WakeUpdateThread();
 	}
 }
 
@@ -1318,24 +1324,29 @@ void RakPeer::CloseConnectionInternalImmediate( PlayerID target)
 	if ( remoteSystemList == 0 || endThreads == true )
 		return;
 
-	for (unsigned int i = 0 ; i < remoteSystemListSize; i++ )
+	RemoteSystemStruct *remoteSystem = GetRemoteSystemFromPlayerID( target );
+	if ( remoteSystem )
 	{
-		if ( remoteSystemList[ i ].playerId == target )
-		{
-			// Reserve this reliability layer for ourselves
-			remoteSystemList[ i ].playerId = UNASSIGNED_PLAYER_ID;
-			//	remoteSystemList[ i ].allowPlayerIdAssigment=false;
+		// Reserve this reliability layer for ourselves
+		remoteSystemLookup.Remove( target );
+		remoteSystem->playerId = UNASSIGNED_PLAYER_ID;
+		//	remoteSystem->allowPlayerIdAssigment=false;
 
-			// Remove any remaining packets.
-			remoteSystemList[ i ].reliabilityLayer.Reset();
-			break;
-		}
+		// Remove any remaining packets.
+		remoteSystem->reliabilityLayer.Reset();
 	}
 
 }
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 bool RakPeer::ValidSendTarget(PlayerID playerId, bool broadcast)
 {
+	if ( broadcast == false )
+	{
+		RemoteSystemStruct *remoteSystem = GetRemoteSystemFromPlayerID( playerId );
+		// Not fully connected players are not valid user-send targets because the reliability layer wasn't reset yet
+		return remoteSystem && remoteSystem->connectMode==RakPeer::RemoteSystemStruct::CONNECTED;
+	}
+
 	unsigned remoteSystemIndex;
 	for ( remoteSystemIndex = 0; remoteSystemIndex < remoteSystemListSize; remoteSystemIndex++ )
 	{
@@ -1352,20 +1363,21 @@ bool RakPeer::ValidSendTarget(PlayerID playerId, bool broadcast)
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 void RakPeer::SendBuffered( const RakNet::BitStream * bitStream, PacketPriority priority, PacketReliability reliability, char orderingChannel, PlayerID playerId, bool broadcast, RemoteSystemStruct::ConnectMode connectionMode )
 {
-	BufferedCommandStruct *bcs;
-	bcs=bufferedCommands.WriteLock();
-
-	bcs->data = new char[bitStream->GetNumberOfBytesUsed()]; // Making a copy doesn't lose efficiency because I tell the reliability layer to use this allocation for its own copy
-	memcpy(bcs->data, bitStream->GetData(), bitStream->GetNumberOfBytesUsed());
-	bcs->numberOfBitsToSend=bitStream->GetNumberOfBitsUsed();
-	bcs->priority=priority;
-	bcs->reliability=reliability;
-	bcs->orderingChannel=orderingChannel;
-	bcs->playerId=playerId;
-	bcs->broadcast=broadcast;
-	bcs->connectionMode=connectionMode;
-	bcs->command=BufferedCommandStruct::BCS_SEND;
-	bufferedCommands.WriteUnlock();
+	BufferedCommandStruct bcs;
+
+	bcs.data = PacketDataPool::Allocate(bitStream->GetNumberOfBytesUsed()); // Making a copy doesn't lose efficiency because I tell the reliability layer to use this allocation for its own copy
+	memcpy(bcs.data, bitStream->GetData(), bitStream->GetNumberOfBytesUsed());
+	bcs.numberOfBitsToSend=bitStream->GetNumberOfBitsUsed();
+	bcs.priority=priority;
+	bcs.reliability=reliability;
+	bcs.orderingChannel=orderingChannel;
+	bcs.playerId=playerId;
+	bcs.broadcast=broadcast;
+	bcs.connectionMode=connectionMode;
+	bcs.command=BufferedCommandStruct::BCS_SEND;
+	bufferedCommands.Push(bcs);
+
+	WakeUpdateThread();
 }
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 bool RakPeer::SendImmediate( char *data, int numberOfBitsToSend, PacketPriority priority, PacketReliability reliability, char orderingChannel, PlayerID playerId, bool broadcast, bool useCallerDataAllocation, unsigned int currentTime )
@@ -1379,7 +1391,13 @@ bool RakPeer::SendImmediate( char *data, int numberOfBitsToSend, PacketPriority
 	sendList=(unsigned *)alloca(sizeof(unsigned)*remoteSystemListSize);
 	sendListSize=0;
 
-	for ( remoteSystemIndex = 0; remoteSystemIndex < remoteSystemListSize; remoteSystemIndex++ )
+	if ( broadcast == false )
+	{
+		RemoteSystemStruct *remoteSystem = GetRemoteSystemFromPlayerID( playerId );
+		if ( remoteSystem )
+			sendList[sendListSize++]=remoteSystem - remoteSystemList;
+	}
+	else for ( remoteSystemIndex = 0; remoteSystemIndex < remoteSystemListSize; remoteSystemIndex++ )
 	{
 		if ( remoteSystemList[ remoteSystemIndex ].playerId != UNASSIGNED_PLAYER_ID &&
 			( ( broadcast == false && remoteSystemList[ remoteSystemIndex ].playerId == playerId ) ||
@@ -1410,15 +1428,12 @@ bool RakPeer::SendImmediate( char *data, int numberOfBitsToSend, PacketPriority
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 void RakPeer::ClearBufferedCommands(void)
 {
-	BufferedCommandStruct *bcs;
-	while ((bcs=bufferedCommands.ReadLock())!=0)
+	BufferedCommandStruct bcs;
+	while (bufferedCommands.Pop(bcs))
 	{
-		if (bcs->data)
-			delete [] bcs->data;
-
-		bufferedCommands.ReadUnlock();
+		if (bcs.data)
+			PacketDataPool::Release( bcs.data );
 	}
-	bufferedCommands.Clear();
 }
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 void RakPeer::ClearRequestedConnectionList(void)
@@ -1559,7 +1574,7 @@ void ProcessNetworkPacket( unsigned int binaryAddress, unsigned short port, cons
 	else if ((unsigned char) data[ 0 ] == ID_PONG && length == sizeof(unsigned char) )
 	{
 		Packet * packet = rakPeer->packetPool.GetPointer();
-		packet->data = new unsigned char[ sizeof( char )+sizeof(unsigned int) ];
+		packet->data = ( unsigned char* ) PacketDataPool::Allocate( sizeof( char )+sizeof(unsigned int) );
 		unsigned int zero=0;
 		packet->data[ 0 ] = ID_PONG;
 		memcpy(packet->data+sizeof( char ), (char*)&zero, sizeof(unsigned int));
@@ -1592,7 +1607,7 @@ void ProcessNetworkPacket( unsigned int binaryAddress, unsigned short port, cons
 			{
 				// Cheater
 				Packet * packet = rakPeer->packetPool.GetPointer();
-				packet->data = new unsigned char[ 1 ];
+				packet->data = ( unsigned char* ) PacketDataPool::Allocate( 1 );
 				packet->data[ 0 ] = ID_MODIFIED_PACKET;
 				packet->length = sizeof( char );
 				packet->bitSize = sizeof( char ) * 8;
@@ -1623,6 +1638,50 @@ void ProcessNetworkPacket( unsigned int binaryAddress, unsigned short port, cons
 	}
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+void RakPeer::WaitForNetworkActivity( void )
+{
+#ifdef _WIN32
+	Sleep( threadSleepTimer );
+#else
+	pollfd fds[ 2 ];
+	fds[ 0 ].fd = connectionSocket;
+	fds[ 0 ].events = POLLIN;
+	fds[ 0 ].revents = 0;
+	fds[ 1 ].fd = wakeupPipe[ 0 ];
+	fds[ 1 ].events = POLLIN;
+	fds[ 1 ].revents = 0;
+
+	// we still need to wake up regularly for resends, pings and timeouts
+	poll( fds, 2, threadSleepTimer );
+
+	if ( fds[ 1 ].revents & POLLIN )
+	{
+		char buffer[ 16 ];
+		while ( read( wakeupPipe[ 0 ], buffer, sizeof( buffer ) ) > 0 )
+			;
+	}
+
+	// anything buffered after this point wakes us again, anything before is handled by the next cycle
+	wakeupPending = false;
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+void RakPeer::WakeUpdateThread( void )
+{
+#ifndef _WIN32
+	if ( wakeupPipe[ 1 ] >= 0 && wakeupPending.exchange( true ) == false )
+	{
+		char c = 0;
+		if ( write( wakeupPipe[ 1 ], &c, 1 ) < 0 )
+		{
+			// the pipe is full, so the update thread wakes up anyway
+		}
+	}
+#endif
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 bool RakPeer::RunUpdateCycle( void )
 {
@@ -1639,7 +1698,7 @@ bool RakPeer::RunUpdateCycle( void )
 	int gotData;
 	unsigned int time;
 	PlayerID playerId;
-	BufferedCommandStruct *bcs;
+	BufferedCommandStruct bcs;
 	bool callerDataAllocationUsed;
 	RakNetStatisticsStruct *rnss;
 
@@ -1693,20 +1752,27 @@ bool RakPeer::RunUpdateCycle( void )
 
 	// Process all the deferred user thread Send and connect calls
 
-	while ( ( bcs = bufferedCommands.ReadLock() ) != 0 ) // Don't immediately check mutex since it's so slow to activate it
+	while ( bufferedCommands.Pop( bcs ) )
 	{
-		if (bcs->command==BufferedCommandStruct::BCS_SEND)
+		if (bcs.command==BufferedCommandStruct::BCS_SEND)
 		{
+			// user sends are validated here, because the remote system list must not be read from other threads
+			if (bcs.connectionMode==RemoteSystemStruct::NO_ACTION && !ValidSendTarget(bcs.playerId, bcs.broadcast))
+			{
+				PacketDataPool::Release( bcs.data );
+				continue;
+			}
+
 			// This will create a new connection if requested
-			if (bcs->connectionMode!=RemoteSystemStruct::NO_ACTION)
+			if (bcs.connectionMode!=RemoteSystemStruct::NO_ACTION)
 			{
-				remoteSystem=AssignPlayerIDToRemoteSystemList(bcs->playerId, bcs->connectionMode);
+				remoteSystem=AssignPlayerIDToRemoteSystemList(bcs.playerId, bcs.connectionMode);
 				if (!remoteSystem)
 				{
 					// Does this system already exist?
-					remoteSystem=GetRemoteSystemFromPlayerID(bcs->playerId);
+					remoteSystem=GetRemoteSystemFromPlayerID(bcs.playerId);
 					if (remoteSystem)
-						remoteSystem->connectMode=bcs->connectionMode;
+						remoteSystem->connectMode=bcs.connectionMode;
 				}
 			}
 
@@ -1714,22 +1780,17 @@ bool RakPeer::RunUpdateCycle( void )
 			if (time==0)
 				time = RakNet::GetTime();
 
-			callerDataAllocationUsed=SendImmediate((char*)bcs->data, bcs->numberOfBitsToSend, bcs->priority, bcs->reliability, bcs->orderingChannel, bcs->playerId, bcs->broadcast, true, time);
+			callerDataAllocationUsed=SendImmediate((char*)bcs.data, bcs.numberOfBitsToSend, bcs.priority, bcs.reliability, bcs.orderingChannel, bcs.playerId, bcs.broadcast, true, time);
 			if ( callerDataAllocationUsed==false )
-				delete [] bcs->data;
+				PacketDataPool::Release( bcs.data );
 		}
 		else
 		{
 #ifdef _DEBUG
-			assert(bcs->command==BufferedCommandStruct::BCS_CLOSE_CONNECTION);
+			assert(bcs.command==BufferedCommandStruct::BCS_CLOSE_CONNECTION);
 #endif
-			CloseConnectionInternalImmediate(bcs->playerId);
+			CloseConnectionInternalImmediate(bcs.playerId);
 		}
-
-#ifdef _DEBUG
-		bcs->data=0;
-#endif
-		bufferedCommands.ReadUnlock();
 	}
 
 	// Process connection attempts
@@ -1759,7 +1820,7 @@ bool RakPeer::RunUpdateCycle( void )
 				{
 					// Tell user of connection attempt failed
 					packet = packetPool.GetPointer();
-					packet->data = new unsigned char [ sizeof( char ) ];
+					packet->data = ( unsigned char* ) PacketDataPool::Allocate( sizeof( char ) );
 					packet->data[ 0 ] = ID_CONNECTION_ATTEMPT_FAILED; // Attempted a connection and couldn't
 					packet->length = sizeof( char );
 					packet->bitSize = ( sizeof( char ) * 8);
@@ -1845,7 +1906,7 @@ bool RakPeer::RunUpdateCycle( void )
 					// Inform the user of the connection failure.
 					packet = packetPool.GetPointer();
 
-					packet->data = new unsigned char [ sizeof( char ) ];
+					packet->data = ( unsigned char* ) PacketDataPool::Allocate( sizeof( char ) );
 					if (remoteSystem->connectMode==RemoteSystemStruct::REQUESTED_CONNECTION)
 						packet->data[ 0 ] = ID_CONNECTION_ATTEMPT_FAILED; // Attempted a connection and couldn't
 					else
@@ -1895,7 +1956,7 @@ bool RakPeer::RunUpdateCycle( void )
 					if ( (unsigned char)(data)[0] == ID_CONNECTION_REQUEST )
 					{
 						ParseConnectionRequestPacket(remoteSystem, playerId, data, byteSize);
-						delete [] data;
+						PacketDataPool::Release( data );
 					}
 					else if ( ((unsigned char) data[0] == ID_PONG && byteSize >= sizeof(unsigned char)+sizeof(unsigned int)) ||
 						((unsigned char) data[0] == ID_ADVERTISE_SYSTEM && byteSize<=MAX_OFFLINE_DATA_LENGTH))
@@ -1935,7 +1996,7 @@ bool RakPeer::RunUpdateCycle( void )
 						}
 						// else ID_UNCONNECTED_PING_OPEN_CONNECTIONS and we are full so don't send anything
 
-						delete [] data;
+						PacketDataPool::Release( data );
 
 						// Disconnect them after replying to their offline ping
 						if (remoteSystem->connectMode!=RemoteSystemStruct::CONNECTED)
@@ -1947,7 +2008,7 @@ bool RakPeer::RunUpdateCycle( void )
 #ifdef _DO_PRINTF
 						printf("Temporarily banning %i:%i for sending nonsense data\n", playerId.binaryAddress, playerId.port);
 #endif
-						delete [] data;
+						PacketDataPool::Release( data );
 					}
 				}
 				else
@@ -1958,7 +2019,7 @@ bool RakPeer::RunUpdateCycle( void )
 					{
 						if (remoteSystem->weInitiatedTheConnection==false)
 							ParseConnectionRequestPacket(remoteSystem, playerId, data, byteSize);
-						delete [] data;
+						PacketDataPool::Release( data );
 					}
 					else if ( (unsigned char) data[ 0 ] == ID_NEW_INCOMING_CONNECTION && byteSize == sizeof(unsigned char)+sizeof(unsigned int)+sizeof(unsigned short) )
 					{
@@ -2003,7 +2064,7 @@ bool RakPeer::RunUpdateCycle( void )
 							incomingQueueMutex.Unlock();
 						}
 						else
-							delete [] data;
+							PacketDataPool::Release( data );
 					}
 					else if ( (unsigned char) data[ 0 ] == ID_CONNECTED_PONG && byteSize == sizeof(unsigned char)+sizeof(unsigned int)*2 )
 					{
@@ -2034,7 +2095,7 @@ bool RakPeer::RunUpdateCycle( void )
 							remoteSystem->reliabilityLayer.SetLostPacketResendDelay( ping * 2 );
 						}
 
-						delete [] data;
+						PacketDataPool::Release( data );
 					}
 					else if ( (unsigned char)data[0] == ID_CONNECTED_PING && byteSize == sizeof(unsigned char)+sizeof(unsigned int) )
 					{
@@ -2053,7 +2114,7 @@ bool RakPeer::RunUpdateCycle( void )
 							SendImmediate( (char*)outBitStream.GetData(), outBitStream.GetNumberOfBitsUsed(), SYSTEM_PRIORITY, UNRELIABLE, 0, playerId, false, false, time );
 						}
 
-						delete [] data;
+						PacketDataPool::Release( data );
 					}
 					else if ( (unsigned char) data[ 0 ] == ID_DISCONNECTION_NOTIFICATION )
 					{
@@ -2082,7 +2143,7 @@ bool RakPeer::RunUpdateCycle( void )
 					else if ( (unsigned char)(data)[0] == ID_KEEPALIVE && byteSize == sizeof(unsigned char) )
 					{
 						// Do nothing
-						delete [] data;
+						PacketDataPool::Release( data );
 					}
 					else if ( (unsigned char)(data)[0] == ID_CONNECTION_REQUEST_ACCEPTED && byteSize == sizeof(unsigned char)+sizeof(unsigned short)+sizeof(unsigned int)+sizeof(unsigned short)+sizeof(PlayerIndex) )
 					{
@@ -2162,7 +2223,7 @@ bool RakPeer::RunUpdateCycle( void )
 #ifdef _DO_PRINTF
 							printf( "Error: Got a connection accept when we didn't request the connection.\n" );
 #endif
-							delete [] data;
+							PacketDataPool::Release( data );
 						}
 					}
 					else
@@ -2209,13 +2270,12 @@ void* UpdateNetworkLoop( void* arguments )
 
 	while ( rakPeer->endThreads == false )
 	{
+		// everything the update cycle sends goes out in one batch
+		SocketLayer::Instance()->BeginSendBatch();
 		rakPeer->RunUpdateCycle();
-#ifdef _WIN32
-		Sleep( rakPeer->threadSleepTimer );
-#else
-		usleep( rakPeer->threadSleepTimer * 1000 );
-#endif
+		SocketLayer::Instance()->EndSendBatch();
 
+		rakPeer->WaitForNetworkActivity();
 	}
 
 	rakPeer->isMainLoopThreadActive = false;
@@ -34,9 +34,12 @@
 #include "ReliabilityLayer.h"
 #include "BitStream.h"
 #include "SingleProducerConsumer.h"
+#include "MultiProducerSingleConsumer.h"
 #include "PacketPool.h"
+#include "PlayerIDTable.h"
 
 #include <functional>
+#include <atomic>
 
 #ifdef _WIN32
 void __stdcall ProcessNetworkPacket( unsigned int binaryAddress, unsigned short port, const char *data, int length, RakPeer *rakPeer );
@@ -153,7 +156,8 @@ public:
 	* @param playerId Who to send this packet to, or in the case of broadcasting who not to send it to.  Use UNASSIGNED_PLAYER_ID to specify none
 	* @param broadcast True to send this packet to all connected systems. If true, then playerId specifies who not to send the packet to.
 	* @return
-	* False if we are not connected to the specified recipient.  True otherwise
+	* False if the packet could not be queued. The recipient is checked by the update thread, which drops
+	* packets to systems we are not connected to.
 	*/
 	bool Send( const char *data, const long length, PacketPriority priority, PacketReliability reliability, char orderingChannel, PlayerID playerId, bool broadcast );
 	/**
@@ -168,7 +172,8 @@ public:
 	* @param playerId Who to send this packet to, or in the case of broadcasting who not to send it to.  Use UNASSIGNED_PLAYER_ID to specify none
 	* @param broadcast True to send this packet to all connected systems. If true, then playerId specifies who not to send the packet to.
 	* @return
-	* False if we are not connected to the specified recipient.  True otherwise
+	* False if the packet could not be queued. The recipient is checked by the update thread, which drops
+	* packets to systems we are not connected to.
 	*/
 	bool Send( const RakNet::BitStream * bitStream, PacketPriority priority, PacketReliability reliability, char orderingChannel, PlayerID playerId, bool broadcast );
 
@@ -495,6 +500,11 @@ protected:
 	* reliability layer
 	*/
 	RemoteSystemStruct* remoteSystemList;
+	/**
+	* Maps the playerId of every assigned entry of remoteSystemList to its index,
+	* so we don't have to search the list for every datagram
+	*/
+	PlayerIDTable remoteSystemLookup;
 
 	/**
 	* RunUpdateCycle is not thread safe but we don't need to mutex calls. Just skip calls if it is running already
@@ -544,8 +554,9 @@ protected:
 		enum {BCS_SEND, BCS_CLOSE_CONNECTION, BCS_DO_NOTHING} command;
 	};
 
-	// Single producer single consumer queue using a linked list
-	BasicDataStructures::SingleProducerConsumer<BufferedCommandStruct> bufferedCommands;
+	// Sends and disconnects of the user threads, processed by the update thread.
+	// Any number of threads may push at the same time without locking.
+	BasicDataStructures::MultiProducerSingleConsumer<BufferedCommandStruct> bufferedCommands;
 
 	bool AllowIncomingConnections(void) const;
 
@@ -560,11 +571,29 @@ protected:
 	void ClearBufferedCommands(void);
 	void ClearRequestedConnectionList(void);
 
+	/**
+	* Waits until data arrives on the socket, WakeUpdateThread is called, or threadSleepTimer ms passed
+	*/
+	void WaitForNetworkActivity(void);
+	/**
+	* Makes the update thread start its next cycle right away, e.g. because there are buffered commands
+	*/
+	void WakeUpdateThread(void);
+
 	int MTUSize;
 	int threadSleepTimer;
 
 	SOCKET connectionSocket;
 
+#ifndef _WIN32
+	/**
+	* Writing to this pipe ends WaitForNetworkActivity early.
+	* wakeupPending is set while a byte is in the pipe, so we write at most once per update cycle.
+	*/
+	int wakeupPipe[ 2 ];
+	std::atomic<bool> wakeupPending;
+#endif
+
 	/**
 	* How long it has been since things were updated by a call to receive
 	* Update thread uses this to determine how long to sleep for
@@ -33,6 +33,7 @@
 #include <assert.h>
 #include "GetTime.h"
 #include "SocketLayer.h"
+#include "PacketDataPool.h"
 
 // alloca
 #ifdef _WIN32
@@ -126,7 +127,7 @@ void ReliabilityLayer::FreeThreadSafeMemory( void )
 
 	for ( unsigned i = 0; i < splitPacketList.size(); i++ )
 	{
-		delete [] splitPacketList[ i ]->data;
+		PacketDataPool::Release( splitPacketList[ i ]->data );
 		internalPacketPool.ReleasePointer( splitPacketList[ i ] );
 	}
 
@@ -135,7 +136,7 @@ void ReliabilityLayer::FreeThreadSafeMemory( void )
 	while ( outputQueue.size() > 0 )
 	{
 		internalPacket = outputQueue.pop();
-		delete [] internalPacket->data;
+		PacketDataPool::Release( internalPacket->data );
 		internalPacketPool.ReleasePointer( internalPacket );
 	}
 
@@ -153,7 +154,7 @@ void ReliabilityLayer::FreeThreadSafeMemory( void )
 				while ( theList->size() )
 				{
 					internalPacket = orderingList[ i ]->pop();
-					delete [] internalPacket->data;
+					PacketDataPool::Release( internalPacket->data );
 					internalPacketPool.ReleasePointer( internalPacket );
 				}
 
@@ -176,7 +177,7 @@ void ReliabilityLayer::FreeThreadSafeMemory( void )
 
 		if ( internalPacket )
 		{
-			delete [] internalPacket->data;
+			PacketDataPool::Release( internalPacket->data );
 			internalPacketPool.ReleasePointer( internalPacket );
 		}
 	}
@@ -189,7 +190,7 @@ void ReliabilityLayer::FreeThreadSafeMemory( void )
 		j = 0;
 		for ( ; j < sendPacketSet[ i ].size(); j++ )
 		{
-		delete [] ( sendPacketSet[ i ] ) [ j ]->data;
+		PacketDataPool::Release( ( sendPacketSet[ i ] ) [ j ]->data );
 		internalPacketPool.ReleasePointer( ( sendPacketSet[ i ] ) [ j ] );
 		}
 
@@ -306,7 +307,7 @@ bool ReliabilityLayer::HandleSocketReceiveFromConnectedPlayer( const char *buffe
 				statistics.duplicateMessagesReceived++;
 
 				// Duplicate packet
-				delete [] internalPacket->data;
+				PacketDataPool::Release( internalPacket->data );
 				internalPacketPool.ReleasePointer( internalPacket );
 				goto CONTINUE_SOCKET_DATA_PARSE_LOOP;
 			}
@@ -327,7 +328,7 @@ bool ReliabilityLayer::HandleSocketReceiveFromConnectedPlayer( const char *buffe
 					statistics.duplicateMessagesReceived++;
 
 					// Duplicate packet
-					delete [] internalPacket->data;
+					PacketDataPool::Release( internalPacket->data );
 					internalPacketPool.ReleasePointer( internalPacket );
 					goto CONTINUE_SOCKET_DATA_PARSE_LOOP;
 				}
@@ -379,7 +380,7 @@ bool ReliabilityLayer::HandleSocketReceiveFromConnectedPlayer( const char *buffe
 					printf( "Got invalid packet\n" );
 #endif
 
-					delete [] internalPacket->data;
+					PacketDataPool::Release( internalPacket->data );
 					internalPacketPool.ReleasePointer( internalPacket );
 					goto CONTINUE_SOCKET_DATA_PARSE_LOOP;
 				}
@@ -413,7 +414,7 @@ bool ReliabilityLayer::HandleSocketReceiveFromConnectedPlayer( const char *buffe
 #ifdef _DEBUG
 								printf( "Error: Split packet duplicate insertion (1)\n" );
 #endif
-								delete [] internalPacket->data;
+								PacketDataPool::Release( internalPacket->data );
 								internalPacketPool.ReleasePointer( internalPacket );
 								goto CONTINUE_SOCKET_DATA_PARSE_LOOP;
 							}
@@ -469,7 +470,7 @@ bool ReliabilityLayer::HandleSocketReceiveFromConnectedPlayer( const char *buffe
 					statistics.sequencedMessagesOutOfOrder++;
 
 					// Older sequenced packet. Discard it
-					delete [] internalPacket->data;
+					PacketDataPool::Release( internalPacket->data );
 					internalPacketPool.ReleasePointer( internalPacket );
 				}
 
@@ -504,7 +505,7 @@ bool ReliabilityLayer::HandleSocketReceiveFromConnectedPlayer( const char *buffe
 #ifdef _DEBUG
 						printf( "Error: Split packet duplicate insertion (2)\n" );
 #endif
-						delete [] internalPacket->data;
+						PacketDataPool::Release( internalPacket->data );
 						internalPacketPool.ReleasePointer( internalPacket );
 						goto CONTINUE_SOCKET_DATA_PARSE_LOOP;
 
@@ -550,7 +551,7 @@ bool ReliabilityLayer::HandleSocketReceiveFromConnectedPlayer( const char *buffe
 					printf("Got invalid ordering channel %i from packet %i\n", internalPacket->orderingChannel, internalPacket->packetNumber);
 #endif
 					// Invalid packet
-					delete [] internalPacket->data;
+					PacketDataPool::Release( internalPacket->data );
 					internalPacketPool.ReleasePointer( internalPacket );
 					goto CONTINUE_SOCKET_DATA_PARSE_LOOP;
 				}
@@ -746,7 +747,7 @@ bool ReliabilityLayer::Send( char *data, int numberOfBitsToSend, PacketPriority
 
 	if ( makeDataCopy )
 	{
-		internalPacket->data = new char [ numberOfBytesToSend ];
+		internalPacket->data = PacketDataPool::Allocate( numberOfBytesToSend );
 		memcpy( internalPacket->data, data, numberOfBytesToSend );
 //		printf("Allocated %i\n", internalPacket->data);
 	}
@@ -1170,7 +1171,7 @@ void ReliabilityLayer::GenerateFrame( RakNet::BitStream *output, int MTUSize, bo
 			else
 			{
 				// Unreliable packets are deleted
-				delete [] internalPacket->data;
+				PacketDataPool::Release( internalPacket->data );
 				internalPacketPool.ReleasePointer( internalPacket );
 			}
 		}
@@ -1302,7 +1303,7 @@ void ReliabilityLayer::RemovePacketFromResendQueueAndDeleteOlderReliableSequence
 
 			// Delete the packet
 			//printf("Deleting %i\n", internalPacket->data);
-			delete [] internalPacket->data;
+			PacketDataPool::Release( internalPacket->data );
 			internalPacketPool.ReleasePointer( internalPacket );
 
 			// If the deleted packet was reliable sequenced, also delete all older reliable sequenced resends on the same ordering channel.
@@ -1318,7 +1319,7 @@ void ReliabilityLayer::RemovePacketFromResendQueueAndDeleteOlderReliableSequence
 					if ( internalPacket && internalPacket->reliability == RELIABLE_SEQUENCED && internalPacket->orderingChannel == orderingChannel && IsOlderOrderedPacket( internalPacket->orderingIndex, orderingIndex ) )
 					{
 						// Delete the packet
-						delete [] internalPacket->data;
+						PacketDataPool::Release( internalPacket->data );
 						internalPacketPool.ReleasePointer( internalPacket );
 						resendQueue[ j ] = 0; // Generate a hole
 					}
@@ -1701,7 +1702,7 @@ InternalPacket* ReliabilityLayer::CreateInternalPacketFromBitStream( RakNet::Bit
 	}
 
 	// Allocate memory to hold our data
-	internalPacket->data = new char [ BITS_TO_BYTES( internalPacket->dataBitLength ) ];
+	internalPacket->data = PacketDataPool::Allocate( BITS_TO_BYTES( internalPacket->dataBitLength ) );
 	//printf("Allocating %i\n",  internalPacket->data);
 
 	// Set the last byte to 0 so if ReadBits does not read a multiple of 8 the last bits are 0'ed out
@@ -1718,7 +1719,7 @@ InternalPacket* ReliabilityLayer::CreateInternalPacketFromBitStream( RakNet::Bit
 
 	if ( bitStreamSucceeded == false )
 	{
-		delete [] internalPacket->data;
+		PacketDataPool::Release( internalPacket->data );
 		internalPacketPool.ReleasePointer( internalPacket );
 		return 0;
 	}
@@ -1813,7 +1814,7 @@ void ReliabilityLayer::SplitPacket( InternalPacket *internalPacket, int MTUSize
 			bytesToSend = maximumSendBlock;
 
 		// Copy over our chunk of data
-		internalPacketArray[ splitPacketIndex ]->data = new char[ bytesToSend ];
+		internalPacketArray[ splitPacketIndex ]->data = PacketDataPool::Allocate( bytesToSend );
 
 		memcpy( internalPacketArray[ splitPacketIndex ]->data, internalPacket->data + byteOffset, bytesToSend );
 
@@ -1855,7 +1856,7 @@ void ReliabilityLayer::SplitPacket( InternalPacket *internalPacket, int MTUSize
 	}
 
 	// Delete the original
-	delete [] internalPacket->data;
+	PacketDataPool::Release( internalPacket->data );
 	internalPacketPool.ReleasePointer( internalPacket );
 }
 
@@ -1936,7 +1937,7 @@ InternalPacket * ReliabilityLayer::BuildPacketFromSplitPacketList( unsigned int
 				// All the parts are here
 				InternalPacket * internalPacket = CreateInternalPacketCopy( splitPacketList[ i ], 0, 0, time );
 				allocatedLength=BITS_TO_BYTES( bitlength );
-				internalPacket->data = new char[ allocatedLength ];
+				internalPacket->data = PacketDataPool::Allocate( allocatedLength );
 #ifdef _DEBUG
 				internalPacket->splitPacketCount = splitPacketList[ i ]->splitPacketCount;
 #endif
@@ -1962,7 +1963,7 @@ InternalPacket * ReliabilityLayer::BuildPacketFromSplitPacketList( unsigned int
 #ifdef _DEBUG
 							assert(0);
 #endif
-							delete[] internalPacket->data;
+							PacketDataPool::Release( internalPacket->data );
 							internalPacketPool.ReleasePointer(internalPacket);
 							return 0;
 						}
@@ -1978,7 +1979,7 @@ InternalPacket * ReliabilityLayer::BuildPacketFromSplitPacketList( unsigned int
 #ifdef _DEBUG
 							assert(0);
 #endif
-							delete[] internalPacket->data;
+							PacketDataPool::Release( internalPacket->data );
 							internalPacketPool.ReleasePointer(internalPacket);
 							return 0;
 						}
@@ -1990,7 +1991,7 @@ InternalPacket * ReliabilityLayer::BuildPacketFromSplitPacketList( unsigned int
 					InternalPacket *temp;
 
 					temp = splitPacketList[ indexList[ j ] ];
-					delete [] temp->data;
+					PacketDataPool::Release( temp->data );
 					internalPacketPool.ReleasePointer( temp );
 					splitPacketList[ indexList[ j ] ] = 0;
 
@@ -2071,7 +2072,7 @@ void ReliabilityLayer::DeleteOldUnreliableSplitPackets( unsigned int time )
 				temp = splitPacketList[ i ];
 				splitPacketList[ i ] = splitPacketList[ splitPacketList.size() - 1 ];
 				splitPacketList.del(); // Removes the last element
-				delete [] temp->data;
+				PacketDataPool::Release( temp->data );
 				internalPacketPool.ReleasePointer( temp );
 			}
 
@@ -2096,7 +2097,7 @@ InternalPacket * ReliabilityLayer::CreateInternalPacketCopy( InternalPacket *ori
 
 	if ( dataByteLength > 0 )
 	{
-		copy->data = new char[ dataByteLength ];
+		copy->data = PacketDataPool::Allocate( dataByteLength );
 		memcpy( copy->data, original->data + dataByteOffset, dataByteLength );
 	}
 	else
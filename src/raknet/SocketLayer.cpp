@@ -39,6 +39,11 @@ typedef int socklen_t;
 #else
 #include <cstring> // memcpy
 #include <fcntl.h>
+#include <cerrno>
+#endif
+
+#ifdef __linux__
+#include <memory>
 #endif
 
 int SocketLayer::socketLayerInstanceCount = 0;
@@ -202,6 +207,134 @@ int SocketLayer::Write( SOCKET writeSocket, const char* data, int length )
 	return send( writeSocket, data, length, 0 );
 }
 
+#ifdef __linux__
+namespace
+{
+	// how many datagrams are read with one recvmmsg call
+	const unsigned RECEIVE_BATCH_SIZE = 32;
+	// limits for the datagrams collected between BeginSendBatch and EndSendBatch
+	const unsigned SEND_BATCH_SIZE = 64;
+	const unsigned SEND_BATCH_BYTES = 64 * 1024;
+
+	struct ReceiveBatch
+	{
+		mmsghdr messages[ RECEIVE_BATCH_SIZE ];
+		iovec buffers[ RECEIVE_BATCH_SIZE ];
+		sockaddr_in addresses[ RECEIVE_BATCH_SIZE ];
+		char data[ RECEIVE_BATCH_SIZE ][ MAXIMUM_MTU_SIZE ];
+	};
+
+	struct SendBatch
+	{
+		bool active = false;
+		SOCKET socket = INVALID_SOCKET;
+		unsigned count = 0;
+		unsigned bytes = 0;
+		mmsghdr messages[ SEND_BATCH_SIZE ];
+		iovec buffers[ SEND_BATCH_SIZE ];
+		sockaddr_in addresses[ SEND_BATCH_SIZE ];
+		char data[ SEND_BATCH_BYTES ];
+	};
+
+	// the buffers are too large for the stack, so every thread that does network io gets its own set
+	thread_local std::unique_ptr<ReceiveBatch> receiveBatch;
+	thread_local std::unique_ptr<SendBatch> sendBatch;
+
+	void FlushSendBatch( SendBatch& batch )
+	{
+		unsigned sent = 0;
+		while ( sent < batch.count )
+		{
+			int result = sendmmsg( batch.socket, batch.messages + sent, batch.count - sent, 0 );
+			if ( result > 0 )
+				sent += result;
+			else if ( result < 0 && errno == EINTR )
+				continue;
+			else
+				// like a failing sendto, this drops the datagram. The reliability layer resends if needed.
+				++sent;
+		}
+
+		batch.count = 0;
+		batch.bytes = 0;
+	}
+}
+
+void SocketLayer::BeginSendBatch()
+{
+	if ( !sendBatch )
+		sendBatch.reset( new SendBatch );
+	sendBatch->active = true;
+}
+
+void SocketLayer::EndSendBatch()
+{
+	if ( !sendBatch )
+		return;
+	FlushSendBatch( *sendBatch );
+	sendBatch->active = false;
+}
+
+int SocketLayer::RecvFrom( SOCKET s, RakPeer *rakPeer, int *errorCode )
+{
+	if ( s == INVALID_SOCKET )
+	{
+		*errorCode = SOCKET_ERROR;
+		return SOCKET_ERROR;
+	}
+
+	if ( !receiveBatch )
+	{
+		receiveBatch.reset( new ReceiveBatch );
+		for ( unsigned i = 0; i < RECEIVE_BATCH_SIZE; i++ )
+		{
+			receiveBatch->buffers[ i ].iov_base = receiveBatch->data[ i ];
+			receiveBatch->buffers[ i ].iov_len = MAXIMUM_MTU_SIZE;
+		}
+	}
+
+	ReceiveBatch& batch = *receiveBatch;
+	for ( unsigned i = 0; i < RECEIVE_BATCH_SIZE; i++ )
+	{
+		msghdr& header = batch.messages[ i ].msg_hdr;
+		std::memset( &header, 0, sizeof( header ) );
+		header.msg_name = &batch.addresses[ i ];
+		header.msg_namelen = sizeof( sockaddr_in );
+		header.msg_iov = &batch.buffers[ i ];
+		header.msg_iovlen = 1;
+	}
+
+	int count = recvmmsg( s, batch.messages, RECEIVE_BATCH_SIZE, MSG_DONTWAIT, nullptr );
+	if ( count <= 0 )
+	{
+		*errorCode = 0;
+		return 0; // no data
+	}
+
+	for ( int i = 0; i < count; i++ )
+	{
+		int len = batch.messages[ i ].msg_len;
+		// see the Zone Alarm comment in the generic version
+		if ( len == 0 )
+			continue;
+
+		const sockaddr_in& sa = batch.addresses[ i ];
+		ProcessNetworkPacket( sa.sin_addr.s_addr, ntohs( sa.sin_port ), batch.data[ i ], len, rakPeer );
+	}
+
+	return 1;
+}
+
+#else
+
+void SocketLayer::BeginSendBatch()
+{
+}
+
+void SocketLayer::EndSendBatch()
+{
+}
+
 int SocketLayer::RecvFrom( SOCKET s, RakPeer *rakPeer, int *errorCode )
 {
 	int len;
@@ -284,6 +417,8 @@ int SocketLayer::RecvFrom( SOCKET s, RakPeer *rakPeer, int *errorCode )
 	return 0; // no data
 }
 
+#endif
+
 int SocketLayer::SendTo( SOCKET s, const char *data, int length, unsigned int binaryAddress, unsigned short port )
 {
 	if ( s == INVALID_SOCKET )
@@ -291,6 +426,43 @@ int SocketLayer::SendTo( SOCKET s, const char *data, int length, unsigned int bi
 		return -1;
 	}
 
+#ifdef __linux__
+	if ( sendBatch && sendBatch->active && length > 0 && (unsigned)length <= SEND_BATCH_BYTES )
+	{
+		SendBatch& batch = *sendBatch;
+		if ( batch.socket != s || batch.count == SEND_BATCH_SIZE || batch.bytes + length > SEND_BATCH_BYTES )
+			FlushSendBatch( batch );
+		batch.socket = s;
+
+		unsigned i = batch.count++;
+		char *target = batch.data + batch.bytes;
+		memcpy( target, data, length );
+		batch.bytes += length;
+
+		sockaddr_in& sa = batch.addresses[ i ];
+		std::memset( &sa, 0, sizeof( sa ) );
+		sa.sin_port = htons( port );
+		sa.sin_addr.s_addr = binaryAddress;
+		sa.sin_family = AF_INET;
+
+		batch.buffers[ i ].iov_base = target;
+		batch.buffers[ i ].iov_len = length;
+
+		msghdr& header = batch.messages[ i ].msg_hdr;
+		std::memset( &header, 0, sizeof( header ) );
+		header.msg_name = &sa;
+		header.msg_namelen = sizeof( sockaddr_in );
+		header.msg_iov = &batch.buffers[ i ];
+		header.msg_iovlen = 1;
+		return 0;
+	}
+	else if ( sendBatch && sendBatch->active )
+	{
+		// keep the order of the datagrams
+		FlushSendBatch( *sendBatch );
+	}
+#endif
+
 	int len;
 	sockaddr_in sa;
 	sa.sin_port = htons( port );
@@ -114,6 +114,7 @@ public:
 	int Write( SOCKET writeSocket, const char* data, int length );
 	/**
 	 * Read data from a socket
+	 * On Linux, this reads a batch of datagrams with one recvmmsg call.
 	 * @param s the socket
 	 * @param rakPeer
 	 * @param errorCode An error code if an error occured
@@ -147,6 +148,16 @@ public:
 	 */
 	int SendTo( SOCKET s, const char *data, int length, unsigned int binaryAddress, unsigned short port );
 
+	/**
+	 * Collect the datagrams sent with SendTo from the calling thread until EndSendBatch is called.
+	 * On Linux, they are then sent with a single sendmmsg call. On other platforms, SendTo sends immediately.
+	 */
+	void BeginSendBatch();
+	/**
+	 * Send all datagrams collected since BeginSendBatch, and send immediately again
+	 */
+	void EndSendBatch();
+
 	/// Retrieve all local IP address in a printable format
 	/// @param ipList An array of ip address in dot format.
 	void GetMyIP(char ipList[10][16]);
@@ -25,8 +25,29 @@ struct ReplaySavePoint;
 constexpr const char legacyHeader[4] = { 'B', 'V', '2', 'R' };	//!< header of replay file
 /// \todo add warning when trying to read old files
 
-constexpr const unsigned char REPLAY_FILE_VERSION_MAJOR = 2;
+constexpr const unsigned char REPLAY_FILE_VERSION_MAJOR = 3;
 constexpr const unsigned char REPLAY_FILE_VERSION_MINOR = 0;
 
+/// Replay file format 3.x
+/// Binary file, all integers little-endian, strings are stored as uint32 length + characters.
+///  - header: magic "BVR3", uint8 major, uint8 minor, uint16 reserved, uint32 game speed,
+///    uint32 date low, uint32 date high, uint32 color left, uint32 color right,
+///    string name left, string name right, string rules
+///  - a sequence of chunks, each one a uint32 tag, a uint32 payload size and the payload:
+///     - INPT: one byte of input per step, continuing where the previous INPT chunk stopped
+///     - SAVE: a ReplaySavePoint, serialized with GenericIO
+///     - INDX: written once the match is over. uint32 length in steps, uint32 score left,
+///       uint32 score right, uint32 input chunk count, (uint32 first step, uint32 payload offset,
+///       uint32 size) per input chunk, uint32 savepoint count, (uint32 step, uint32 payload offset,
+///       uint32 size) per savepoint
+///  - trailer: uint32 offset of the INDX chunk, magic "BVRE"
+/// Recording only ever appends to the file. A file without trailer (e.g. a recording that was
+/// interrupted) can still be loaded by scanning the chunks.
+constexpr const char REPLAY_V3_MAGIC[4] = { 'B', 'V', 'R', '3' };
+constexpr const char REPLAY_V3_TRAILER_MAGIC[4] = { 'B', 'V', 'R', 'E' };
+constexpr const char REPLAY_CHUNK_INPUT[4] = { 'I', 'N', 'P', 'T' };
+constexpr const char REPLAY_CHUNK_SAVEPOINT[4] = { 'S', 'A', 'V', 'E' };
+constexpr const char REPLAY_CHUNK_INDEX[4] = { 'I', 'N', 'D', 'X' };
+
 // 10 secs for normal gamespeed
 const int REPLAY_SAVEPOINT_PERIOD = 750;
@@ -23,9 +23,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 /* includes */
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 #include <vector>
 #include <ctime>
 #include <memory>
+#include <stdexcept>
 #include <iostream> // debugging
 
 #include "tinyxml2.h"
@@ -38,11 +41,26 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "base64.h"
 #include "ReplayDefs.h"
 #include "Color.h"
+#include "MappedFile.h"
+#include "ReplayRecorder.h"
 
 /* implementation */
 IReplayLoader* IReplayLoader::createReplayLoader(const std::string& filename)
 {
-	std::unique_ptr<IReplayLoader> loader(createReplayLoader(0));
+	// 3.x replays start with a magic number, older ones are xml documents
+	int major = 2;
+	{
+		FileRead file(filename);
+		char magic[sizeof(REPLAY_V3_MAGIC)];
+		if(file.length() >= sizeof(magic))
+		{
+			file.readRawBytes(magic, sizeof(magic));
+			if(std::memcmp(magic, REPLAY_V3_MAGIC, sizeof(magic)) == 0)
+				major = 3;
+		}
+	}
+
+	std::unique_ptr<IReplayLoader> loader(createReplayLoader(major));
 	loader->initLoading(filename);
 
 	return loader.release();
@@ -321,7 +339,326 @@ class ReplayLoader_V2X: public IReplayLoader
 };
 
 
+/***************************************************************************************************
+			              R E P L A Y   L O A D E R    V 3.x
+***************************************************************************************************/
+
+/*! \class ReplayLoader_V3X
+	\brief Replay Loader V 3.x
+	\details Replay Loader for the binary 3.0 replays. The file is memory mapped if possible,
+			only the header and the index are read when loading. Input and savepoints are
+			read from the file when they are requested.
+	\sa ReplayDefs.h for a description of the format
+*/
+class ReplayLoader_V3X: public IReplayLoader
+{
+	public:
+		ReplayLoader_V3X() = default;
+
+		~ReplayLoader_V3X() override = default;
+
+		int getVersionMajor() const override { return 3; };
+		int getVersionMinor() const override { return 0; };
+
+		std::string getPlayerName(PlayerSide player) const override
+		{
+			return mPlayerNames[player];
+		}
+
+		Color getBlobColor(PlayerSide player) const override
+		{
+			return mColors[player];
+		}
+
+		int getFinalScore(PlayerSide player) const override
+		{
+			return mFinalScores[player];
+		}
+
+		int getSpeed() const override
+		{
+			return mGameSpeed;
+		};
+
+		int getDuration() const override
+		{
+			return mGameSpeed > 0 ? mGameLength / mGameSpeed : 0;
+		};
+
+		int getLength()  const override
+		{
+			return mGameLength;
+		};
+
+		std::time_t getDate() const override
+		{
+			return mGameDate;
+		};
+
+		std::string getRules() const override
+		{
+			return mRules;
+		}
+
+		void getInputAt(int step, InputSource* left, InputSource* right) override
+		{
+			if(step < 0 || step >= mGameLength)
+				throw std::out_of_range("Replay step out of range");
+
+			// find the last chunk that starts at or before step
+			auto chunk = std::upper_bound(mInputChunks.begin(), mInputChunks.end(), (uint32_t)step,
+										  [](uint32_t s, const IndexEntry& entry) { return s < entry.step; });
+			// the index is validated when loading, so this only fails if that check is broken
+			if(chunk == mInputChunks.begin())
+				throw std::runtime_error("No input for replay step");
+			--chunk;
+			if(step - chunk->step >= chunk->size)
+				throw std::runtime_error("No input for replay step");
+
+			char packet = mFile->data()[chunk->offset + (step - chunk->step)];
+
+			left->setInput(PlayerInput((bool)(packet & 32), (bool)(packet & 16), (bool)(packet & 8)));
+			right->setInput(PlayerInput((bool)(packet & 4), (bool)(packet & 2), (bool)(packet & 1)));
+		}
+
+		bool isSavePoint(int position, int& save_position) const override
+		{
+			int foundPos;
+			save_position = getSavePoint(position, foundPos);
+			return save_position != -1 && foundPos == position;
+		}
+
+		int getSavePoint(int targetPosition, int& savepoint) const override
+		{
+			auto next = std::upper_bound(mSavePoints.begin(), mSavePoints.end(), (uint32_t)targetPosition,
+										 [](uint32_t s, const IndexEntry& entry) { return s < entry.step; });
+			if(next == mSavePoints.begin())
+				return -1;
+
+			--next;
+			savepoint = next->step;
+			return next - mSavePoints.begin();
+		}
+
+		void readSavePoint(int index, ReplaySavePoint& state) const override
+		{
+			const auto& entry = mSavePoints.at(index);
+			// the bit stream does not modify the data as long as we only read
+			RakNet::BitStream stream((unsigned char*)mFile->data() + entry.offset, entry.size, false);
+			NetworkIn in(&stream);
+			in.generic<ReplaySavePoint>(state);
+		}
+
+	private:
+		struct IndexEntry
+		{
+			uint32_t step;
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		/// reads from the mapped file, checking that the data is inside of it
+		class Reader
+		{
+			public:
+				Reader(const MappedFile& file, std::size_t position) : mFile(file), mPosition(position)
+				{
+				}
+
+				const char* bytes(std::size_t count)
+				{
+					if(mPosition + count > mFile.size() || mPosition + count < mPosition)
+						throw std::runtime_error("Unexpected end of replay file");
+					const char* result = mFile.data() + mPosition;
+					mPosition += count;
+					return result;
+				}
+
+				uint32_t uint32()
+				{
+					auto data = reinterpret_cast<const unsigned char*>(bytes(4));
+					return data[0] | (data[1] << 8u) | (data[2] << 16u) | ((uint32_t)data[3] << 24u);
+				}
+
+				std::string string()
+				{
+					uint32_t length = uint32();
+					return std::string(bytes(length), length);
+				}
+
+				std::size_t position() const { return mPosition; }
+				bool atEnd() const { return mPosition >= mFile.size(); }
+
+			private:
+				const MappedFile& mFile;
+				std::size_t mPosition;
+		};
+
+		static bool hasTag(const char* data, const char (&tag)[4])
+		{
+			return std::memcmp(data, tag, sizeof(tag)) == 0;
+		}
+
+		void initLoading(std::string filename) override
+		{
+			mFile.reset(new MappedFile(filename));
+
+			Reader header(*mFile, 0);
+			if(!hasTag(header.bytes(4), REPLAY_V3_MAGIC))
+				throw std::runtime_error("Not a 3.x replay file: " + filename);
+
+			const char* version = header.bytes(4);
+			if(version[0] != 3)
+				throw VersionMismatchException(filename, version[0], version[1]);
+
+			mGameSpeed = header.uint32();
+			uint64_t date = header.uint32();
+			date |= (uint64_t)header.uint32() << 32u;
+			mGameDate = date;
+			mColors[LEFT_PLAYER] = Color(header.uint32());
+			mColors[RIGHT_PLAYER] = Color(header.uint32());
+			mPlayerNames[LEFT_PLAYER] = header.string();
+			mPlayerNames[RIGHT_PLAYER] = header.string();
+			mRules = header.string();
+
+			if(!readIndex())
+			{
+				// no usable index, e.g. because the recording was interrupted
+				mInputChunks.clear();
+				mSavePoints.clear();
+				scanChunks(header.position());
+			}
+		}
+
+		/// reads the index of a completely written file. Returns false if there is none,
+		/// or if it does not describe the chunks of a valid replay.
+		bool readIndex()
+		{
+			if(mFile->size() < 8)
+				return false;
+
+			Reader trailer(*mFile, mFile->size() - 8);
+			uint32_t index_position = trailer.uint32();
+			if(!hasTag(trailer.bytes(4), REPLAY_V3_TRAILER_MAGIC))
+				return false;
+
+			Reader index(*mFile, index_position);
+			if(!hasTag(index.bytes(4), REPLAY_CHUNK_INDEX))
+				return false;
+			index.uint32();
+
+			mGameLength = index.uint32();
+			mFinalScores[LEFT_PLAYER] = index.uint32();
+			mFinalScores[RIGHT_PLAYER] = index.uint32();
+
+			for(auto* table : {&mInputChunks, &mSavePoints})
+			{
+				uint32_t count = index.uint32();
+				// validate the count before reserving memory for it
+				if(count > mFile->size() / 12)
+					return false;
+				table->resize(count);
+				for(auto& entry : *table)
+				{
+					entry.step = index.uint32();
+					entry.offset = index.uint32();
+					entry.size = index.uint32();
+					if(entry.offset + (std::size_t)entry.size > mFile->size())
+						return false;
+				}
+			}
+
+			return isIndexConsistent();
+		}
+
+		/// checks that the input chunks follow each other without gaps or overlaps and add up
+		/// to the game length, and that the savepoints are ordered and inside of the game.
+		/// getInputAt and getSavePoint rely on this.
+		bool isIndexConsistent() const
+		{
+			if(mGameLength < 0)
+				return false;
+
+			uint64_t length = 0;
+			for(const auto& entry : mInputChunks)
+			{
+				if(entry.step != length)
+					return false;
+				length += entry.size;
+			}
+			if(length != (uint64_t)mGameLength)
+				return false;
+
+			uint32_t previous = 0;
+			for(const auto& entry : mSavePoints)
+			{
+				if(entry.step < previous || entry.step > length)
+					return false;
+				previous = entry.step;
+			}
+			return true;
+		}
+
+		/// rebuilds the index of a file whose recording did not finish, by walking over all chunks
+		void scanChunks(std::size_t position)
+		{
+			Reader chunks(*mFile, position);
+			mGameLength = 0;
+			while(mFile->size() - chunks.position() >= 8)
+			{
+				const char* tag = chunks.bytes(4);
+				uint32_t size = chunks.uint32();
+				// an incompletely written chunk ends the replay
+				if(mFile->size() - chunks.position() < size)
+					break;
+
+				uint32_t offset = chunks.position();
+				chunks.bytes(size);
+
+				if(hasTag(tag, REPLAY_CHUNK_INPUT))
+				{
+					mInputChunks.push_back(IndexEntry{(uint32_t)mGameLength, offset, size});
+					mGameLength += size;
+				}
+				else if(hasTag(tag, REPLAY_CHUNK_SAVEPOINT))
+				{
+					mSavePoints.push_back(IndexEntry{0, offset, size});
+					ReplaySavePoint savepoint;
+					readSavePoint(mSavePoints.size() - 1, savepoint);
+					mSavePoints.back().step = savepoint.step;
+					mFinalScores[LEFT_PLAYER] = savepoint.state.logicState.leftScore;
+					mFinalScores[RIGHT_PLAYER] = savepoint.state.logicState.rightScore;
+				}
+			}
+
+			// a damaged savepoint must not point past the input we have
+			mSavePoints.erase(std::remove_if(mSavePoints.begin(), mSavePoints.end(),
+											 [this](const IndexEntry& entry) { return entry.step > (uint32_t)mGameLength; }),
+							  mSavePoints.end());
+			std::stable_sort(mSavePoints.begin(), mSavePoints.end(),
+							 [](const IndexEntry& a, const IndexEntry& b) { return a.step < b.step; });
+		}
+
+		std::unique_ptr<MappedFile> mFile;
+
+		std::vector<IndexEntry> mInputChunks;
+		std::vector<IndexEntry> mSavePoints;
+
+		std::string mPlayerNames[MAX_PLAYERS];
+		Color mColors[MAX_PLAYERS];
+		unsigned int mFinalScores[MAX_PLAYERS] = {0, 0};
+		unsigned int mGameSpeed = 0;
+		std::time_t mGameDate = 0;
+		int mGameLength = 0;
+
+		std::string mRules;
+};
+
+
 IReplayLoader* IReplayLoader::createReplayLoader(int major)
 {
+	if(major == 3)
+		return new ReplayLoader_V3X();
+
 	return new ReplayLoader_V2X();
 }
@@ -23,14 +23,19 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 /* includes */
 #include <cassert>
+#include <algorithm>
 
 #include "IReplayLoader.h"
 #include "DuelMatch.h"
+#include "SimulationClock.h"
 
 /* implementation */
 ReplayPlayer::ReplayPlayer() = default;
 
-ReplayPlayer::~ReplayPlayer() = default;
+ReplayPlayer::~ReplayPlayer()
+{
+	stopIndexing();
+}
 
 bool ReplayPlayer::endOfFile() const
 {
@@ -39,6 +44,10 @@ bool ReplayPlayer::endOfFile() const
 
 void ReplayPlayer::load(const std::string& filename)
 {
+	stopIndexing();
+	mSavePointIndex.clear();
+
+	mFilename = filename;
 	loader.reset(IReplayLoader::createReplayLoader(filename));
 
 	mPlayerNames[LEFT_PLAYER] = loader->getPlayerName(LEFT_PLAYER);
@@ -83,6 +92,72 @@ std::string ReplayPlayer::getRules() const
 	return loader->getRules();
 }
 
+void ReplayPlayer::buildSavePointIndex(const std::string& rules)
+{
+	stopIndexing();
+	mSavePointIndex.clear();
+
+	// the indexer needs its own loader and match, the ones used for playing stay on this thread.
+	// both are created here, so the rules file is not needed anymore once we return.
+	std::shared_ptr<IReplayLoader> indexLoader(IReplayLoader::createReplayLoader(mFilename));
+	auto match = std::make_shared<DuelMatch>(false, rules, 0, createClock());
+
+	mSavePointIndex.push_back(match->getState());
+
+	mStopIndexing = false;
+	mIndexThread = std::thread([this, indexLoader, match]()
+	{
+		// same steps as play()
+		for(int position = 1; position < mLength && !mStopIndexing; ++position)
+		{
+			indexLoader->getInputAt(position,
+									match->getInputSource( LEFT_PLAYER ).get(),
+									match->getInputSource( RIGHT_PLAYER ).get() );
+			match->step();
+
+			int point;
+			if(indexLoader->isSavePoint(position, point))
+			{
+				ReplaySavePoint reference;
+				indexLoader->readSavePoint(point, reference);
+				match->setState(reference.state);
+			}
+
+			if(position % REPLAY_SAVEPOINT_PERIOD == 0)
+			{
+				std::lock_guard<std::mutex> lock(mIndexMutex);
+				mSavePointIndex.push_back(match->getState());
+			}
+		}
+	});
+}
+
+std::shared_ptr<SimulationClock> ReplayPlayer::createClock() const
+{
+	int speed = loader->getSpeed();
+	return SimulationClock::createFixedStepClock(speed > 0 ? (float)speed : 75.f);
+}
+
+void ReplayPlayer::stopIndexing()
+{
+	if(mIndexThread.joinable())
+	{
+		mStopIndexing = true;
+		mIndexThread.join();
+	}
+}
+
+int ReplayPlayer::getIndexedState(int position, DuelMatchState& state) const
+{
+	std::lock_guard<std::mutex> lock(mIndexMutex);
+	if(position < 0 || mSavePointIndex.empty())
+		return -1;
+
+	std::size_t index = std::min<std::size_t>(position / REPLAY_SAVEPOINT_PERIOD, mSavePointIndex.size() - 1);
+	state = mSavePointIndex[index];
+	return index * REPLAY_SAVEPOINT_PERIOD;
+}
+
 bool ReplayPlayer::play(DuelMatch* virtual_match)
 {
 	mPosition++;
@@ -120,19 +195,30 @@ bool ReplayPlayer::gotoPlayingPosition(int rep_position, DuelMatch* virtual_matc
 	int savepoint = loader->getSavePoint(rep_position, save_position);
 	// save position contains game step at which the save point is
 	// savepoint is index of save point in array
+	if(savepoint < 0)
+		save_position = -1;
+
+	// the savepoint index might have a state that is closer to the target
+	DuelMatchState indexed;
+	int index_position = getIndexedState(rep_position, indexed);
 
 	// now compare safepoint and actual position
 	// if we have to forward and save_position is nearer than current position, jump
-	if( (rep_position < mPosition || save_position > mPosition) && savepoint >= 0)
+	int jump_position = std::max(save_position, index_position);
+	if( (rep_position < mPosition || jump_position > mPosition) && jump_position >= 0)
 	{
 		// can't use mPosition
 		// set match to safepoint
-		ReplaySavePoint state;
-		loader->readSavePoint(savepoint, state);
+		if(save_position >= index_position)
+		{
+			ReplaySavePoint state;
+			loader->readSavePoint(savepoint, state);
+			indexed = state.state;
+		}
 
 		// set position and update match
-		mPosition = save_position;
-		virtual_match->setState(state.state);
+		mPosition = jump_position;
+		virtual_match->setState(indexed);
 	}
 	// otherwise, use current position
 
@@ -21,14 +21,21 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #pragma once
 
 #include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
 
 #include "Color.h"
+#include "DuelMatchState.h"
 #include "ReplayDefs.h"
 #include "PlayerInput.h"
 #include "BlobbyDebug.h"
 
 class DuelMatch;
 class IReplayLoader;
+class SimulationClock;
 
 /// \class ReplayPlayer
 /// \brief Manages playing of replays.
@@ -45,6 +52,20 @@ class ReplayPlayer : public ObjectCounter<ReplayPlayer>
 		void load(const std::string& filename);
 		std::string getRules() const;
 
+		/// \brief creates a dense savepoint index in the background
+		/// \details Simulates the whole replay once in a separate match and stores the state every
+		///			REPLAY_SAVEPOINT_PERIOD steps. Once the index reaches a position, jumping there
+		///			costs at most REPLAY_SAVEPOINT_PERIOD steps, even if the replay file itself has
+		///			no savepoints.
+		/// \param rules rules file to simulate the replay with. It is only read during this call.
+		void buildSavePointIndex(const std::string& rules);
+
+		/// \brief creates the clock for a match that plays this replay
+		/// \details The index is built with the same kind of clock, so its states are those that
+		///			playing would reach. The clock advances by one step of the recorded game speed
+		///			per step, independent of the speed the replay is watched at.
+		std::shared_ptr<SimulationClock> createClock() const;
+
 		// -----------------------------------------------------------------------------------------
 		// 							Replay Attributes
 		// -----------------------------------------------------------------------------------------
@@ -85,7 +106,8 @@ class ReplayPlayer : public ObjectCounter<ReplayPlayer>
 		bool play(DuelMatch* virtual_match);
 
 		/// \brief Jumps to a position in replay.
-		/// \details Goes to a certain position in replay. Simulates at most 100 steps per call
+		/// \details Goes to a certain position in replay. Starts from the nearest savepoint of the
+		///			replay file or the savepoint index. Simulates at most 100 steps per call
 		///			to prevent visual lags, so it is possible that this function has to be called
 		///			several times to reach the target.
 		/// \param rep_position target position in number of physic steps.
@@ -93,10 +115,21 @@ class ReplayPlayer : public ObjectCounter<ReplayPlayer>
 		bool gotoPlayingPosition(int rep_position, DuelMatch* virtual_match);
 
 	private:
+		/// looks up the last indexed state at or before \p position.
+		/// \return position of that state, or -1 if the index does not reach that far.
+		int getIndexedState(int position, DuelMatchState& state) const;
+		void stopIndexing();
 
 		int mPosition;
 		int mLength;
+		std::string mFilename;
 		std::unique_ptr<IReplayLoader> loader;
 
 		std::string mPlayerNames[MAX_PLAYERS];
+
+		// mSavePointIndex[i] is the match state at step i * REPLAY_SAVEPOINT_PERIOD
+		std::vector<DuelMatchState> mSavePointIndex;
+		mutable std::mutex mIndexMutex;
+		std::atomic<bool> mStopIndexing{false};
+		std::thread mIndexThread;
 };
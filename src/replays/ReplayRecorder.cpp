@@ -23,27 +23,22 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 /* includes */
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <ctime>
+#include <cassert>
+#include <algorithm>
 
 #include <boost/algorithm/string/trim_all.hpp>
 
-#include "tinyxml2.h"
-
-#include "raknet/BitStream.h"
-
 #include "Global.h"
 #include "ReplayDefs.h"
 #include "IReplayLoader.h"
 #include "GenericIO.h"
 #include "FileRead.h"
 #include "FileWrite.h"
-#include "base64.h"
-
-#ifdef __SWITCH__
-#define SIZET_TYPE unsigned int
-#else
-#define SIZET_TYPE std::uint64_t
-#endif
+#include "FileExceptions.h"
+#include "ReplayWriter.h"
 
 /* implementation */
 VersionMismatchException::VersionMismatchException(const std::string& filename, uint8_t major, uint8_t minor)
@@ -72,116 +67,108 @@ ReplayRecorder::ReplayRecorder()
 }
 
 ReplayRecorder::~ReplayRecorder() = default;
-template<class T>
-void writeAttribute(tinyxml2::XMLPrinter& printer, const char* name, const T& value)
+void ReplayRecorder::save(FileWrite& file)
 {
-	printer.OpenElement("var");
-	printer.PushAttribute("name", name);
-	printer.PushAttribute("value", value);
-	printer.CloseElement();
+	if(mStreamWriter)
+	{
+		auto data = getReplayData();
+		file.write(data.data(), data.size());
+		return;
+	}
+
+	ReplayWriter writer(file);
+	writeReplay(writer);
 }
 
-void ReplayRecorder::save(FileWrite& file) const
+std::vector<char> ReplayRecorder::getReplayData()
 {
-	tinyxml2::XMLPrinter printer;
-	printer.PushHeader(false, true);
-	printer.OpenElement("replay");
-	printer.OpenElement("version");
-	printer.PushAttribute("major", REPLAY_FILE_VERSION_MAJOR);
-	printer.PushAttribute("minor", REPLAY_FILE_VERSION_MINOR);
-	printer.CloseElement();
-
-	// the explicit template arguments below are to prevent ambiguities on OSX where
-	// size_t = unsigned long != unsigned int != uint64_t; same for time_t
-	writeAttribute(printer, "game_speed", mGameSpeed);
-	writeAttribute<SIZET_TYPE>(printer, "game_length", mSaveData.size());
-	writeAttribute<SIZET_TYPE>(printer, "game_duration", mSaveData.size() / mGameSpeed);
-	writeAttribute<std::int64_t>(printer, "game_date", std::time(nullptr));
-
-	writeAttribute(printer, "score_left", mEndScore[LEFT_PLAYER]);
-	writeAttribute(printer, "score_right", mEndScore[RIGHT_PLAYER]);
-
-	writeAttribute(printer, "name_left", mPlayerNames[LEFT_PLAYER].c_str());
-	writeAttribute(printer, "name_right", mPlayerNames[RIGHT_PLAYER].c_str());
-
-	/// \todo would be nice if we could write the actual colors instead of integers
-	writeAttribute(printer, "color_left", mPlayerColors[LEFT_PLAYER].toInt());
-	writeAttribute(printer, "color_right", mPlayerColors[RIGHT_PLAYER].toInt());
-
-	// write the game rules
-	printer.OpenElement("rules");
-	printer.PushText(mGameRules.c_str());
-	printer.CloseElement();
-
-	// now comes the actual replay data
-	printer.OpenElement("input");
-	std::string binary = encode(mSaveData, 80);
-	printer.PushText(binary.c_str());
-	printer.CloseElement();
-
-	// finally, write the save points
-	// first, convert them into a POD
-	printer.OpenElement("states");
-	RakNet::BitStream stream;
-	auto convert = createGenericWriter(&stream);
-	convert->generic<std::vector<ReplaySavePoint> > (mSavePoints);
-
-	binary = encode((char*)stream.GetData(), (char*)stream.GetData() + stream.GetNumberOfBytesUsed(), 80);
-	printer.PushText(binary.c_str());
-	printer.CloseElement();
+	if(mStreamWriter)
+	{
+		// make sure everything recorded so far can be read from the file
+		std::vector<char> data(flushStream());
+		std::ifstream source(mStreamPath, std::ios::binary);
+		if( !source.read(data.data(), data.size()) )
+			BOOST_THROW_EXCEPTION( FileLoadException(mStreamPath) );
+		return data;
+	}
 
-	printer.CloseElement();  // </replay>
-	file.write(printer.CStr(), printer.CStrSize() - 1); // do not save the terminating \0 character
+	std::vector<char> data;
+	ReplayWriter writer(data);
+	writeReplay(writer);
+	return data;
 }
 
-void ReplayRecorder::send(GenericOut& target) const
+void ReplayRecorder::writeReplay(ReplayWriter& writer) const
 {
-	target.string(mPlayerNames[LEFT_PLAYER]);
-	target.string(mPlayerNames[RIGHT_PLAYER]);
-
-	target.generic<Color> (mPlayerColors[LEFT_PLAYER]);
-	target.generic<Color> (mPlayerColors[RIGHT_PLAYER]);
+	writer.writeHeader(mGameSpeed, std::time(nullptr), mPlayerNames, mPlayerColors, mGameRules);
 
-	target.uint32( mGameSpeed );
-	target.uint32( mEndScore[LEFT_PLAYER] );
-	target.uint32( mEndScore[RIGHT_PLAYER] );
-
-	target.string(mGameRules);
+	// write input and savepoints in the order they were recorded
+	std::size_t written = 0;
+	for(const auto& savepoint : mSavePoints)
+	{
+		std::size_t step = std::min<std::size_t>(savepoint.step, mSaveData.size());
+		writer.writeInput(mSaveData.data() + written, step - written);
+		written = step;
+		writer.writeSavePoint(savepoint);
+	}
+	writer.writeInput(mSaveData.data() + written, mSaveData.size() - written);
 
-	target.generic<std::vector<unsigned char> >(mSaveData);
-	target.generic<std::vector<ReplaySavePoint> > (mSavePoints);
+	writer.finish(mEndScore[LEFT_PLAYER], mEndScore[RIGHT_PLAYER]);
 }
 
-void ReplayRecorder::receive(GenericIn& source)
+void ReplayRecorder::streamTo(const std::string& path)
 {
-	source.string(mPlayerNames[LEFT_PLAYER]);
-	source.string(mPlayerNames[RIGHT_PLAYER]);
-
-	source.generic<Color> (mPlayerColors[LEFT_PLAYER]);
-	source.generic<Color> (mPlayerColors[RIGHT_PLAYER]);
+	assert(mStepCount == 0);
+
+	// only switch to streaming once the header is written, so a failure leaves us recording in memory
+	std::unique_ptr<std::ofstream> file(new std::ofstream(path, std::ios::binary | std::ios::trunc));
+	if( !*file )
+		BOOST_THROW_EXCEPTION( FileLoadException(path) );
+	std::unique_ptr<ReplayWriter> writer(new ReplayWriter(*file));
+	writer->writeHeader(mGameSpeed, std::time(nullptr), mPlayerNames, mPlayerColors, mGameRules);
+
+	mStreamFile = std::move(file);
+	mStreamWriter = std::move(writer);
+	mStreamPath = path;
+}
 
-	source.uint32( mGameSpeed );
-	source.uint32( mEndScore[LEFT_PLAYER] );
-	source.uint32( mEndScore[RIGHT_PLAYER] );
+std::size_t ReplayRecorder::flushStream()
+{
+	assert(mStreamWriter);
 
-	source.string(mGameRules);
+	writeInput();
+	if( !mStreamFile->flush() )
+		BOOST_THROW_EXCEPTION( FileLoadException(mStreamPath) );
+	return mStreamWriter->getSize();
+}
 
-	source.generic<std::vector<unsigned char> >(mSaveData);
-	source.generic<std::vector<ReplaySavePoint> > (mSavePoints);
+void ReplayRecorder::writeInput()
+{
+	mStreamWriter->writeInput(mSaveData.data(), mSaveData.size());
+	mSaveData.clear();
 }
 
 void ReplayRecorder::record(const DuelMatchState& state)
 {
 	// save the state every REPLAY_SAVEPOINT_PERIOD frames
 	// or when something interesting occurs
-	if(mSaveData.size() % REPLAY_SAVEPOINT_PERIOD == 0 ||
+	if(mStepCount % REPLAY_SAVEPOINT_PERIOD == 0 ||
 		mEndScore[LEFT_PLAYER] != state.logicState.leftScore ||
 		mEndScore[RIGHT_PLAYER] != state.logicState.rightScore)
 	{
 		ReplaySavePoint sp;
 		sp.state = state;
-		sp.step = mSaveData.size();
-		mSavePoints.push_back(sp);
+		sp.step = mStepCount;
+
+		if(mStreamWriter)
+		{
+			writeInput();
+			mStreamWriter->writeSavePoint(sp);
+		}
+		else
+		{
+			mSavePoints.push_back(sp);
+		}
 	}
 
 	// we save this 1 here just for compatibility
@@ -190,14 +177,13 @@ void ReplayRecorder::record(const DuelMatchState& state)
 	packet |= (state.playerInput[LEFT_PLAYER].getAll() & 7u) << 3u;
 	packet |= (state.playerInput[RIGHT_PLAYER].getAll() & 7u) ;
 	mSaveData.push_back(packet);
+	++mStepCount;
 
 	// update the score
 	mEndScore[LEFT_PLAYER] = state.logicState.leftScore;
 	mEndScore[RIGHT_PLAYER] = state.logicState.rightScore;
 }
 
-
-
 void ReplayRecorder::setPlayerNames(const std::string& left, const std::string& right)
 {
 	mPlayerNames[LEFT_PLAYER] = left;
@@ -218,8 +204,14 @@ void ReplayRecorder::setGameSpeed(int fps)
 void ReplayRecorder::setGameRules( const std::string& rules )
 {
 	FileRead file(FileRead::makeLuaFilename("rules/"+rules));
-	mGameRules.resize( file.length() );
-	file.readRawBytes(&*mGameRules.begin(), file.length());
+	std::string script( file.length(), '\0' );
+	file.readRawBytes(&*script.begin(), file.length());
+	setGameRulesScript( std::move(script) );
+}
+
+void ReplayRecorder::setGameRulesScript( std::string script )
+{
+	mGameRules = std::move(script);
 	boost::algorithm::trim_all(mGameRules);
 }
 
@@ -234,4 +226,13 @@ void ReplayRecorder::finalize(unsigned int left, unsigned int right)
 		unsigned char packet = 0;
 		mSaveData.push_back(packet);
 	}
+	mStepCount += 75;
+
+	// complete the file. It stays readable, but nothing can be recorded anymore.
+	if(mStreamWriter)
+	{
+		writeInput();
+		mStreamWriter->finish(left, right);
+		flushStream();
+	}
 }
@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <string>
 #include <vector>
+#include <iosfwd>
 
 #include <memory>
 
@@ -34,12 +35,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "BlobbyDebug.h"
 #include "GenericIOFwd.h"
 
-namespace RakNet
-{
-	class BitStream;
-}
-
 class FileWrite;
+class ReplayWriter;
 
 /*! \class VersionMismatchException
 	\brief thrown when replays of incompatible version are loaded.
@@ -58,18 +55,33 @@ struct VersionMismatchException : public std::exception, public ObjectCounter<Ve
 };
 
 /// \brief recording game
-/// \todo we safe replays in continuous storage (array or std::vector)
-///			which might be ineffective for huge replays (1h ~ 270kb)
+/// \details By default, the recording is kept in memory until it is saved. For long running
+///			games, the recorder can instead stream the replay into a file while recording,
+///			keeping only the input since the last savepoint in memory.
 class ReplayRecorder : public ObjectCounter<ReplayRecorder>
 {
 	public:
 		ReplayRecorder();
 		~ReplayRecorder();
 
-		void save(FileWrite& target) const;
+		void save(FileWrite& target);
+
+		/// gets the replay as it would be saved, in the current replay file format.
+		/// While recording into a file, this contains everything recorded so far.
+		std::vector<char> getReplayData();
 
-		void send(GenericOut& stream) const;
-		void receive(GenericIn& stream);
+		/// \brief streams the recording into a file
+		/// \details From now on, input and savepoints are written to \p path as soon as
+		///			they are recorded, and the replay is completed when finalize is called.
+		///			\p path is a path of the operating system, not a physfs file name, so
+		///			streaming does not depend on the physfs write directory.
+		///			Has to be called after the game setup is set, and before anything is recorded.
+		/// \throw FileLoadException if the file cannot be created
+		void streamTo(const std::string& path);
+
+		/// \brief writes everything recorded so far to the file given to streamTo
+		/// \return the number of bytes of the file that form the replay up to now
+		std::size_t flushStream();
 
 		// recording functions
 		void record(const DuelMatchState& input);
@@ -82,10 +94,21 @@ class ReplayRecorder : public ObjectCounter<ReplayRecorder>
 		void setPlayerColors(Color left, Color right);
 		void setGameSpeed(int fps);
 		void setGameRules( const std::string& rules );
+		/// sets the rules script from its already loaded source, instead of reading the file \p rules
+		void setGameRulesScript( std::string script );
 
 	private:
+		void writeReplay(ReplayWriter& writer) const;
+		void writeInput();
+
+		/// in memory recording, all input. When streaming, input not yet written to the file
 		std::vector<uint8_t> mSaveData;
 		std::vector<ReplaySavePoint> mSavePoints;
+		unsigned int mStepCount = 0;
+
+		std::unique_ptr<std::ofstream> mStreamFile;
+		std::string mStreamPath;
+		std::unique_ptr<ReplayWriter> mStreamWriter;
 
 		// general replay attributes
 		std::string mPlayerNames[MAX_PLAYERS];
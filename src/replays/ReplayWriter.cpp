@@ -0,0 +1,166 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "ReplayWriter.h"
+
+/* includes */
+#include <cassert>
+#include <ostream>
+#include <stdexcept>
+
+#include <boost/throw_exception.hpp>
+
+#include "raknet/BitStream.h"
+
+#include "ReplayDefs.h"
+#include "ReplaySavePoint.h"
+#include "GenericIO.h"
+#include "FileWrite.h"
+
+/* implementation */
+
+ReplayWriter::ReplayWriter(FileWrite& target) :
+	mTarget( [&target](const char* data, std::size_t size) { target.write(data, size); } )
+{
+}
+
+ReplayWriter::ReplayWriter(std::vector<char>& target) :
+	mTarget( [&target](const char* data, std::size_t size) { target.insert(target.end(), data, data + size); } )
+{
+}
+
+ReplayWriter::ReplayWriter(std::ostream& target) :
+	mTarget( [&target](const char* data, std::size_t size)
+	{
+		if( !target.write(data, size) )
+			BOOST_THROW_EXCEPTION( std::runtime_error("Could not write replay") );
+	} )
+{
+}
+
+void ReplayWriter::writeHeader(int game_speed, std::time_t date, const std::string (&names)[MAX_PLAYERS],
+							   const Color (&colors)[MAX_PLAYERS], const std::string& rules)
+{
+	assert(mPosition == 0);
+
+	write(REPLAY_V3_MAGIC, sizeof(REPLAY_V3_MAGIC));
+	const char version[4] = {REPLAY_FILE_VERSION_MAJOR, REPLAY_FILE_VERSION_MINOR, 0, 0};
+	write(version, sizeof(version));
+
+	writeUInt32(game_speed);
+	auto date64 = static_cast<std::uint64_t>(date);
+	writeUInt32(date64 & 0xFFFFFFFFu);
+	writeUInt32(date64 >> 32u);
+	writeUInt32(colors[LEFT_PLAYER].toInt());
+	writeUInt32(colors[RIGHT_PLAYER].toInt());
+	writeString(names[LEFT_PLAYER]);
+	writeString(names[RIGHT_PLAYER]);
+	writeString(rules);
+}
+
+void ReplayWriter::writeInput(const uint8_t* data, std::size_t count)
+{
+	if(count == 0)
+		return;
+	assert(mPosition != 0 && !mFinished);
+
+	writeChunkHeader(REPLAY_CHUNK_INPUT, count);
+	mInputChunks.push_back( IndexEntry{mLength, mPosition, static_cast<uint32_t>(count)} );
+	write(reinterpret_cast<const char*>(data), count);
+	mLength += count;
+}
+
+void ReplayWriter::writeSavePoint(const ReplaySavePoint& savepoint)
+{
+	assert(mPosition != 0 && !mFinished);
+
+	RakNet::BitStream stream;
+	NetworkOut out(&stream);
+	out.generic<ReplaySavePoint>(savepoint);
+
+	uint32_t size = stream.GetNumberOfBytesUsed();
+	writeChunkHeader(REPLAY_CHUNK_SAVEPOINT, size);
+	mSavePoints.push_back( IndexEntry{savepoint.step, mPosition, size} );
+	write(reinterpret_cast<const char*>(stream.GetData()), size);
+}
+
+void ReplayWriter::finish(unsigned int left_score, unsigned int right_score)
+{
+	assert(mPosition != 0 && !mFinished);
+
+	uint32_t index_position = mPosition;
+	uint32_t size = 4 * 5 + 12 * (mInputChunks.size() + mSavePoints.size());
+	writeChunkHeader(REPLAY_CHUNK_INDEX, size);
+	writeUInt32(mLength);
+	writeUInt32(left_score);
+	writeUInt32(right_score);
+
+	for(const auto* table : {&mInputChunks, &mSavePoints})
+	{
+		writeUInt32(table->size());
+		for(const auto& entry : *table)
+		{
+			writeUInt32(entry.step);
+			writeUInt32(entry.offset);
+			writeUInt32(entry.size);
+		}
+	}
+
+	writeUInt32(index_position);
+	write(REPLAY_V3_TRAILER_MAGIC, sizeof(REPLAY_V3_TRAILER_MAGIC));
+	mFinished = true;
+}
+
+uint32_t ReplayWriter::getLength() const
+{
+	return mLength;
+}
+
+uint32_t ReplayWriter::getSize() const
+{
+	return mPosition;
+}
+
+void ReplayWriter::write(const char* data, std::size_t size)
+{
+	mTarget(data, size);
+	mPosition += size;
+}
+
+void ReplayWriter::writeChunkHeader(const char (&tag)[4], uint32_t size)
+{
+	write(tag, sizeof(tag));
+	writeUInt32(size);
+}
+
+void ReplayWriter::writeString(const std::string& value)
+{
+	writeUInt32(value.size());
+	write(value.data(), value.size());
+}
+
+void ReplayWriter::writeUInt32(uint32_t value)
+{
+	// little endian, independent of the platform
+	const char bytes[4] = {char(value & 0xFFu), char((value >> 8u) & 0xFFu),
+						   char((value >> 16u) & 0xFFu), char((value >> 24u) & 0xFFu)};
+	write(bytes, sizeof(bytes));
+}
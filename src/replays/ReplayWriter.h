@@ -0,0 +1,95 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+
+#include "Global.h"
+#include "Color.h"
+
+class FileWrite;
+struct ReplaySavePoint;
+
+/*! \class ReplayWriter
+	\brief writes replays in the binary 3.x format
+	\details The writer only ever appends to its target: first the header, then input
+			and savepoint chunks in the order they are passed in, and finally the index,
+			when finish() is called. This way, replays can be written while the game is
+			still running. The target has to stay alive while the writer is used.
+	\sa ReplayDefs.h for a description of the format
+*/
+class ReplayWriter
+{
+	public:
+		/// writes into a file
+		explicit ReplayWriter(FileWrite& target);
+		/// appends to a buffer in memory
+		explicit ReplayWriter(std::vector<char>& target);
+		/// writes into a stream
+		/// \throw std::runtime_error if writing to \p target fails
+		explicit ReplayWriter(std::ostream& target);
+
+		/// writes the file header. Has to be called once, before anything else.
+		void writeHeader(int game_speed, std::time_t date, const std::string (&names)[MAX_PLAYERS],
+						 const Color (&colors)[MAX_PLAYERS], const std::string& rules);
+
+		/// appends the input of \p count steps, continuing after the input written before.
+		void writeInput(const uint8_t* data, std::size_t count);
+
+		/// appends a savepoint.
+		void writeSavePoint(const ReplaySavePoint& savepoint);
+
+		/// writes the index and the trailer. Nothing can be appended afterwards.
+		void finish(unsigned int left_score, unsigned int right_score);
+
+		/// gets the number of input steps written so far
+		uint32_t getLength() const;
+
+		/// gets the number of bytes written so far
+		uint32_t getSize() const;
+
+	private:
+		struct IndexEntry
+		{
+			uint32_t step;
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		void write(const char* data, std::size_t size);
+		void writeChunkHeader(const char (&tag)[4], uint32_t size);
+		void writeString(const std::string& value);
+		void writeUInt32(uint32_t value);
+
+		std::function<void(const char*, std::size_t)> mTarget;
+		/// current size of the file, so we do not need to ask the file system for it
+		uint32_t mPosition = 0;
+		uint32_t mLength = 0;
+		bool mFinished = false;
+
+		std::vector<IndexEntry> mInputChunks;
+		std::vector<IndexEntry> mSavePoints;
+};
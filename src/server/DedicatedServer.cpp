@@ -21,9 +21,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "DedicatedServer.h"
 
 #include <set>
+#include <functional>
+#include <ostream>
 #include <algorithm>
 #include <iostream>
 #include <utility>
+#include <ctime>
 
 #include "raknet/RakServer.h"
 #include "raknet/PacketEnumerations.h"
@@ -32,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "ThreadSafeRakServer.h"
 #include "NetworkGame.h"
 #include "GenericIO.h"
+#include "Tracing.h"
 
 #ifndef WIN32
 #ifndef __ANDROID__
@@ -41,9 +45,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #endif
 #endif
 
-extern int SWLS_PacketCount;
-extern int SWLS_Connections;
-extern int SWLS_Games;
+extern std::atomic<int> SWLS_PacketCount;
+extern std::atomic<int> SWLS_Connections;
+extern std::atomic<int> SWLS_Games;
+extern std::atomic<int> SWLS_GameSteps;
 
 #ifdef __ANDROID__
 extern "C"
@@ -53,11 +58,15 @@ void syslog(int pri, const char* format, ...);
 DedicatedServer::DedicatedServer(ServerInfo info,
 								const std::vector<std::string>& rulefiles,
 								const std::vector<float>& gamespeeds,
-								int max_clients, bool local_server)
+								int max_clients, bool local_server,
+								unsigned game_threads)
 : mServer(new ThreadSafeRakServer())
 , mAcceptNewPlayers(true)
 , mPlayerHosted( local_server )
+, mReplayCounter(0)
 , mServerInfo(std::move(info))
+, mScheduler( local_server ? 1 : game_threads )
+, mCollectStatistics(false)
 {
 	if (!mServer->access([&](RakServer& srv){ return srv.Start(max_clients, 1, mServerInfo.port);}))
 	{
@@ -77,7 +86,10 @@ DedicatedServer::DedicatedServer(ServerInfo info,
 
 	// add rules
 	for( const auto& f : rulefiles )
+	{
 		mMatchMaker.addRuleOption( f );
+		mRules[f] = std::make_shared<const ServerRules>( f );
+	}
 
 	mServer->access([&](RakServer& srv){
 		srv.setUpdateCallback([this](){ queuePackets(); }
@@ -86,6 +98,10 @@ DedicatedServer::DedicatedServer(ServerInfo info,
 
 DedicatedServer::~DedicatedServer()
 {
+	// games send without locking the server, so they have to be stopped before it is shut down
+	for(const auto& game : mGameList)
+		mScheduler.remove(game);
+
 	mServer->access( [](RakServer& srv){ srv.Disconnect(50); } );
 }
 
@@ -107,7 +123,7 @@ void DedicatedServer::queuePackets()
 			case ID_BLOBBY_SERVER_PRESENT:
 			{
 				std::lock_guard<std::mutex> lock( mPacketQueueMutex );
-				mPacketQueue.push_back( packet );
+				mPacketQueue.push_back( std::move(packet) );
 				break;
 			}
 			// game progress packets
@@ -125,7 +141,11 @@ void DedicatedServer::queuePackets()
 				// delete the disconnectiong player
 				if( player != mPlayerMap.end() && player->second->getGame() )
 				{
-					player->second->getGame() ->injectPacket( packet );
+					if( !player->second->getGame()->injectPacket( packet ) )
+					{
+						syslog(LOG_WARNING, "packet queue of game is full, dropping packet (%d) from %s",
+							   int(packet->data[0]), packet->playerId.toString().c_str());
+					}
 				} else {
 					syslog(LOG_ERR, "received packet from player not in playerlist!");
 				}
@@ -136,6 +156,12 @@ void DedicatedServer::queuePackets()
 				syslog(LOG_DEBUG, "Unknown packet %d received\n", int(packet->data[0]));
 		}
 	}
+
+	if( mCollectStatistics && std::chrono::steady_clock::now() >= mNextStatisticsUpdate )
+	{
+		updateConnectionStatistics();
+		mNextStatisticsUpdate = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+	}
 }
 
 /*!
@@ -145,12 +171,14 @@ void DedicatedServer::queuePackets()
  */
 void DedicatedServer::processPackets()
 {
+	TRACE_SCOPE("DedicatedServer::processPackets");
+
 	while (!mPacketQueue.empty())
 	{
 		packet_ptr packet;
 		{
 			std::lock_guard<std::mutex> lock(mPacketQueueMutex);
-			packet = mPacketQueue.front();
+			packet = std::move(mPacketQueue.front());
 			mPacketQueue.pop_front();
 		}
 		SWLS_PacketCount++;
@@ -195,7 +223,7 @@ void DedicatedServer::processPackets()
 					const std::string playerName = player->second->getName();
 					if( player->second->getGame() )
 					{
-						player->second->getGame()->injectPacket( packet );
+						player->second->getGame()->injectDisconnect();
 					}
 
 					// no longer count this player as connected. protect this change with a mutex
@@ -235,6 +263,8 @@ void DedicatedServer::processPackets()
 
 void DedicatedServer::updateGames()
 {
+	TRACE_SCOPE("DedicatedServer::updateGames");
+
 	// update new game creation for locally hosted games.
 	if( mPlayerHosted )
 	{
@@ -249,6 +279,8 @@ void DedicatedServer::updateGames()
 		auto game = it.second->getGame();
 		if(game && !game->isGameValid())
 		{
+			// make sure no worker is still busy with the last step of this game
+			mScheduler.remove(game);
 			game->processPackets();
 		}
 	}
@@ -258,6 +290,7 @@ void DedicatedServer::updateGames()
 	{
 		if (!(*iter)->isGameValid())
 		{
+			mScheduler.remove(*iter);
 			syslog( LOG_DEBUG, "Removed game %s vs %s from gamelist",
 					(*iter)->getPlayerID(LEFT_PLAYER).toString().c_str(),
 					(*iter)->getPlayerID(RIGHT_PLAYER).toString().c_str()
@@ -301,6 +334,11 @@ void DedicatedServer::allowNewPlayers( bool allow )
 	mAcceptNewPlayers = allow;
 }
 
+void DedicatedServer::setReplayDir( const std::string& dir )
+{
+	mReplayDir = dir;
+}
+
 // debug
 void DedicatedServer::printAllPlayers(std::ostream& stream) const
 {
@@ -325,6 +363,124 @@ void DedicatedServer::printAllGames(std::ostream& stream) const
 	}
 }
 
+void DedicatedServer::enableMetrics()
+{
+	mCollectStatistics = true;
+}
+
+void DedicatedServer::updateConnectionStatistics()
+{
+	std::vector<ConnectionStatistics> statistics;
+	mServer->access([&](RakServer& srv)
+	{
+		for(int i = 0; i < srv.GetMaximumNumberOfPeers(); ++i)
+		{
+			PlayerID player = srv.GetPlayerIDFromIndex(i);
+			RakNetStatisticsStruct* stats = player != UNASSIGNED_PLAYER_ID ? srv.GetStatistics(player) : nullptr;
+			if( stats )
+				statistics.push_back(ConnectionStatistics{player, *stats, srv.GetLastPing(player)});
+		}
+	});
+
+	std::lock_guard<std::mutex> lock(mConnectionStatisticsMutex);
+	mConnectionStatistics.swap(statistics);
+}
+
+namespace
+{
+	void writeMetric(std::ostream& stream, const char* name, const char* type, const char* help, double value)
+	{
+		stream << "# HELP " << name << " " << help << "\n";
+		stream << "# TYPE " << name << " " << type << "\n";
+		stream << name << " " << value << "\n";
+	}
+}
+
+void DedicatedServer::writeMetrics(std::ostream& stream) const
+{
+	// counters have to be written without exponent
+	auto precision = stream.precision(15);
+
+	writeMetric(stream, "blobby_connections", "gauge", "Number of connected clients.", getConnectedClients());
+	writeMetric(stream, "blobby_connections_accepted_total", "counter", "Number of accepted connections.", SWLS_Connections);
+	writeMetric(stream, "blobby_games", "gauge", "Number of running games.", getActiveGamesCount());
+	writeMetric(stream, "blobby_games_started_total", "counter", "Number of started games.", SWLS_Games);
+	writeMetric(stream, "blobby_lobby_players", "gauge", "Number of connected players that are not in a game.", getWaitingPlayers());
+	writeMetric(stream, "blobby_lobby_open_games", "gauge", "Number of games in the lobby that wait for an opponent.", mMatchMaker.getOpenGamesCount());
+	writeMetric(stream, "blobby_packets_total", "counter", "Number of processed network packets.", SWLS_PacketCount);
+	writeMetric(stream, "blobby_game_workers", "gauge", "Number of threads that step the games.", mScheduler.getWorkerCount());
+	writeMetric(stream, "blobby_game_steps_total", "counter", "Number of game steps.", SWLS_GameSteps);
+	writeMetric(stream, "blobby_game_tick_overruns_total", "counter", "Number of game steps that started more than one step period late.", mScheduler.getOverrunCount());
+
+	auto steps = mScheduler.getStepTimes();
+	stream << "# HELP blobby_game_step_seconds Duration of single game steps, including their packet processing.\n";
+	stream << "# TYPE blobby_game_step_seconds histogram\n";
+	unsigned long cumulative = 0;
+	for(std::size_t i = 0; i < GameScheduler::STEP_TIME_BUCKETS.size(); ++i)
+	{
+		cumulative += steps.buckets[i];
+		stream << "blobby_game_step_seconds_bucket{le=\"" << GameScheduler::STEP_TIME_BUCKETS[i] / 1e6 << "\"} " << cumulative << "\n";
+	}
+	stream << "blobby_game_step_seconds_bucket{le=\"+Inf\"} " << steps.count << "\n";
+	stream << "blobby_game_step_seconds_sum " << steps.sum.count() / 1e6 << "\n";
+	stream << "blobby_game_step_seconds_count " << steps.count << "\n";
+
+	if( mCollectStatistics )
+	{
+		std::lock_guard<std::mutex> lock(mConnectionStatisticsMutex);
+
+		struct ConnectionMetric
+		{
+			const char* name;
+			const char* type;
+			const char* help;
+			std::function<double(const ConnectionStatistics&)> value;
+		};
+
+		const ConnectionMetric metrics[] = {
+			{"blobby_connection_ping_seconds", "gauge", "Last measured round trip time of the connection.",
+				[](const ConnectionStatistics& c){ return c.ping / 1000.0; }},
+			{"blobby_connection_sent_bytes_total", "counter", "Bytes sent to the client, including protocol overhead.",
+				[](const ConnectionStatistics& c){ return c.statistics.totalBitsSent / 8; }},
+			{"blobby_connection_received_bytes_total", "counter", "Bytes received from the client.",
+				[](const ConnectionStatistics& c){ return c.statistics.bitsReceived / 8; }},
+			{"blobby_connection_sent_packets_total", "counter", "UDP packets sent to the client.",
+				[](const ConnectionStatistics& c){ return c.statistics.packetsSent; }},
+			{"blobby_connection_received_packets_total", "counter", "UDP packets received from the client.",
+				[](const ConnectionStatistics& c){ return c.statistics.packetsReceived; }},
+			{"blobby_connection_sent_messages_total", "counter", "Messages sent to the client, excluding resends.",
+				[](const ConnectionStatistics& c){
+					unsigned sum = 0;
+					for(unsigned sent : c.statistics.messagesSent)
+						sum += sent;
+					return sum;
+				}},
+			{"blobby_connection_resent_messages_total", "counter", "Messages that had to be sent again because they were not acknowledged in time.",
+				[](const ConnectionStatistics& c){ return c.statistics.messageResends; }},
+			{"blobby_connection_resend_queue_messages", "gauge", "Messages waiting for an acknowledgement.",
+				[](const ConnectionStatistics& c){ return c.statistics.messagesOnResendQueue; }},
+			{"blobby_connection_bad_crc_packets_total", "counter", "Received packets that were dropped because of a wrong checksum.",
+				[](const ConnectionStatistics& c){ return c.statistics.packetsWithBadCRCReceived; }},
+			{"blobby_connection_duplicate_messages_total", "counter", "Received messages that had already been received.",
+				[](const ConnectionStatistics& c){ return c.statistics.duplicateMessagesReceived; }},
+			{"blobby_connection_window_size", "gauge", "Current size of the congestion window.",
+				[](const ConnectionStatistics& c){ return c.statistics.windowSize; }},
+		};
+
+		for(const auto& metric : metrics)
+		{
+			stream << "# HELP " << metric.name << " " << metric.help << "\n";
+			stream << "# TYPE " << metric.name << " " << metric.type << "\n";
+			for(const auto& connection : mConnectionStatistics)
+			{
+				stream << metric.name << "{peer=\"" << connection.player.toString() << "\"} " << metric.value(connection) << "\n";
+			}
+		}
+	}
+
+	stream.precision(precision);
+}
+
 // special packet processing
 void DedicatedServer::processBlobbyServerPresent( PlayerID source, RakNet::BitStream& stream )
 {
@@ -446,17 +602,45 @@ void DedicatedServer::createGame(NetworkPlayer& left,
 								const std::string& rules,
 								int scoreToWin, float gamespeed)
 {
+	std::string replayFile;
+	if( !mReplayDir.empty() )
+		replayFile = mReplayDir + "/server_" + std::to_string(std::time(nullptr)) + "_" + std::to_string(++mReplayCounter) + ".bvr";
+
+	// the match maker only offers the rules this server was started with
+	auto serverRules = mRules.find(rules);
+	if( serverRules == mRules.end() )
+	{
+		if( mRules.empty() )
+		{
+			syslog(LOG_ERR, "Cannot create game '%s' vs. '%s', unknown rules '%s' and no others available",
+				   left.getName().c_str(), right.getName().c_str(), rules.c_str());
+			return;
+		}
+
+		serverRules = mRules.begin();
+		syslog(LOG_ERR, "Game '%s' vs. '%s' requested unknown rules '%s', using '%s' instead",
+			   left.getName().c_str(), right.getName().c_str(), rules.c_str(), serverRules->first.c_str());
+	}
+
 	auto newgame = std::make_shared<NetworkGame>(mServer.get(), left, right,
-								switchSide, rules, scoreToWin, gamespeed);
-	left.setGame( newgame );
-	right.setGame( newgame );
+							switchSide, serverRules->second, scoreToWin, gamespeed, replayFile);
+
+	// the network thread routes the answers to the rules checksum to the game of the players,
+	// so they have to know their game before it is started.
+	{
+		std::lock_guard<std::mutex> lock( mPlayerMapMutex );
+		left.setGame( newgame );
+		right.setGame( newgame );
+	}
+	newgame->start();
 
 	SWLS_Games++;
 
 	/// \todo add some logging?
 	syslog(LOG_DEBUG, "Created game '%s' vs. '%s', rules: '%s'",
-		   left.getName().c_str(), right.getName().c_str(), rules.c_str());
+		   left.getName().c_str(), right.getName().c_str(), serverRules->first.c_str());
 	mGameList.push_back(newgame);
+	mScheduler.add(newgame);
 }
 
 
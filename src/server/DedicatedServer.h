@@ -20,6 +20,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <map>
 #include <list>
@@ -29,11 +31,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <memory>
 #include <set>
 
+#include "raknet/RakNetStatistics.h"
 #include "NetworkPlayer.h"
 #include "NetworkMessage.h"
 #include "server/MatchMaker.h"
+#include "server/GameScheduler.h"
 
 class ThreadSafeRakServer;
+struct ServerRules;
 
 // function for logging to replacing syslog
 enum {
@@ -53,8 +58,10 @@ class DedicatedServer
 		/// simultaneous connections
 		/// \todo Maybe two classes for server info: local server info for a server, and remote for data sent to client
 		/// \param is_local: Set to true, to indicate a locally hosted server intended for a single game.
+		/// \param game_threads: Number of worker threads that step the games. Zero means one per hardware thread.
 		DedicatedServer(ServerInfo info, const std::vector<std::string>& rulefile,
-						const std::vector<float>& speeds, int max_clients, bool is_local = false);
+						const std::vector<float>& speeds, int max_clients, bool is_local = false,
+						unsigned game_threads = 0);
 		~DedicatedServer();
 
 		// server processing
@@ -75,9 +82,21 @@ class DedicatedServer
 		void printAllPlayers(std::ostream& stream) const;
 		void printAllGames(std::ostream& stream) const;
 
+		/// \brief starts collecting the network statistics of all connections for writeMetrics()
+		void enableMetrics();
+		/// \brief writes the server metrics in the Prometheus text exposition format
+		/// \details Has to be called from the thread that calls processPackets() and updateGames().
+		///			The connection statistics are only written if enableMetrics() has been called,
+		///			and are at most one second old.
+		void writeMetrics(std::ostream& stream) const;
+
 
 		// server settings
 		void allowNewPlayers( bool allow );
+		/// \brief streams the replays of running games into files in the directory \p dir
+		/// \details \p dir is a path of the operating system, not a physfs path. If it is empty,
+		///			each game keeps its replay in memory.
+		void setReplayDir( const std::string& dir );
 
 	private:
 		// creates a new game with those players
@@ -98,11 +117,20 @@ class DedicatedServer
 		bool mAcceptNewPlayers;
 		// true, if this is a player hosted local server
 		bool mPlayerHosted;
+		// directory the games stream their replays to. empty, if replays are kept in memory
+		std::string mReplayDir;
+		// used to generate unique names for the replay files
+		unsigned mReplayCounter;
 		// server info with server config
 		ServerInfo mServerInfo;
 
+		// rules offered by this server, loaded once and shared by all games
+		std::map< std::string, std::shared_ptr<const ServerRules> > mRules;
+
 		// containers for all games and mapping players to their games
 		std::list< std::shared_ptr<NetworkGame> > mGameList;
+		// steps the games in mGameList. declared after the list, so the workers are stopped first
+		GameScheduler mScheduler;
 		std::map< PlayerID, std::shared_ptr<NetworkPlayer>> mPlayerMap;
 		std::mutex mPlayerMapMutex;
 
@@ -111,6 +139,22 @@ class DedicatedServer
 		std::set<PlayerID> mActiveConnections;
 
 		bool isConnected(PlayerID player) const;
+
+		// copies the raknet statistics of all connections. called from raknet thread!
+		void updateConnectionStatistics();
+
+		struct ConnectionStatistics
+		{
+			PlayerID player;
+			RakNetStatisticsStruct statistics;
+			int ping;
+		};
+
+		std::atomic<bool> mCollectStatistics;
+		// only used by the raknet thread
+		std::chrono::steady_clock::time_point mNextStatisticsUpdate;
+		std::vector<ConnectionStatistics> mConnectionStatistics;
+		mutable std::mutex mConnectionStatisticsMutex;
 		bool addConnection(PlayerID player);
 
 		// packet queue
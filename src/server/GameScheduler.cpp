@@ -0,0 +1,217 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "GameScheduler.h"
+
+/* includes */
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+#include "DedicatedServer.h"
+#include "NetworkGame.h"
+#include "Tracing.h"
+
+#ifndef WIN32
+#ifndef __ANDROID__
+#ifndef __SWITCH__
+#include <sys/syslog.h>
+#endif
+#endif
+#endif
+
+extern std::atomic<int> SWLS_GameSteps;
+
+#ifdef __ANDROID__
+extern "C"
+#endif
+void syslog(int pri, const char* format, ...);
+
+/* implementation */
+
+const std::vector<unsigned> GameScheduler::STEP_TIME_BUCKETS = {50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000};
+
+GameScheduler::GameScheduler(unsigned workers) :
+	mEpoch(clock_type::now()),
+	mOverruns(0),
+	mRunning(true)
+{
+	mStepTimes.buckets.resize(STEP_TIME_BUCKETS.size() + 1);
+
+	if(workers == 0)
+		workers = std::max(1u, std::thread::hardware_concurrency());
+
+	for(unsigned i = 0; i < workers; ++i)
+		mWorkers.emplace_back([this](){ workerLoop(); });
+}
+
+GameScheduler::~GameScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mRunning = false;
+	}
+	mScheduleChanged.notify_all();
+
+	for(auto& worker : mWorkers)
+		worker.join();
+}
+
+void GameScheduler::add(const std::shared_ptr<NetworkGame>& game)
+{
+	assert(game->getGameSpeed() > 0);
+
+	Entry entry;
+	entry.period = std::chrono::duration_cast<clock_type::duration>(
+						std::chrono::duration<double>(1.0 / game->getGameSpeed()) );
+	entry.game = game;
+
+	// align the first step to the next tick of the shared timeline
+	auto ticks = (clock_type::now() - mEpoch) / entry.period;
+	entry.due = mEpoch + (ticks + 1) * entry.period;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSchedule.push_back(std::move(entry));
+		std::push_heap(mSchedule.begin(), mSchedule.end(), &GameScheduler::laterDue);
+	}
+	mScheduleChanged.notify_one();
+}
+
+void GameScheduler::remove(const std::shared_ptr<NetworkGame>& game)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mStepFinished.wait(lock, [&](){
+		return std::find(mActive.begin(), mActive.end(), game.get()) == mActive.end();
+	});
+
+	auto entry = std::find_if(mSchedule.begin(), mSchedule.end(),
+							[&](const Entry& e){ return e.game == game; });
+	if(entry != mSchedule.end())
+	{
+		mSchedule.erase(entry);
+		std::make_heap(mSchedule.begin(), mSchedule.end(), &GameScheduler::laterDue);
+	}
+}
+
+unsigned GameScheduler::getGameCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mSchedule.size() + mActive.size();
+}
+
+unsigned GameScheduler::getWorkerCount() const
+{
+	return mWorkers.size();
+}
+
+unsigned long GameScheduler::getOverrunCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mOverruns;
+}
+
+GameScheduler::StepTimes GameScheduler::getStepTimes() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStepTimes;
+}
+
+bool GameScheduler::laterDue(const Entry& a, const Entry& b)
+{
+	return a.due > b.due;
+}
+
+void GameScheduler::workerLoop()
+{
+	setTraceThreadName("game worker");
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	while(mRunning)
+	{
+		if(mSchedule.empty())
+		{
+			mScheduleChanged.wait(lock);
+			continue;
+		}
+
+		// another worker might take the game while we sleep, or an earlier one might be added,
+		// so after waking up we always start over
+		auto now = clock_type::now();
+		if(mSchedule.front().due > now)
+		{
+			mScheduleChanged.wait_until(lock, mSchedule.front().due);
+			continue;
+		}
+
+		std::pop_heap(mSchedule.begin(), mSchedule.end(), &GameScheduler::laterDue);
+		Entry entry = std::move(mSchedule.back());
+		mSchedule.pop_back();
+		mActive.push_back(entry.game.get());
+
+		if(now - entry.due > entry.period)
+			++mOverruns;
+
+		lock.unlock();
+
+		// a game that fails, e.g. because its replay cannot be written, must not take the
+		// worker thread and with it the whole server down. Only this game is dropped.
+		try
+		{
+			entry.game->processPackets();
+			entry.game->step();
+			SWLS_GameSteps++;
+		}
+		catch(std::exception& e)
+		{
+			syslog(LOG_ERR, "Error while stepping game %s vs %s, dropping it: %s",
+					entry.game->getPlayerID(LEFT_PLAYER).toString().c_str(),
+					entry.game->getPlayerID(RIGHT_PLAYER).toString().c_str(), e.what());
+			entry.game->abort();
+		}
+
+		bool valid = entry.game->isGameValid();
+		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - now);
+
+		lock.lock();
+		auto bucket = std::lower_bound(STEP_TIME_BUCKETS.begin(), STEP_TIME_BUCKETS.end(), duration.count());
+		++mStepTimes.buckets[bucket - STEP_TIME_BUCKETS.begin()];
+		++mStepTimes.count;
+		mStepTimes.sum += duration;
+
+		mActive.erase(std::find(mActive.begin(), mActive.end(), entry.game.get()));
+
+		if(valid)
+		{
+			// late steps are caught up, as SpeedController does for a single game. If we are
+			// too far behind, we give up and continue from now on.
+			entry.due += entry.period;
+			if(now - entry.due > std::chrono::seconds(1))
+				entry.due = now;
+
+			mSchedule.push_back(std::move(entry));
+			std::push_heap(mSchedule.begin(), mSchedule.end(), &GameScheduler::laterDue);
+			mScheduleChanged.notify_one();
+		}
+
+		mStepFinished.notify_all();
+	}
+}
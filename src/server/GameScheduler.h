@@ -0,0 +1,118 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class NetworkGame;
+
+/*! \class GameScheduler
+	\brief steps all running network games of a server on a fixed pool of worker threads.
+	\details Instead of one thread per game, all games share a single tick timeline: each game is
+			stored with the point in time of its next step, and an idle worker picks the game that
+			is due first, runs `processPackets()` and `step()`, and puts it back with its next due
+			time. Games with the same speed are aligned to the same ticks, so a worker that wakes up
+			usually finds several games it can step back to back.
+			A game that is no longer valid (see NetworkGame::isGameValid) is not rescheduled after
+			its current step. A game that throws while it is stepped is logged and aborted (see
+			NetworkGame::abort), so the worker and all other games keep running.
+*/
+class GameScheduler
+{
+	public:
+		typedef std::chrono::steady_clock clock_type;
+
+		/// creates a scheduler with \p workers threads. If \p workers is zero, one thread per
+		/// hardware thread is used.
+		explicit GameScheduler(unsigned workers = 0);
+		/// stops and joins all worker threads. Games that are still scheduled are released.
+		~GameScheduler();
+
+		GameScheduler(const GameScheduler&) = delete;
+		GameScheduler& operator=(const GameScheduler&) = delete;
+
+		/// adds \p game to the schedule. It is stepped with its game speed, starting at the next tick.
+		void add(const std::shared_ptr<NetworkGame>& game);
+
+		/// removes \p game from the schedule. If a worker currently steps this game, this function
+		/// blocks until that step is finished, so afterwards the caller has exclusive access to \p game.
+		/// Removing a game that is not scheduled is a no-op.
+		void remove(const std::shared_ptr<NetworkGame>& game);
+
+		/// number of games that are currently scheduled
+		unsigned getGameCount() const;
+		/// number of worker threads
+		unsigned getWorkerCount() const;
+		/// number of steps that started later than one full step period after their due time
+		unsigned long getOverrunCount() const;
+
+		/// upper bounds of the buckets of the step time histogram, in microseconds
+		static const std::vector<unsigned> STEP_TIME_BUCKETS;
+
+		/// durations of all game steps so far, including the processing of their packets
+		struct StepTimes
+		{
+			/// number of steps per entry of STEP_TIME_BUCKETS that took longer than the
+			/// previous bound, but not longer than this one. The last entry counts all
+			/// steps that took longer than the largest bound.
+			std::vector<unsigned long> buckets;
+			unsigned long count = 0;
+			std::chrono::microseconds sum{0};
+		};
+		StepTimes getStepTimes() const;
+
+	private:
+		struct Entry
+		{
+			clock_type::time_point due;
+			clock_type::duration period;
+			std::shared_ptr<NetworkGame> game;
+		};
+
+		/// comparison for the heap in mSchedule: the earliest due time is at the front.
+		static bool laterDue(const Entry& a, const Entry& b);
+
+		void workerLoop();
+
+		// the tick timeline all games are aligned to
+		const clock_type::time_point mEpoch;
+
+		// heap of scheduled games, ordered by due time. guarded by mMutex
+		std::vector<Entry> mSchedule;
+		// games that are currently stepped by a worker. guarded by mMutex
+		std::vector<NetworkGame*> mActive;
+		unsigned long mOverruns;
+		StepTimes mStepTimes;
+		bool mRunning;
+
+		mutable std::mutex mMutex;
+		// signalled when the schedule changes
+		std::condition_variable mScheduleChanged;
+		// signalled when a worker finishes a step
+		std::condition_variable mStepFinished;
+
+		std::vector<std::thread> mWorkers;
+};
@@ -0,0 +1,184 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+/* header include */
+#include "MetricsEndpoint.h"
+
+/* includes */
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/throw_exception.hpp>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#endif
+
+/* implementation */
+namespace
+{
+	// a client has this much time to send its request and receive the answer
+	const std::chrono::milliseconds REQUEST_TIMEOUT(200);
+	// we only look for the end of the header, anything beyond is ignored
+	const std::size_t MAX_REQUEST_SIZE = 4096;
+	// further connections are closed right away
+	const std::size_t MAX_CLIENTS = 8;
+
+	void closeSocket(SOCKET socket)
+	{
+#ifdef _WIN32
+		closesocket(socket);
+#else
+		close(socket);
+#endif
+	}
+
+	bool setBlocking(SOCKET socket, bool blocking)
+	{
+#ifdef _WIN32
+		unsigned long nonblocking = blocking ? 0 : 1;
+		return ioctlsocket(socket, FIONBIO, &nonblocking) == 0;
+#else
+		int flags = fcntl(socket, F_GETFL, 0);
+		if(flags == -1)
+			return false;
+		return fcntl(socket, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK) == 0;
+#endif
+	}
+
+	/// whether the last failed recv or send only failed because it would have had to wait
+	bool wouldBlock()
+	{
+#ifdef _WIN32
+		return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+		return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+	}
+}
+
+MetricsEndpoint::MetricsEndpoint(unsigned short port) : mSocket(socket(AF_INET, SOCK_STREAM, 0))
+{
+	if(mSocket == INVALID_SOCKET)
+		BOOST_THROW_EXCEPTION( std::runtime_error("could not create metrics socket") );
+
+	int reuse = 1;
+	setsockopt(mSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+	sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if(bind(mSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+		|| listen(mSocket, 8) != 0 || !setBlocking(mSocket, false))
+	{
+		closeSocket(mSocket);
+		BOOST_THROW_EXCEPTION( std::runtime_error("could not listen on metrics port " + std::to_string(port)) );
+	}
+}
+
+MetricsEndpoint::~MetricsEndpoint()
+{
+	for(const auto& client : mClients)
+		closeSocket(client.socket);
+	closeSocket(mSocket);
+}
+
+void MetricsEndpoint::serve(const std::function<std::string()>& metrics)
+{
+	while(true)
+	{
+		SOCKET accepted = accept(mSocket, nullptr, nullptr);
+		if(accepted == INVALID_SOCKET)
+			break;
+
+		if(mClients.size() >= MAX_CLIENTS || !setBlocking(accepted, false))
+		{
+			closeSocket(accepted);
+			continue;
+		}
+		mClients.push_back(Client{accepted, std::chrono::steady_clock::now() + REQUEST_TIMEOUT, "", "", 0});
+	}
+
+	for(auto client = mClients.begin(); client != mClients.end(); )
+	{
+		if(update(*client, metrics))
+		{
+			++client;
+		}
+		else
+		{
+			closeSocket(client->socket);
+			client = mClients.erase(client);
+		}
+	}
+}
+
+bool MetricsEndpoint::update(Client& client, const std::function<std::string()>& metrics)
+{
+	if(std::chrono::steady_clock::now() > client.deadline)
+		return false;
+
+	// read until the end of the request header
+	while(client.response.empty())
+	{
+		char buffer[512];
+		int received = recv(client.socket, buffer, sizeof(buffer), 0);
+		if(received < 0 && wouldBlock())
+			return true;
+		if(received <= 0)
+			return false;
+
+		client.request.append(buffer, received);
+		if(client.request.find("\r\n\r\n") != std::string::npos)
+		{
+			std::string body = metrics();
+			client.response = "HTTP/1.0 200 OK\r\n"
+							  "Content-Type: text/plain; version=0.0.4\r\n"
+							  "Content-Length: " + std::to_string(body.size()) + "\r\n"
+							  "Connection: close\r\n\r\n" + body;
+		}
+		else if(client.request.size() >= MAX_REQUEST_SIZE)
+		{
+			return false;
+		}
+	}
+
+#ifdef MSG_NOSIGNAL
+	const int flags = MSG_NOSIGNAL;
+#else
+	const int flags = 0;
+#endif
+	while(client.sent < client.response.size())
+	{
+		int result = send(client.socket, client.response.data() + client.sent,
+						  client.response.size() - client.sent, flags);
+		if(result < 0 && wouldBlock())
+			return true;
+		if(result <= 0)
+			return false;
+		client.sent += result;
+	}
+
+	return false;
+}
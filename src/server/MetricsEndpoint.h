@@ -0,0 +1,72 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "raknet/SocketLayer.h"
+
+/*! \class MetricsEndpoint
+	\brief minimal HTTP server that answers every request with the server metrics
+	\details Listens on the loopback interface only, so the metrics are available to a local
+			Prometheus or an SSH tunnel, but not to the players. The endpoint does not run its
+			own thread: serve() has to be called regularly from the server main loop, which
+			also allows collecting the metrics on the thread that owns the server state.
+			All sockets are non-blocking, so a slow client never stalls the main loop; it
+			is only given a fixed time for the whole request, over as many calls to serve()
+			as needed.
+			The request itself is ignored, every path returns the same document.
+*/
+class MetricsEndpoint
+{
+	public:
+		/// starts listening on 127.0.0.1:\p port
+		/// \throw std::runtime_error if the port could not be opened
+		explicit MetricsEndpoint(unsigned short port);
+		~MetricsEndpoint();
+
+		MetricsEndpoint(const MetricsEndpoint&) = delete;
+		MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+		/// accepts new requests and continues the pending ones, as far as this is possible without
+		/// waiting. Complete requests are answered with the text returned by \p metrics.
+		void serve(const std::function<std::string()>& metrics);
+
+	private:
+		struct Client
+		{
+			SOCKET socket;
+			std::chrono::steady_clock::time_point deadline;
+			std::string request;
+			// empty until the request is complete
+			std::string response;
+			std::size_t sent;
+		};
+
+		/// reads, writes or times out \p client. returns false once it is done.
+		bool update(Client& client, const std::function<std::string()>& metrics);
+
+		SOCKET mSocket;
+		std::vector<Client> mClients;
+};
@@ -22,6 +22,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "NetworkGame.h"
 
 /* includes */
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <sstream>
 #include <iostream>
 #include <stdexcept>
@@ -41,23 +44,60 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "PhysicWorld.h"
 #include "NetworkPlayer.h"
 #include "InputSource.h"
-
-extern int SWLS_GameSteps;
+#include "Tracing.h"
+#include "DedicatedServer.h"
+
+#ifndef WIN32
+#ifndef __ANDROID__
+#ifndef __SWITCH__
+#include <sys/syslog.h>
+#endif
+#endif
+#endif
+
+#ifdef __ANDROID__
+extern "C"
+#endif
+void syslog(int pri, const char* format, ...);
 
 /* implementation */
 
+// a full snapshot is sent at least this often, so a client that lost track recovers quickly
+const unsigned SNAPSHOT_KEYFRAME_PERIOD = 75;
+// a client sends one input per frame, so this covers several seconds of a stalled game
+const unsigned PACKET_QUEUE_CAPACITY = 256;
+static_assert((PACKET_QUEUE_CAPACITY & (PACKET_QUEUE_CAPACITY - 1)) == 0, "PacketRing needs a power of two capacity");
+
+ServerRules::ServerRules(const std::string& rules) :
+	file(rules)
+{
+	FileRead rulesFile(std::string("rules/") + FileRead::makeLuaFilename( rules ));
+	checksum = rulesFile.calcChecksum(0);
+	script.resize( rulesFile.length() );
+	rulesFile.readRawBytes( &*script.begin(), script.size() );
+
+	packet.Write((unsigned char)ID_RULES);
+	packet.Write( (int)script.size() );
+	packet.Write( script.data(), script.size() );
+}
+
 NetworkGame::NetworkGame(ThreadSafeRakServer* server, NetworkPlayer& leftPlayer,
 			NetworkPlayer& rightPlayer, PlayerSide switchedSide,
-			std::string rules, int scoreToWin, float speed) :
+			std::shared_ptr<const ServerRules> rules, int scoreToWin, float speed,
+			const std::string& replayFile) :
 	mServer(server),
-	mMatch(new DuelMatch(false, rules, scoreToWin)),
-	mSpeedController(speed),
+	mPacketQueue(PACKET_QUEUE_CAPACITY),
+	mDisconnected(false),
+	mMatch(new DuelMatch(false, rules->file, scoreToWin)),
+	mGameSpeed(speed),
 	mLeftInput (new InputSource()),
 	mRightInput(new InputSource()),
 	mLeftLastTime(-1),
 	mRightLastTime(-1),
+	mSnapshotSequence(0),
 	mRecorder(new ReplayRecorder()),
-	mGameValid(true)
+	mGameValid(true),
+	mRules(std::move(rules))
 {
 	// check that both players don't have an active game
 	if(leftPlayer.getGame())
@@ -79,50 +119,59 @@ NetworkGame::NetworkGame(ThreadSafeRakServer* server, NetworkPlayer& leftPlayer,
 
 	mRecorder->setPlayerNames(leftPlayer.getName(), rightPlayer.getName());
 	mRecorder->setPlayerColors(leftPlayer.getColor(), rightPlayer.getColor());
-	mRecorder->setGameSpeed(mSpeedController.getGameSpeed());
-	mRecorder->setGameRules(rules);
+	mRecorder->setGameSpeed(mGameSpeed);
+	mRecorder->setGameRulesScript(mRules->script);
+
+	if(!replayFile.empty())
+	{
+		try
+		{
+			mRecorder->streamTo(replayFile);
+			mReplayFile = replayFile;
+		}
+		catch(FileException&)
+		{
+			// we can still record the replay in memory
+		}
+	}
 
-	// read rulesfile into a string
 	mRulesSent[0] = false;
 	mRulesSent[1] = false;
 
-	rules = FileRead::makeLuaFilename( rules );
-	FileRead file(std::string("rules/") + rules);
-	int checksum = file.calcChecksum(0);
-	mRulesString = file.readRawBytes(file.length());
+	mAckedSnapshot[LEFT_PLAYER] = -1;
+	mAckedSnapshot[RIGHT_PLAYER] = -1;
+}
+
+NetworkGame::~NetworkGame()
+{
+	if(!mReplayFile.empty())
+	{
+		// the replay file is only kept for the clients of this game
+		mReplayUploads.clear();
+		mRecorder.reset();
+		std::remove(mReplayFile.c_str());
+	}
+}
 
+void NetworkGame::start()
+{
 	// writing rules checksum
 	RakNet::BitStream stream;
 	stream.Write((unsigned char)ID_RULES_CHECKSUM);
-	stream.Write(checksum);
+	stream.Write((int)mRules->checksum);
 	stream.Write(mMatch->getScoreToWin());
 	/// \todo write file author and title, too; maybe add a version number in scripts, too.
 	broadcastBitstream(stream);
-
-	// game loop
-	mGameThread = std::thread(
-		[this]()
-		{
-			while(mGameValid)
-			{
-				processPackets();
-				step();
-				SWLS_GameSteps++;
-				mSpeedController.update();
-			}
-		}					);
 }
 
-NetworkGame::~NetworkGame()
+bool NetworkGame::injectPacket(packet_ptr& packet)
 {
-	mGameValid = false;
-	mGameThread.join();
+	return mPacketQueue.push(packet);
 }
 
-void NetworkGame::injectPacket(const packet_ptr& packet)
+void NetworkGame::injectDisconnect()
 {
-	std::lock_guard<std::mutex> lock(mPacketQueueMutex);
-	mPacketQueue.push_back(packet);
+	mDisconnected = true;
 }
 
 void NetworkGame::broadcastBitstream(const RakNet::BitStream& stream, const RakNet::BitStream& switchedstream)
@@ -159,17 +208,30 @@ void NetworkGame::broadcastBitstream(const RakNet::BitStream& stream)
 
 void NetworkGame::processPackets()
 {
-	while (!mPacketQueue.empty())
-	{
-		packet_ptr packet;
-		{
-			std::lock_guard<std::mutex> lock(mPacketQueueMutex);
-			packet = mPacketQueue.front();
-			mPacketQueue.pop_front();
-		}
+	TRACE_SCOPE("NetworkGame::processPackets");
+
+	// check for a disconnect first: all packets that were injected before it are in the queue then
+	bool disconnected = mDisconnected.exchange(false);
 
+	packet_ptr packet;
+	while (mPacketQueue.pop(packet))
+	{
 		processPacket( packet );
 	}
+
+	if(disconnected)
+		processDisconnect();
+
+	sendReplayParts();
+}
+
+void NetworkGame::processDisconnect()
+{
+	RakNet::BitStream stream;
+	stream.Write((unsigned char)ID_OPPONENT_DISCONNECTED);
+	broadcastBitstream(stream);
+	mMatch->pause();
+	mGameValid = false;
 }
 
 /// this function processes a single packet received for this network game
@@ -177,16 +239,6 @@ void NetworkGame::processPacket( const packet_ptr& packet )
 {
 	switch(packet->data[0])
 	{
-		case ID_CONNECTION_LOST:
-		case ID_DISCONNECTION_NOTIFICATION:
-		{
-			RakNet::BitStream stream;
-			stream.Write((unsigned char)ID_OPPONENT_DISCONNECTED);
-			broadcastBitstream(stream);
-			mMatch->pause();
-			mGameValid = false;
-			break;
-		}
 
 		case ID_INPUT_UPDATE:
 		{
@@ -199,12 +251,20 @@ void NetworkGame::processPacket( const packet_ptr& packet )
 			stream.Read(time);
 			PlayerInputAbs newInput(stream);
 
+			// last snapshot the client received
+			bool hasAck = false;
+			std::uint16_t ack = 0;
+			stream.Read(hasAck);
+			stream.Read(ack);
+			int acked = hasAck ? ack : -1;
+
 			if (packet->playerId == mLeftPlayer)
 			{
 				if (mSwitchedSide == LEFT_PLAYER)
 					newInput.swapSides();
 				mLeftInput->setInput(newInput);
 				mLeftLastTime = time;
+				mAckedSnapshot[LEFT_PLAYER] = acked;
 			}
 			if (packet->playerId == mRightPlayer)
 			{
@@ -212,6 +272,7 @@ void NetworkGame::processPacket( const packet_ptr& packet )
 					newInput.swapSides();
 				mRightInput->setInput(newInput);
 				mRightLastTime = time;
+				mAckedSnapshot[RIGHT_PLAYER] = acked;
 			}
 			break;
 		}
@@ -258,35 +319,56 @@ void NetworkGame::processPacket( const packet_ptr& packet )
 
 		case ID_REPLAY:
 		{
-			RakNet::BitStream stream;
-			stream.Write((unsigned char)ID_REPLAY);
-			std::shared_ptr<GenericOut> out = createGenericWriter( &stream );
-			mRecorder->send( *out );
-			assert( stream.GetData()[0] == ID_REPLAY );
+			if(!mRecorder)
+			{
+				syslog(LOG_NOTICE, "Replay requested by %s, but this game is not recorded", packet->playerId.toString().c_str());
+				break;
+			}
 
-			mServer->Send(stream, LOW_PRIORITY, RELIABLE_ORDERED, packet->playerId);
+			// the replay is sent in parts by sendReplayParts, so a large replay neither needs a
+			// single huge packet nor blocks this thread while the file is read
+			ReplayUpload upload;
+			upload.target = packet->playerId;
+			upload.position = 0;
+			try
+			{
+				if(!mReplayFile.empty())
+				{
+					upload.size = mRecorder->flushStream();
+					upload.file.reset(new std::ifstream(mReplayFile, std::ios::binary));
+					if(!*upload.file)
+						BOOST_THROW_EXCEPTION( FileLoadException(mReplayFile) );
+				}
+				else
+				{
+					upload.data = mRecorder->getReplayData();
+					upload.size = upload.data.size();
+				}
+			}
+			catch(std::exception& e)
+			{
+				dropReplay(e.what());
+				break;
+			}
 
+			// a new request replaces the one that is still sent to this client
+			mReplayUploads.erase(std::remove_if(mReplayUploads.begin(), mReplayUploads.end(),
+					[&](const ReplayUpload& u) { return u.target == upload.target; }), mReplayUploads.end());
+			mReplayUploads.push_back(std::move(upload));
 			break;
 		}
 
 		case ID_RULES:
 		{
-			std::shared_ptr<RakNet::BitStream> stream = std::make_shared<RakNet::BitStream>(packet->data,
-					packet->length, false);
+			RakNet::BitStream stream(packet->data, packet->length, false);
 			bool needRules;
-			stream->IgnoreBytes(1);
-			stream->Read(needRules);
+			stream.IgnoreBytes(1);
+			stream.Read(needRules);
 			mRulesSent[mLeftPlayer == packet->playerId ? LEFT_PLAYER : RIGHT_PLAYER] = true;
 
 			if (needRules)
 			{
-				stream = std::make_shared<RakNet::BitStream>();
-				stream->Write((unsigned char)ID_RULES);
-				stream->Write( (int)mRulesString.size() );
-				stream->Write( mRulesString.data(), mRulesString.size());
-				assert( stream->GetData()[0] == ID_RULES );
-
-				mServer->Send(*stream, HIGH_PRIORITY, RELIABLE_ORDERED, packet->playerId);
+				mServer->Send(mRules->packet, HIGH_PRIORITY, RELIABLE_ORDERED, packet->playerId);
 			}
 
 			if (isGameStarted())
@@ -297,7 +379,7 @@ void NetworkGame::processPacket( const packet_ptr& packet )
 				// writing data into leftStream
 				RakNet::BitStream leftStream;
 				leftStream.Write((unsigned char)ID_GAME_READY);
-				leftStream.Write((int)mSpeedController.getGameSpeed());
+				leftStream.Write((int)mGameSpeed);
 				strncpy(name, mMatch->getPlayer(RIGHT_PLAYER).getName().c_str(), sizeof(name));
 				leftStream.Write(name, sizeof(name));
 				leftStream.Write(mMatch->getPlayer(RIGHT_PLAYER).getStaticColor().toInt());
@@ -305,7 +387,7 @@ void NetworkGame::processPacket( const packet_ptr& packet )
 				// writing data into rightStream
 				RakNet::BitStream rightStream;
 				rightStream.Write((unsigned char)ID_GAME_READY);
-				rightStream.Write((int)mSpeedController.getGameSpeed());
+				rightStream.Write((int)mGameSpeed);
 				strncpy(name, mMatch->getPlayer(LEFT_PLAYER).getName().c_str(), sizeof(name));
 				rightStream.Write(name, sizeof(name));
 				rightStream.Write(mMatch->getPlayer(LEFT_PLAYER).getStaticColor().toInt());
@@ -329,16 +411,90 @@ bool NetworkGame::isGameValid() const
 	return mGameValid;
 }
 
+void NetworkGame::abort()
+{
+	processDisconnect();
+}
+
+void NetworkGame::recordState()
+{
+	if(!mRecorder)
+		return;
+
+	try
+	{
+		mRecorder->record(mMatch->getState());
+	}
+	catch(std::exception& e)
+	{
+		dropReplay(e.what());
+	}
+}
+
+void NetworkGame::dropReplay(const char* reason)
+{
+	syslog(LOG_ERR, "Recording the replay of %s vs %s failed, continuing without replay: %s",
+			mLeftPlayer.toString().c_str(), mRightPlayer.toString().c_str(), reason);
+
+	mReplayUploads.clear();
+	mRecorder.reset();
+	if(!mReplayFile.empty())
+	{
+		std::remove(mReplayFile.c_str());
+		mReplayFile.clear();
+	}
+}
+
+void NetworkGame::sendReplayParts()
+{
+	char buffer[REPLAY_PART_SIZE];
+	for(auto upload = mReplayUploads.begin(); upload != mReplayUploads.end(); )
+	{
+		std::size_t length = std::min<std::size_t>(REPLAY_PART_SIZE, upload->size - upload->position);
+		const char* part = upload->data.data() + upload->position;
+		if(upload->file)
+		{
+			if(!upload->file->read(buffer, length))
+			{
+				syslog(LOG_ERR, "Could not read the replay for %s from %s", upload->target.toString().c_str(), mReplayFile.c_str());
+				upload = mReplayUploads.erase(upload);
+				continue;
+			}
+			part = buffer;
+		}
+
+		unsigned char flags = 0;
+		if(upload->position == 0)
+			flags |= REPLAY_PART_FIRST;
+		upload->position += length;
+		if(upload->position == upload->size)
+			flags |= REPLAY_PART_LAST;
+
+		RakNet::BitStream stream;
+		stream.Write((unsigned char)ID_REPLAY);
+		stream.Write(flags);
+		stream.Write(part, length);
+		mServer->Send(stream, LOW_PRIORITY, RELIABLE_ORDERED, upload->target);
+
+		if(flags & REPLAY_PART_LAST)
+			upload = mReplayUploads.erase(upload);
+		else
+			++upload;
+	}
+}
+
 
 void NetworkGame::step()
 {
+	TRACE_SCOPE("NetworkGame::step");
+
 	if (!isGameStarted())
 		return;
 
 	// don't record the pauses
 	if(!mMatch->isPaused())
 	{
-		mRecorder->record(mMatch->getState());
+		recordState();
 
 		mMatch->step();
 
@@ -349,8 +505,18 @@ void NetworkGame::step()
 		{
 			// if someone has won, the game is paused
 			mMatch->pause();
-			mRecorder->record(mMatch->getState());
-			mRecorder->finalize( mMatch->getScore(LEFT_PLAYER), mMatch->getScore(RIGHT_PLAYER) );
+			recordState();
+			if(mRecorder)
+			{
+				try
+				{
+					mRecorder->finalize( mMatch->getScore(LEFT_PLAYER), mMatch->getScore(RIGHT_PLAYER) );
+				}
+				catch(std::exception& e)
+				{
+					dropReplay(e.what());
+				}
+			}
 
 			RakNet::BitStream stream;
 			stream.Write((unsigned char)ID_WIN_NOTIFICATION);
@@ -367,37 +533,55 @@ void NetworkGame::step()
 	}
 }
 
-void NetworkGame::broadcastPhysicState(const DuelMatchState& state) const
+void NetworkGame::broadcastPhysicState(const DuelMatchState& state)
 {
-	DuelMatchState ms = state;	// modifiable copy
-
-	RakNet::BitStream stream;
-	stream.Write((unsigned char)ID_GAME_UPDATE);
-	stream.Write( mLeftLastTime );
+	TRACE_SCOPE("NetworkGame::broadcastPhysicState");
 
-	/// \todo this required dynamic memory allocation! not good!
-	std::shared_ptr<GenericOut> out = createGenericWriter( &stream );
+	++mSnapshotSequence;
+	sendPhysicState(LEFT_PLAYER, state);
+	sendPhysicState(RIGHT_PLAYER, state);
+}
 
-	if (mSwitchedSide == LEFT_PLAYER)
+void NetworkGame::sendPhysicState(PlayerSide player, const DuelMatchState& state)
+{
+	// every client sees itself on the side it has chosen
+	MatchSnapshot snapshot;
+	if (mSwitchedSide == player)
+	{
+		DuelMatchState ms = state;	// modifiable copy
 		ms.swapSides();
+		snapshot = MatchSnapshot::fromState(ms);
+	}
+	else
+	{
+		snapshot = MatchSnapshot::fromState(state);
+	}
 
-	out->generic<DuelMatchState> (ms);
-	mServer->Send(stream, HIGH_PRIORITY, UNRELIABLE_SEQUENCED, mLeftPlayer);
+	// use the last acknowledged snapshot as base, if we still know it. Every
+	// SNAPSHOT_KEYFRAME_PERIOD steps, a full snapshot is sent regardless.
+	const MatchSnapshot* base = nullptr;
+	std::uint16_t age = 0;
+	if (mAckedSnapshot[player] >= 0 && mSnapshotSequence % SNAPSHOT_KEYFRAME_PERIOD != 0)
+	{
+		age = mSnapshotSequence - mAckedSnapshot[player];
+		base = mSentSnapshots[player].find(mAckedSnapshot[player]);
+	}
+	if (!base || age == 0 || age >= SnapshotHistory::SIZE)
+	{
+		base = nullptr;
+		age = 0;
+	}
 
-	// reset state and stream
-	stream.Reset();
+	RakNet::BitStream stream;
 	stream.Write((unsigned char)ID_GAME_UPDATE);
-	stream.Write( mRightLastTime );
+	stream.Write(player == LEFT_PLAYER ? mLeftLastTime : mRightLastTime);
+	stream.Write(mSnapshotSequence);
+	stream.Write((unsigned char)age);
+	writeSnapshot(stream, snapshot, base, age);
 
-	out = createGenericWriter( &stream );
+	mSentSnapshots[player].store(mSnapshotSequence, snapshot);
 
-	// either switch back, or perform switching for right side
-	if (mSwitchedSide == LEFT_PLAYER || mSwitchedSide == RIGHT_PLAYER)
-		ms.swapSides();
-
-	out->generic<DuelMatchState> (ms);
-
-	mServer->Send(stream, HIGH_PRIORITY, UNRELIABLE_SEQUENCED, mRightPlayer);
+	mServer->Send(stream, HIGH_PRIORITY, UNRELIABLE_SEQUENCED, player == LEFT_PLAYER ? mLeftPlayer : mRightPlayer);
 }
 
 // helper function that writes a single event to bit stream in a space efficient way.
@@ -449,3 +633,8 @@ PlayerID NetworkGame::getPlayerID( PlayerSide side ) const
 	assert(0);
 }
 
+
+float NetworkGame::getGameSpeed() const
+{
+	return mGameSpeed;
+}
@@ -20,23 +20,40 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #pragma once
 
-#include <list>
-#include <mutex>
-#include <thread>
+#include <atomic>
+#include <iosfwd>
 #include <memory>
+#include <vector>
 
 #include "Global.h"
 #include "raknet/NetworkTypes.h"
 #include "raknet/BitStream.h"
-#include "SpeedController.h"
 #include "DuelMatch.h"
+#include "NetworkSnapshot.h"
+#include "server/PacketRing.h"
 #include "BlobbyDebug.h"
 
 class ThreadSafeRakServer;
 class ReplayRecorder;
 class NetworkPlayer;
 
-typedef std::list<packet_ptr> PacketQueue;
+/*! \struct ServerRules
+	\brief a rules file, prepared for being offered to clients
+	\details The server loads each rules file it offers once, and all games that are
+			played with these rules share it.
+*/
+struct ServerRules
+{
+	/// loads the rules file \p rules from the rules directory
+	/// \exception Throws FileLoadException, if the rules file could not be loaded
+	explicit ServerRules(const std::string& rules);
+
+	std::string file;
+	uint32_t checksum;
+	std::string script;
+	/// the complete ID_RULES packet that transfers the rules file to a client
+	RakNet::BitStream packet;
+};
 
 class NetworkGame : public ObjectCounter<NetworkGame>
 {
@@ -47,19 +64,38 @@ class NetworkGame : public ObjectCounter<NetworkGame>
 		// The IDs are assumed to be on the same side as they are named.
 		// If both players want to be on the same side, switchedSide
 		// decides which player is switched.
-		/// \exception Throws FileLoadException, if the desired rules file could not be loaded
 		///	\exception Throws std::runtime_error, if \p leftPlayer or \p rightPlayer are already assigned to a game.
+		/// The game does not run on its own; it has to be started with start() and stepped with
+		/// \p speed steps per second, usually by adding it to a GameScheduler.
+		/// If \p replayFile (a path of the operating system) is given, the replay is streamed into
+		/// that file instead of being kept in memory. The file is deleted together with the game. If it cannot be created, the replay is
+		/// recorded in memory.
 		NetworkGame(ThreadSafeRakServer* server, NetworkPlayer& leftPlayer,
 					NetworkPlayer& rightPlayer, PlayerSide switchedSide,
-					std::string rules, int scoreToWin, float speed);
+					std::shared_ptr<const ServerRules> rules, int scoreToWin, float speed,
+					const std::string& replayFile = "");
 
 		~NetworkGame();
 
-		void injectPacket(const packet_ptr& packet);
+		/// sends the rules checksum to both players, which starts the game on their side.
+		/// Their answers are routed to this game, so it has to be set as game of both players first.
+		void start();
+
+		/// hands \p packet over to this game. Must only be called by the network thread.
+		/// \return false if the packet queue of this game is full. \p packet is not taken in that case.
+		bool injectPacket(packet_ptr& packet);
+
+		/// tells this game that one of its players has disconnected. The disconnect is handled
+		/// by the next call to processPackets(), after all packets that were injected before.
+		void injectDisconnect();
 
 		/// It returns whether both clients are still connected.
 		bool isGameValid() const;
 
+		/// ends a game that cannot continue, e.g. because stepping it failed. Both players
+		/// are told that their opponent disconnected, and the game becomes invalid.
+		void abort();
+
 		// This function processes the queued network packets,
 		// makes a physic step, checks the rules and broadcasts
 		// the current state and outstanding messages to the clients.
@@ -71,39 +107,70 @@ class NetworkGame : public ObjectCounter<NetworkGame>
 		// game info
 		/// gets network IDs of players
 		PlayerID getPlayerID( PlayerSide side ) const;
+		/// gets the number of steps per second this game should be run with
+		float getGameSpeed() const;
 
 	private:
 		void broadcastBitstream(const RakNet::BitStream& stream, const RakNet::BitStream& switchedstream);
 		void broadcastBitstream(const RakNet::BitStream& stream);
-		void broadcastPhysicState(const DuelMatchState& state) const;
+		void broadcastPhysicState(const DuelMatchState& state);
+		void sendPhysicState(PlayerSide player, const DuelMatchState& state);
 		void broadcastGameEvents() const;
 		void writeEventToStream(RakNet::BitStream& stream, MatchEvent e, bool switchSides ) const;
 		bool isGameStarted() { return mRulesSent[LEFT_PLAYER] && mRulesSent[RIGHT_PLAYER]; }
 
 		// process a single packet
 		void processPacket( const packet_ptr& packet );
+		void processDisconnect();
+
+		// replay recording. A recording error does not end the game, it is only no longer recorded.
+		void recordState();
+		void dropReplay(const char* reason);
+		// sends the next part of every requested replay
+		void sendReplayParts();
 
 		ThreadSafeRakServer* mServer;
 		PlayerID mLeftPlayer;
 		PlayerID mRightPlayer;
 		PlayerSide mSwitchedSide;
 
-		PacketQueue mPacketQueue;
-		std::mutex mPacketQueueMutex;
+		// filled by the network thread, emptied by the thread that steps this game
+		PacketRing mPacketQueue;
+		std::atomic<bool> mDisconnected;
 
 		const std::unique_ptr<DuelMatch> mMatch;
-		SpeedController mSpeedController;
+		const float mGameSpeed;
 		std::shared_ptr<InputSource> mLeftInput;
 		std::shared_ptr<InputSource> mRightInput;
 		unsigned mLeftLastTime;
 		unsigned mRightLastTime;
-		std::thread mGameThread;
-
-		const std::unique_ptr<ReplayRecorder> mRecorder;
 
-		bool mGameValid;
+		// ID_GAME_UPDATE is delta compressed against the last snapshot a client acknowledged.
+		// mAckedSnapshot is -1 as long as a client did not acknowledge any snapshot.
+		std::uint16_t mSnapshotSequence;
+		SnapshotHistory mSentSnapshots[MAX_PLAYERS];
+		int mAckedSnapshot[MAX_PLAYERS];
+
+		// null once recording has failed
+		std::unique_ptr<ReplayRecorder> mRecorder;
+		// file the replay is streamed to. empty if the replay is recorded in memory.
+		std::string mReplayFile;
+
+		// a replay that is sent to a client, one part per processPackets()
+		struct ReplayUpload
+		{
+			PlayerID target;
+			// the replay file, if it is streamed, otherwise the replay data
+			std::unique_ptr<std::ifstream> file;
+			std::vector<char> data;
+			std::size_t position;
+			std::size_t size;
+		};
+		std::vector<ReplayUpload> mReplayUploads;
+
+		std::atomic<bool> mGameValid;
 
 		bool mRulesSent[MAX_PLAYERS];
-		std::vector<char> mRulesString;
+		const std::shared_ptr<const ServerRules> mRules;
 };
 
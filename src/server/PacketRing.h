@@ -0,0 +1,79 @@
+/*=============================================================================
+Blobby Volley 2
+Copyright (C) 2023 Daniel Knobe (daniel-knobe@web.de)
+Copyright (C) 2023 Erik Schultheis (erik-schultheis@freenet.de)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+=============================================================================*/
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+#include "raknet/NetworkTypes.h"
+
+/*! \class PacketRing
+	\brief fixed size queue of packets for exactly one producer and one consumer thread.
+	\details The packets are moved into a ring buffer that is allocated once, so passing a packet
+			to a game neither allocates nor locks. Producer and consumer only synchronize through
+			the atomic read and write positions.
+			The consumer may change between threads, as long as the threads synchronize
+			otherwise (e.g. a game that is stepped by different workers of a GameScheduler).
+*/
+class PacketRing
+{
+	public:
+		/// creates a ring that holds up to \p capacity packets. \p capacity has to be a power of two.
+		explicit PacketRing(unsigned capacity) : mSlots(capacity), mMask(capacity - 1), mRead(0), mWrite(0)
+		{
+			// the positions are mapped to slots by masking, and wrap around at a power of two
+			assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+		}
+
+		/// moves \p packet into the ring. Must only be called by the producer.
+		/// \return false if the ring is full. \p packet is left untouched in that case.
+		bool push(packet_ptr& packet)
+		{
+			unsigned write = mWrite.load(std::memory_order_relaxed);
+			if(write - mRead.load(std::memory_order_acquire) == mSlots.size())
+				return false;
+
+			mSlots[write & mMask] = std::move(packet);
+			mWrite.store(write + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// moves the oldest packet into \p packet. Must only be called by the consumer.
+		/// \return false if the ring is empty.
+		bool pop(packet_ptr& packet)
+		{
+			unsigned read = mRead.load(std::memory_order_relaxed);
+			if(read == mWrite.load(std::memory_order_acquire))
+				return false;
+
+			packet = std::move(mSlots[read & mMask]);
+			mRead.store(read + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		std::vector<packet_ptr> mSlots;
+		const unsigned mMask;
+		// the positions only ever increase and wrap around together
+		std::atomic<unsigned> mRead;
+		std::atomic<unsigned> mWrite;
+};
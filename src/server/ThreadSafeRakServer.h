@@ -32,7 +32,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *  with the actual server.
  *
  *  As `Send`ing a packet is by far the most common operation, we provide a specialized convenience
- *  function.
+ *  function. It does not lock the mutex: RakPeer only copies the packet into a multi producer queue that
+ *  is drained by its network thread, so any number of game threads can send concurrently to each other
+ *  and to `access`. The target of a packet is only validated by the network thread when it drains the queue,
+ *  as the remote system list must not be read from other threads. The only exception are `Start` and `Disconnect`, which must not run while a packet is sent.
  */
 class ThreadSafeRakServer {
 public:
@@ -46,7 +49,7 @@ public:
 
 	void Send(const RakNet::BitStream& stream, PacketPriority priority, PacketReliability reliability, PlayerID target,
 			  bool broadcast=false) {
-		access([&](RakServer& server){ server.Send(&stream, priority, reliability, 0, target, broadcast); });
+		mServer->Send(&stream, priority, reliability, 0, target, broadcast);
 	}
 
 private:
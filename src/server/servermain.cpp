@@ -26,9 +26,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <cstdio>
 #include <ctime>
+#include <fstream>
 #include <future>
+#include <memory>
+#include <sstream>
 
 #include <cerrno>
+#include <cstring>
+#include <limits>
 
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
@@ -36,7 +41,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <SDL.h>
 
 #include "DedicatedServer.h"
+#include "MetricsEndpoint.h"
 #include "SpeedController.h"
+#include "Tracing.h"
 #include "FileSystem.h"
 #include "UserConfig.h"
 #include "Global.h"
@@ -70,18 +77,20 @@ void printHelp();
 void process_arguments(int argc, char** argv);
 void fork_to_background();
 void setup_physfs(char* argv0);
+std::string setup_replay_dir(const std::string& dir);
+void write_trace(const std::string& file);
 std::string statistics();
 
-// server workload statistics
-int SWLS_PacketCount = 0;
-int SWLS_Connections = 0;
-int SWLS_Games		 = 0;
-int SWLS_GameSteps	 = 0;
+// server workload statistics. Apart from the running time, they are updated by other threads
+std::atomic<int> SWLS_PacketCount(0);
+std::atomic<int> SWLS_Connections(0);
+std::atomic<int> SWLS_Games(0);
+std::atomic<int> SWLS_GameSteps(0);
 int SWLS_RunningTime = 0;
 
 const int UPDATE_FREQUENCY = 10;
 
-void main_loop(DedicatedServer& server);
+void main_loop(DedicatedServer& server, MetricsEndpoint* metrics);
 
 int main(int argc, char** argv)
 {
@@ -103,8 +112,12 @@ int main(int argc, char** argv)
 	setup_physfs(argv[0]);
 
 	int maxClients = 100;
+	int gameThreads = 0;
+	int metricsPort = 0;
 	std::string rulesFile = DEFAULT_RULES_FILE;
 	std::string gameSpeeds = "75";
+	std::string replayDir;
+	std::string traceFile;
 
 	UserConfig config;
 	try
@@ -113,10 +126,17 @@ int main(int argc, char** argv)
 		maxClients = config.getInteger("maximum_clients");
 		rulesFile  = config.getString("rules", DEFAULT_RULES_FILE);
 		gameSpeeds = config.getString("speeds", gameSpeeds);
-
-		// bring that value into a sane range
-		if(maxClients <= 0 || maxClients > 150)
-			maxClients = 150;
+		gameThreads = config.getInteger("game_threads", 0);
+		replayDir = config.getString("replay_dir", "");
+		metricsPort = config.getInteger("metrics_port", 0);
+		traceFile = config.getString("trace_file", "");
+
+		// bring those values into a sane range. The games no longer run on a thread each,
+		// so the client count is only limited by what raknet can handle.
+		if(maxClients <= 0 || maxClients > std::numeric_limits<unsigned short>::max())
+			maxClients = std::numeric_limits<unsigned short>::max();
+		if(gameThreads < 0)
+			gameThreads = 0;
 	}
 	catch (std::exception& e)
 	{
@@ -133,12 +153,34 @@ int main(int argc, char** argv)
 	std::vector<float> speed_vec;
 	std::transform(speed_vec_str.begin(), speed_vec_str.end(), std::back_inserter(speed_vec), [](const std::string& v ){ return std::stof(v);});
 
-	DedicatedServer server(myinfo, rule_vec, speed_vec, maxClients);
+	DedicatedServer server(myinfo, rule_vec, speed_vec, maxClients, false, gameThreads);
+	server.setReplayDir( setup_replay_dir(replayDir) );
+
+	std::unique_ptr<MetricsEndpoint> metrics;
+	if( metricsPort > 0 && metricsPort <= std::numeric_limits<unsigned short>::max() )
+	{
+		try
+		{
+			metrics.reset( new MetricsEndpoint(metricsPort) );
+			server.enableMetrics();
+			syslog(LOG_NOTICE, "Serving metrics on http://127.0.0.1:%d/metrics", metricsPort);
+		}
+		catch (std::exception& e)
+		{
+			syslog(LOG_ERR, "Could not open metrics port %d: %s", metricsPort, e.what());
+		}
+	}
+
+	if( !traceFile.empty() )
+	{
+		startTracing();
+		syslog(LOG_NOTICE, "Tracing game steps, the trace is written to %s", traceFile.c_str());
+	}
 
 	syslog(LOG_NOTICE, "Blobby Volley 2 dedicated server version %i.%i started", BLOBBY_VERSION_MAJOR, BLOBBY_VERSION_MINOR);
 
 	// main loop
-	auto serverthread = std::async(std::launch::async, [&](){main_loop(server);});
+	auto serverthread = std::async(std::launch::async, [&](){main_loop(server, metrics.get());});
 
 	while(true)
 	{
@@ -171,12 +213,25 @@ int main(int argc, char** argv)
 		{
 			std::cout << statistics() << std::endl;
 		}
+		else if ( cmd_vec[0] == "trace" )
+		{
+			if( traceFile.empty() )
+				std::cout << "tracing is disabled, set trace_file in server.xml to enable it" << std::endl;
+			else
+				write_trace(traceFile);
+		}
 
 	}
 
 	// We wait until the dedicated server is shut down
 	serverthread.wait();
 
+	if( isTracing() )
+	{
+		stopTracing();
+		write_trace(traceFile);
+	}
+
 	syslog(LOG_NOTICE, "Blobby Volley 2 dedicated server shutting down");
 	#ifndef WIN32
 	closelog();
@@ -188,8 +243,10 @@ int main(int argc, char** argv)
 // -----------------------------------------------------------------------------------------
 //    server main loop function
 // ------------------------------
-void main_loop( DedicatedServer& server)
+void main_loop( DedicatedServer& server, MetricsEndpoint* metrics)
 {
+	setTraceThreadName("main loop");
+
 	SpeedController scontroller( UPDATE_FREQUENCY );
 
 	while ( g_run_server )
@@ -208,6 +265,15 @@ void main_loop( DedicatedServer& server)
 		server.processPackets();
 		server.updateGames();
 
+		if( metrics )
+		{
+			metrics->serve([&](){
+				std::ostringstream stream;
+				server.writeMetrics(stream);
+				return stream.str();
+			});
+		}
+
 		scontroller.update();
 	}
 }
@@ -225,6 +291,7 @@ void printHelp()
 			  << "players:   print player list\n"
 			  << "games:     print game list\n"
 			  << "status:    print server status\n"
+			  << "trace:     write the recent game steps to the trace file\n"
 			  << "exit:      exits server (kills all running games!)" << std::endl;
 }
 
@@ -300,6 +367,32 @@ void setup_physfs(char* argv0)
 	fs.addToSearchPath(fs.join("data", "rules.zip"));
 }
 
+std::string setup_replay_dir(const std::string& dir)
+{
+	if(dir.empty())
+		return dir;
+
+	// the replay files are opened by their own path, so this does not touch the physfs write dir.
+	// check that we can actually create files there, instead of failing with every game.
+	std::string probe = dir + "/.blobby_replay_probe";
+	if( !std::ofstream(probe) )
+	{
+		syslog(LOG_ERR, "Could not use %s as replay directory, keeping replays in memory: %s", dir.c_str(), std::strerror(errno));
+		return "";
+	}
+	std::remove(probe.c_str());
+
+	return dir;
+}
+
+void write_trace(const std::string& file)
+{
+	std::ofstream stream(file);
+	writeChromeTrace(stream);
+	if( !stream )
+		syslog(LOG_ERR, "Could not write trace to %s", file.c_str());
+}
+
 std::string statistics()
 {
 	std::ostringstream oss;
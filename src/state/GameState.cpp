@@ -227,6 +227,16 @@ void GameState::setDefaultReplayName(const std::string& left, const std::string&
 }
 
 void GameState::saveReplay(ReplayRecorder& recorder)
+{
+	saveReplay([&](FileWrite& target){ recorder.save(target); });
+}
+
+void GameState::saveReplay(const char* data, std::size_t length)
+{
+	saveReplay([&](FileWrite& target){ target.write(data, length); });
+}
+
+void GameState::saveReplay(const std::function<void(FileWrite&)>& write)
 {
 	try
 	{
@@ -236,7 +246,7 @@ void GameState::saveReplay(ReplayRecorder& recorder)
 
 			FileWrite savetarget(repFileName);
 			/// \todo add a check whether we overwrite a file
-			recorder.save(savetarget);
+			write(savetarget);
 			mSaveReplay = false;
 		}
 	}
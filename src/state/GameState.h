@@ -26,6 +26,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <functional>
 #include <tuple>
+#include <cstddef>
+
+class FileWrite;
 
 /*! \class GameState
 	\brief base class for any game related state (Local, Network, Replay)
@@ -76,6 +79,9 @@ protected:
 	/// saves the replay to the desired file
 	void saveReplay(ReplayRecorder& recorder);
 
+	/// saves an already serialized replay, e.g. one received from the server, to the desired file
+	void saveReplay(const char* data, std::size_t length);
+
 
 	std::unique_ptr<DuelMatch> mMatch;
 
@@ -84,5 +90,8 @@ protected:
 
 	std::string mErrorMessage;
 private:
+	/// creates the replay file and lets \p write fill it. Any errors are reported through mErrorMessage.
+	void saveReplay(const std::function<void(FileWrite&)>& write);
+
 	std::string mFilename;
 };
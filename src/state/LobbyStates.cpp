@@ -148,7 +148,7 @@ void LobbyState::step_impl()
 
 					// find out which settings most closely resemble the local config
 					bool first_config = (mPreferedSpeed == -1u); // detect whether we set config for the first time
-					std::shared_ptr<IUserConfigReader> config = IUserConfigReader::createUserConfigReader("config.xml");
+					std::shared_ptr<const IUserConfigReader> config = IUserConfigReader::createUserConfigReader("config.xml");
 
 					// speed
 					int speed = config->getInteger("gamefps");
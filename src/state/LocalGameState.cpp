@@ -43,7 +43,7 @@ LocalGameState::LocalGameState()
 
 }
 
-std::shared_ptr<InputSource> LocalGameState::createInputSource( IUserConfigReader& config, PlayerSide side, const DuelMatch* match ) {
+std::shared_ptr<InputSource> LocalGameState::createInputSource( const IUserConfigReader& config, PlayerSide side, const DuelMatch* match ) {
 	std::string prefix = side == LEFT_PLAYER ? "left" : "right";
 	try
 	{
@@ -68,7 +68,7 @@ std::shared_ptr<InputSource> LocalGameState::createInputSource( IUserConfigReade
 
 void LocalGameState::init()
 {
-	std::shared_ptr<IUserConfigReader> config = IUserConfigReader::createUserConfigReader("config.xml");
+	std::shared_ptr<const IUserConfigReader> config = IUserConfigReader::createUserConfigReader("config.xml");
 	PlayerIdentity leftPlayer = config->loadPlayerIdentity(LEFT_PLAYER, false);
 	PlayerIdentity rightPlayer = config->loadPlayerIdentity(RIGHT_PLAYER, false);
 
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 /* includes */
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 
 #include <utility>
@@ -30,7 +31,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "raknet/PacketEnumerations.h"
 
 #include "NetworkState.h"
-#include "replays/ReplayRecorder.h"
 #include "DuelMatch.h"
 #include "IMGUI.h"
 #include "SoundManager.h"
@@ -38,7 +38,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "InputDevice.h"
 #include "UserConfig.h"
 #include "FileExceptions.h"
-#include "GenericIO.h"
 #include "FileRead.h"
 #include "FileWrite.h"
 #include "SpeedController.h"
@@ -53,17 +52,24 @@ NetworkGameState::NetworkGameState( std::shared_ptr<RakClient> client, int rule_
 	: GameState(new DuelMatch(true, DEFAULT_RULES_FILE, score_to_win))
 	, mNetworkState(WAITING_FOR_OPPONENT)
 	, mWaitingForReplay(false)
+	, mReceivingReplay(false)
 	, mClient(std::move(client))
 	, mWinningPlayer(NO_PLAYER)
+	, mHasSnapshot(false)
+	, mLastSnapshot(0)
 	, mSelectedChatmessage(0)
 	, mChatCursorPosition(0)
 	, mRulesChecksum(rule_checksum)
+	, mFirstPredictedFrame(0)
+	, mPredictedFrameCount(0)
+	, mServerStateTime(0)
+	, mHasServerState(false)
 {
 }
 
 void NetworkGameState::init()
 {
-	std::shared_ptr<IUserConfigReader> config = IUserConfigReader::createUserConfigReader("config.xml");
+	std::shared_ptr<const IUserConfigReader> config = IUserConfigReader::createUserConfigReader("config.xml");
 	mOwnSide = (PlayerSide)config->getInteger("network_side");
 	mUseRemoteColor = config->getBool("use_remote_color");
 	mLocalInput.reset(new LocalInputSource(getInputMgr().beginGame(mOwnSide)));
@@ -136,13 +142,34 @@ void NetworkGameState::step_impl()
 				unsigned timeBack;
 				stream.Read(timeBack);
 				CURRENT_NETWORK_LAG = SDL_GetTicks() - timeBack;
-				DuelMatchState ms;
-				/// \todo this is a performance nightmare: we create a new reader for every packet!
-				///			there should be a better way to do that
-				std::shared_ptr<GenericIn> in = createGenericReader(&stream);
-				in->generic<DuelMatchState> (ms);
-				// inject network data into game
-				mMatch->setState( ms );
+
+				std::uint16_t sequence;
+				unsigned char age;
+				stream.Read(sequence);
+				stream.Read(age);
+
+				// a delta against a snapshot we no longer know cannot be decoded.
+				// just wait for the next one, the server will notice from our acks.
+				const MatchSnapshot* base = nullptr;
+				if(age != 0)
+				{
+					base = mReceivedSnapshots.find(sequence - age);
+					if(!base)
+						break;
+				}
+
+				MatchSnapshot snapshot;
+				if(!readSnapshot(stream, snapshot, base, age))
+					break;
+
+				mReceivedSnapshots.store(sequence, snapshot);
+				mHasSnapshot = true;
+				mLastSnapshot = sequence;
+
+				// the state is injected into the game after all packets are processed
+				mServerState = snapshot.toState();
+				mServerStateTime = timeBack;
+				mHasServerState = true;
 				break;
 			}
 
@@ -161,7 +188,7 @@ void NetworkGameState::step_impl()
 					if( event == MatchEvent::BALL_HIT_BLOB )
 						stream.Read(intensity);
 					MatchEvent me{ MatchEvent::EventType(event), (PlayerSide)side, intensity };
-					mMatch->trigger( me );
+					mPendingEvents.push_back( me );
 				}
 				break;
 			}
@@ -308,22 +335,32 @@ void NetworkGameState::step_impl()
 			{
 				/// \todo we should take more action if server sends replay
 				///		even if not requested!
-				if(!mWaitingForReplay)
+				if(!mWaitingForReplay || packet->length < 2)
 					break;
 
-				RakNet::BitStream stream(packet->data, packet->length, false);
-				stream.IgnoreBytes(1);	// ID_REPLAY
+				// the server sends the replay file as it is, split into parts
+				unsigned char flags = packet->data[1];
+				const char* part = reinterpret_cast<const char*>(packet->data) + 2;
+				if(flags & REPLAY_PART_FIRST)
+				{
+					mReplayData.clear();
+					mReceivingReplay = true;
+				}
+				// parts of a replay we requested earlier and cancelled are ignored
+				if(!mReceivingReplay)
+					break;
 
-				// read stream into a dummy replay recorder
-				std::shared_ptr<GenericIn> reader = createGenericReader( &stream );
-				ReplayRecorder dummyRec;
-				dummyRec.receive( *reader );
-				// and save that
-				saveReplay(dummyRec);
+				mReplayData.insert(mReplayData.end(), part, part + packet->length - 2);
+				if(!(flags & REPLAY_PART_LAST))
+					break;
+
+				saveReplay(mReplayData.data(), mReplayData.size());
 
 				// mWaitingForReplay will be set to false even if replay could not be saved because
 				// the server won't send it again.
 				mWaitingForReplay = false;
+				mReceivingReplay = false;
+				mReplayData.clear();
 
 				break;
 			}
@@ -354,6 +391,14 @@ void NetworkGameState::step_impl()
 		}
 	}
 
+	// inject network data into game
+	if(mHasServerState)
+		applyServerState();
+
+	for(const auto& event : mPendingEvents)
+		mMatch->trigger( event );
+	mPendingEvents.clear();
+
 	// does this generate any problems if we pause at the exact moment an event is set ( i.e. the ball hit sound
 	// could be played in a loop)?
 	presentGame();
@@ -394,6 +439,7 @@ void NetworkGameState::step_impl()
 
 			mSaveReplay = false;
 			mWaitingForReplay = true;
+			mReceivingReplay = false;
 		}
 	}
 	else if (mWaitingForReplay)
@@ -404,6 +450,8 @@ void NetworkGameState::step_impl()
 		{
 			mSaveReplay = false;
 			mWaitingForReplay = false;
+			mReceivingReplay = false;
+			mReplayData.clear();
 			imgui.resetSelection();
 		}
 		imgui.doCursor();
@@ -468,10 +516,11 @@ void NetworkGameState::step_impl()
 		}
 		case PLAYING:
 		{
-			mMatch->step();
-
 			mLocalInput->updateInput();
 			PlayerInputAbs input = mLocalInput->getRealInput();
+			unsigned time = SDL_GetTicks();
+
+			predictStep(time, input);
 
 			if (is_exiting())
 			{
@@ -481,8 +530,10 @@ void NetworkGameState::step_impl()
 			}
 			RakNet::BitStream stream;
 			stream.Write((unsigned char)ID_INPUT_UPDATE);
-			stream.Write( SDL_GetTicks() );
+			stream.Write( time );
 			input.writeTo(stream);
+			stream.Write( mHasSnapshot );
+			stream.Write( mLastSnapshot );
 			mClient->Send(&stream, HIGH_PRIORITY, UNRELIABLE_SEQUENCED, 0);
 			break;
 		}
@@ -547,6 +598,96 @@ const char* NetworkGameState::getStateName() const
 	return "NetworkGameState";
 }
 
+namespace
+{
+	// checks whether a predicted state matches the server state closely enough
+	// that correcting it would not be visible.
+	bool isPredictionCorrect(const DuelMatchState& predicted, const DuelMatchState& server)
+	{
+		const float TOLERANCE = 0.5f;
+
+		auto close = [&](Vector2 a, Vector2 b) { return (a - b).lengthSQ() < TOLERANCE * TOLERANCE; };
+
+		for(auto side : {LEFT_PLAYER, RIGHT_PLAYER})
+		{
+			if(!close(predicted.getBlobPosition(side), server.getBlobPosition(side)) ||
+				!close(predicted.getBlobVelocity(side), server.getBlobVelocity(side)) ||
+				predicted.getScore(side) != server.getScore(side) ||
+				predicted.getHitcount(side) != server.getHitcount(side))
+				return false;
+		}
+
+		return close(predicted.getBallPosition(), server.getBallPosition()) &&
+				close(predicted.getBallVelocity(), server.getBallVelocity()) &&
+				predicted.getServingPlayer() == server.getServingPlayer() &&
+				predicted.getBallDown() == server.getBallDown() &&
+				predicted.getBallActive() == server.getBallActive();
+	}
+}
+
+void NetworkGameState::predictStep(unsigned time, const PlayerInputAbs& input)
+{
+	mMatch->getInputSource(mOwnSide)->setInput(input);
+	mMatch->step();
+
+	// if the server does not answer for a long time, we forget the oldest frames
+	if(mPredictedFrameCount == PREDICTION_BUFFER_SIZE)
+		dropPredictedFrames(1);
+
+	PredictedFrame& frame = mPredictedFrames[(mFirstPredictedFrame + mPredictedFrameCount) % PREDICTION_BUFFER_SIZE];
+	frame.time = time;
+	frame.input = input;
+	frame.state = mMatch->getState();
+	++mPredictedFrameCount;
+}
+
+void NetworkGameState::applyServerState()
+{
+	mHasServerState = false;
+
+	// find the frame whose input the server used last. search from the newest frame,
+	// so we get the right one even if two frames got the same timestamp.
+	unsigned confirmed = mPredictedFrameCount;
+	for(unsigned i = mPredictedFrameCount; i > 0; --i)
+	{
+		if(mPredictedFrames[(mFirstPredictedFrame + i - 1) % PREDICTION_BUFFER_SIZE].time == mServerStateTime)
+		{
+			confirmed = i - 1;
+			break;
+		}
+	}
+
+	// outside of the game, or if we do not know this frame, just use the server state
+	if(mNetworkState != PLAYING || confirmed == mPredictedFrameCount)
+	{
+		mMatch->setState(mServerState);
+		dropPredictedFrames(mPredictedFrameCount);
+		return;
+	}
+
+	bool correct = isPredictionCorrect(mPredictedFrames[(mFirstPredictedFrame + confirmed) % PREDICTION_BUFFER_SIZE].state,
+										mServerState);
+	dropPredictedFrames(confirmed + 1);
+	if(correct)
+		return;
+
+	// rewind to the server state and simulate all frames it did not know of again
+	mMatch->setState(mServerState);
+	for(unsigned i = 0; i < mPredictedFrameCount; ++i)
+	{
+		PredictedFrame& frame = mPredictedFrames[(mFirstPredictedFrame + i) % PREDICTION_BUFFER_SIZE];
+		mMatch->getInputSource(mOwnSide)->setInput(frame.input);
+		mMatch->step();
+		frame.state = mMatch->getState();
+	}
+}
+
+void NetworkGameState::dropPredictedFrames(unsigned count)
+{
+	mFirstPredictedFrame = (mFirstPredictedFrame + count) % PREDICTION_BUFFER_SIZE;
+	mPredictedFrameCount -= count;
+}
+
 // definition of syslog for client hosted games
 void syslog(int pri, const char* format, ...)
 {
@@ -554,8 +695,8 @@ void syslog(int pri, const char* format, ...)
 }
 
 // debug counters
-int SWLS_PacketCount;
-int SWLS_Connections;
-int SWLS_Games;
-int SWLS_GameSteps;
+std::atomic<int> SWLS_PacketCount;
+std::atomic<int> SWLS_Connections;
+std::atomic<int> SWLS_Games;
+std::atomic<int> SWLS_GameSteps;
 int SWLS_ServerEntered;
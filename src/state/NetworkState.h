@@ -23,9 +23,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "GameState.h"
 #include "NetworkMessage.h"
 #include "PlayerIdentity.h"
+#include "NetworkSnapshot.h"
 
 #include <vector>
 #include <memory>
+#include <array>
+
+#include "DuelMatchState.h"
+#include "MatchEvents.h"
 
 class RakClient;
 class RakServer;
@@ -73,11 +78,19 @@ private:
 	std::unique_ptr<InputSource> mLocalInput;
 
 	bool mWaitingForReplay;
+	// the parts of the replay received so far. mReceivingReplay is set by the first part.
+	std::vector<char> mReplayData;
+	bool mReceivingReplay;
 
 	std::shared_ptr<RakClient> mClient;
 	PlayerSide mOwnSide;
 	PlayerSide mWinningPlayer;
 
+	// received game states, used as base for the delta compressed ID_GAME_UPDATE
+	SnapshotHistory mReceivedSnapshots;
+	bool mHasSnapshot;
+	std::uint16_t mLastSnapshot;
+
 	// Chat Vars
 	std::vector<std::string> mChatlog;
 	std::vector<bool > mChatOrigin;
@@ -87,4 +100,34 @@ private:
 
 	// somewhat ugly: we need to keep the rules checksum until we actually initialize the state
 	int mRulesChecksum;
+
+	// client side prediction
+	/// steps the local match with our own input, and remembers input and result
+	void predictStep(unsigned time, const PlayerInputAbs& input);
+	/// rewinds the local match to the last state received from the server, and
+	/// simulates the inputs the server has not seen yet on top of it
+	void applyServerState();
+	/// drops all predicted frames up to (and including) \p count
+	void dropPredictedFrames(unsigned count);
+
+	struct PredictedFrame
+	{
+		unsigned time;			// timestamp we sent with the input, echoed by the server
+		PlayerInputAbs input;
+		DuelMatchState state;	// state we predicted after applying input
+	};
+
+	// ring buffer of frames the server has not confirmed yet, oldest at mFirstPredictedFrame
+	static const unsigned PREDICTION_BUFFER_SIZE = 128;
+	std::array<PredictedFrame, PREDICTION_BUFFER_SIZE> mPredictedFrames;
+	unsigned mFirstPredictedFrame;
+	unsigned mPredictedFrameCount;
+
+	// latest authoritative state, applied after all packets of a frame are processed
+	DuelMatchState mServerState;
+	unsigned mServerStateTime;
+	bool mHasServerState;
+
+	// events have to be triggered after rewinding, otherwise the re-simulated steps would consume them
+	std::vector<MatchEvent> mPendingEvents;
 };
@@ -64,7 +64,8 @@ void ReplayState::loadReplay(const std::string& file)
 		FileWrite rulesFile("rules/"+TEMP_RULES_NAME);
 		rulesFile.write(mReplayPlayer->getRules());
 		rulesFile.close();
-		mMatch.reset(new DuelMatch(false, TEMP_RULES_NAME));
+		mMatch.reset(new DuelMatch(false, TEMP_RULES_NAME, 0, mReplayPlayer->createClock()));
+		mReplayPlayer->buildSavePointIndex(TEMP_RULES_NAME);
 
 		mMatch->setPlayers(PlayerIdentity{mReplayPlayer->getPlayerName(LEFT_PLAYER)},
 		                   PlayerIdentity{mReplayPlayer->getPlayerName(RIGHT_PLAYER)});
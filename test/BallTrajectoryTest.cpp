@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+
+#include "BallTrajectory.h"
+#include "PhysicWorld.h"
+
+namespace
+{
+	void checkAgainstWorld(BallTrajectory& trajectory, Vector2 position, Vector2 velocity, int steps)
+	{
+		PhysicWorld world;
+		world.setBallPosition(position);
+		world.setBallVelocity(velocity);
+		for(int i = 0; i <= steps; ++i)
+		{
+			const auto& state = trajectory.at(i);
+			BOOST_REQUIRE( state.position == world.getBallPosition() );
+			BOOST_REQUIRE( state.velocity == world.getBallVelocity() );
+			world.step(PlayerInput(), PlayerInput(), false, true);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( ball_trajectory )
+
+BOOST_AUTO_TEST_CASE( matches_physic_world )
+{
+	BallTrajectory trajectory;
+	// bounces off the wall, the net and the ground
+	trajectory.setStart(Vector2(200, 150), Vector2(-9, -4));
+	checkAgainstWorld(trajectory, Vector2(200, 150), Vector2(-9, -4), 500);
+}
+
+BOOST_AUTO_TEST_CASE( reuses_steps )
+{
+	BallTrajectory trajectory;
+	trajectory.setStart(Vector2(300, 200), Vector2(5, -2));
+	auto later = trajectory.at(40);
+	BOOST_CHECK_EQUAL( trajectory.getCachedSteps(), 41 );
+
+	// advancing along the trajectory keeps the steps after the new start
+	auto next = trajectory.at(10);
+	trajectory.setStart(next.position, next.velocity);
+	BOOST_CHECK_EQUAL( trajectory.getCachedSteps(), 31 );
+	BOOST_CHECK_EQUAL( trajectory.find(later.position, later.velocity), 30 );
+	BOOST_CHECK_EQUAL( trajectory.find(Vector2(300, 200), Vector2(5, -2)), -1 );
+	checkAgainstWorld(trajectory, next.position, next.velocity, 100);
+
+	// anything else starts a new trajectory
+	trajectory.setStart(Vector2(300, 200), Vector2(5, -3));
+	BOOST_CHECK_EQUAL( trajectory.getCachedSteps(), 1 );
+	BOOST_CHECK_EQUAL( trajectory.find(later.position, later.velocity), -1 );
+}
+
+BOOST_AUTO_TEST_CASE( limits_cached_steps )
+{
+	BallTrajectory trajectory;
+	trajectory.setStart(Vector2(300, 200), Vector2(5, -2));
+
+	// bots choose the number of steps, the cache stops at MAX_STEPS
+	const auto& last = trajectory.at(BallTrajectory::MAX_STEPS - 1);
+	BOOST_CHECK_EQUAL( &trajectory.at(1 << 30), &last );
+	BOOST_CHECK_EQUAL( trajectory.getCachedSteps(), BallTrajectory::MAX_STEPS );
+	BOOST_CHECK( trajectory.at(-5).position == Vector2(300, 200) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+/*! \class BenchmarkState
+	\brief controls the iterations of a single benchmark
+	\details A benchmark runs the code it wants to measure in a loop like
+			\code
+			while(state.run())
+			{
+				...
+			}
+			\endcode
+			The loop is repeated until the minimum measuring time is reached. Setup code
+			before the loop is not measured. Besides the time, the number of heap
+			allocations made inside the loop are counted.
+*/
+class BenchmarkState
+{
+	public:
+		explicit BenchmarkState(std::chrono::nanoseconds min_time);
+
+		/// returns true as long as more iterations are needed
+		bool run();
+
+		unsigned long getIterations() const { return mIterations; }
+		std::chrono::nanoseconds getElapsed() const { return mElapsed; }
+		unsigned long getAllocations() const { return mAllocations; }
+
+	private:
+		std::chrono::nanoseconds mMinTime;
+		std::chrono::steady_clock::time_point mStart;
+		std::chrono::nanoseconds mElapsed;
+
+		bool mStarted;
+		unsigned long mIterations;
+		unsigned long mBatchSize;
+		unsigned long mRemaining;
+		unsigned long mAllocationsAtStart;
+		unsigned long mAllocations;
+};
+
+typedef std::function<void(BenchmarkState&)> BenchmarkFunction;
+
+/// adds a benchmark to the list of benchmarks that are run by blobbybench. Use the
+/// BENCHMARK macro instead of calling this directly.
+int registerBenchmark(const char* name, BenchmarkFunction function);
+
+/// number of heap allocations made through operator new so far
+unsigned long getAllocationCount();
+
+/// prevents the compiler from optimizing away the computation of \p value
+template<class T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static const volatile void* sink;
+	sink = &value;
+#endif
+}
+
+/*! \def BENCHMARK
+	\brief defines and registers a benchmark
+	\code
+	BENCHMARK( name_of_benchmark )
+	{
+		while(state.run())
+		{
+			...
+		}
+	}
+	\endcode
+*/
+#define BENCHMARK( NAME )															\
+	static void benchmark_##NAME(BenchmarkState& state);								\
+	static const int benchmark_##NAME##_registered = registerBenchmark(#NAME, &benchmark_##NAME);	\
+	static void benchmark_##NAME(BenchmarkState& state)
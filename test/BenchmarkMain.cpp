@@ -0,0 +1,242 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// -------------------------------------------------------------------------------------------------
+//							allocation counting
+// -------------------------------------------------------------------------------------------------
+
+static std::atomic<unsigned long> allocation_count(0);
+
+void* operator new(std::size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if(void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+unsigned long getAllocationCount()
+{
+	return allocation_count.load(std::memory_order_relaxed);
+}
+
+// -------------------------------------------------------------------------------------------------
+//							BenchmarkState
+// -------------------------------------------------------------------------------------------------
+
+BenchmarkState::BenchmarkState(std::chrono::nanoseconds min_time) :
+	mMinTime(min_time),
+	mElapsed(0),
+	mStarted(false),
+	mIterations(0),
+	mBatchSize(1),
+	mRemaining(0),
+	mAllocationsAtStart(0),
+	mAllocations(0)
+{
+}
+
+bool BenchmarkState::run()
+{
+	if(mRemaining > 0)
+	{
+		--mRemaining;
+		++mIterations;
+		return true;
+	}
+
+	// we only look at the clock once per batch, and double the batch size every time,
+	// so that the time measurement does not dominate short benchmarks.
+	auto now = std::chrono::steady_clock::now();
+	if(!mStarted)
+	{
+		mStarted = true;
+		mAllocationsAtStart = getAllocationCount();
+		mStart = std::chrono::steady_clock::now();
+	}
+	else if(now - mStart >= mMinTime)
+	{
+		mElapsed = now - mStart;
+		mAllocations = getAllocationCount() - mAllocationsAtStart;
+		return false;
+	}
+	else
+	{
+		mBatchSize *= 2;
+	}
+
+	mRemaining = mBatchSize - 1;
+	++mIterations;
+	return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+//							registry and main
+// -------------------------------------------------------------------------------------------------
+
+namespace
+{
+	struct RegisteredBenchmark
+	{
+		const char* name;
+		BenchmarkFunction function;
+	};
+
+	std::vector<RegisteredBenchmark>& getBenchmarks()
+	{
+		static std::vector<RegisteredBenchmark> benchmarks;
+		return benchmarks;
+	}
+
+	struct Result
+	{
+		std::string name;
+		unsigned long iterations;
+		double ns_per_iteration;
+		double allocations_per_iteration;
+	};
+
+	void printUsage(const char* program)
+	{
+		std::cout << "usage: " << program << " [--json] [--min-time SECONDS] [FILTER]\n"
+				  << "  runs all benchmarks whose name contains FILTER\n";
+	}
+}
+
+int registerBenchmark(const char* name, BenchmarkFunction function)
+{
+	getBenchmarks().push_back( RegisteredBenchmark{name, std::move(function)} );
+	return getBenchmarks().size();
+}
+
+int main(int argc, char** argv)
+{
+	bool json = false;
+	double min_time = 0.5;
+	std::string filter;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(std::strcmp(argv[i], "--json") == 0)
+		{
+			json = true;
+		}
+		else if(std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+		{
+			min_time = std::atof(argv[++i]);
+		}
+		else if(argv[i][0] == '-')
+		{
+			printUsage(argv[0]);
+			return 1;
+		}
+		else
+		{
+			filter = argv[i];
+		}
+	}
+
+	// messages printed by the benchmarked code would corrupt the json document. This includes
+	// printf and lua's print, which write straight to stdout, so the file descriptor itself
+	// is sent to stderr while the benchmarks run.
+	int output = -1;
+	if(json)
+	{
+		std::cout.flush();
+		std::fflush(stdout);
+		output = dup(STDOUT_FILENO);
+		dup2(STDERR_FILENO, STDOUT_FILENO);
+	}
+
+	std::vector<Result> results;
+	for(const auto& benchmark : getBenchmarks())
+	{
+		if(std::string(benchmark.name).find(filter) == std::string::npos)
+			continue;
+
+		BenchmarkState state(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(min_time)));
+		benchmark.function(state);
+
+		double iterations = state.getIterations() ? state.getIterations() : 1;
+		Result result{benchmark.name, state.getIterations(),
+					state.getElapsed().count() / iterations,
+					state.getAllocations() / iterations};
+		results.push_back(result);
+
+		if(!json)
+		{
+			std::cout << std::left << std::setw(48) << result.name << std::right
+					  << std::setw(12) << result.iterations << " iterations  "
+					  << std::setw(12) << std::fixed << std::setprecision(1) << result.ns_per_iteration << " ns  "
+					  << std::setw(8) << std::setprecision(2) << result.allocations_per_iteration << " allocs\n";
+		}
+	}
+
+	if(json)
+	{
+		std::cout.flush();
+		std::fflush(stdout);
+		dup2(output, STDOUT_FILENO);
+		close(output);
+
+		char date[32];
+		std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+		std::cout << "{\n  \"context\": {\"date\": \"" << date << "\", \"min_time\": " << min_time
+#ifdef NDEBUG
+				  << ", \"build\": \"release\"},\n";
+#else
+				  << ", \"build\": \"debug\"},\n";
+#endif
+		std::cout << "  \"benchmarks\": [\n";
+		for(std::size_t i = 0; i < results.size(); ++i)
+		{
+			const auto& r = results[i];
+			std::cout << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+					  << ", \"ns_per_iteration\": " << r.ns_per_iteration
+					  << ", \"allocations_per_iteration\": " << r.allocations_per_iteration << "}"
+					  << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		std::cout << "  ]\n}\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,94 @@
+#include "Benchmark.h"
+
+#include "raknet/BitStream.h"
+
+namespace
+{
+	const int BLOCK_SIZE = 64;
+
+	// roughly the content of a game packet: id, timestamp, flags, positions and counters
+	void writeMixed(RakNet::BitStream& stream, unsigned int value)
+	{
+		stream.Write((unsigned char)77);
+		stream.Write(value);
+		stream.Write(true);
+		stream.Write(false);
+		stream.Write(true);
+		for(int i = 0; i < 6; ++i)
+			stream.Write(float(value + i) * 0.5f);
+		stream.WriteCompressed(value & 0xFF);
+		stream.WriteCompressed(int(value & 0xFFF) - 2048);
+	}
+
+	unsigned int readMixed(RakNet::BitStream& stream)
+	{
+		unsigned char id;
+		unsigned int value;
+		bool flags[3];
+		float position;
+		unsigned int small;
+		int negative;
+		stream.Read(id);
+		stream.Read(value);
+		for(auto& flag : flags)
+			stream.Read(flag);
+		for(int i = 0; i < 6; ++i)
+			stream.Read(position);
+		stream.ReadCompressed(small);
+		stream.ReadCompressed(negative);
+		return value + small + negative + (position > 0) + id;
+	}
+}
+
+BENCHMARK( bitstream_write_mixed )
+{
+	RakNet::BitStream stream;
+	unsigned int value = 0;
+	while(state.run())
+	{
+		stream.Reset();
+		writeMixed(stream, ++value);
+		doNotOptimize(stream.GetNumberOfBitsUsed());
+	}
+}
+
+BENCHMARK( bitstream_read_mixed )
+{
+	RakNet::BitStream stream;
+	writeMixed(stream, 12345);
+	while(state.run())
+	{
+		stream.ResetReadPointer();
+		doNotOptimize(readMixed(stream));
+	}
+}
+
+// a block of bytes that does not start at a byte boundary, e.g. a name after a flag
+BENCHMARK( bitstream_write_unaligned_bytes )
+{
+	char block[BLOCK_SIZE] = {};
+	RakNet::BitStream stream;
+	while(state.run())
+	{
+		stream.Reset();
+		stream.Write(true);
+		stream.Write(block, BLOCK_SIZE);
+		doNotOptimize(stream.GetNumberOfBitsUsed());
+	}
+}
+
+BENCHMARK( bitstream_read_unaligned_bytes )
+{
+	char block[BLOCK_SIZE] = {};
+	RakNet::BitStream stream;
+	stream.Write(true);
+	stream.Write(block, BLOCK_SIZE);
+	while(state.run())
+	{
+		bool flag;
+		stream.ResetReadPointer();
+		stream.Read(flag);
+		stream.Read(block, BLOCK_SIZE);
+		doNotOptimize(block[0]);
+	}
+}
@@ -0,0 +1,104 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "BlobColorizer.h"
+
+namespace
+{
+	// the per pixel formula RenderManagerSDL used before the colorization was vectorized
+	std::uint32_t referenceColorize(std::uint32_t pixel, Color color)
+	{
+		int r = pixel & 0xFF;
+		int g = (pixel >> 8) & 0xFF;
+		int b = (pixel >> 16) & 0xFF;
+		if( !(r | g | b) )
+			return pixel;
+
+		int fak = r * 5 - 4 * 256 - 138;
+		auto clamp = [fak](int value) {
+			if (fak > 0)
+				value += fak;
+			return std::max(1, std::min(value, 255));
+		};
+
+		std::uint32_t rr = clamp((r * color.r) >> 8);
+		std::uint32_t rg = clamp((g * color.g) >> 8);
+		std::uint32_t rb = clamp((b * color.b) >> 8);
+		return (pixel & 0xFF000000) | rb << 16 | rg << 8 | rr;
+	}
+
+	std::vector<std::uint32_t> randomPixels(std::size_t count)
+	{
+		std::mt19937 gen(42);
+		std::vector<std::uint32_t> pixels(count);
+		for(auto& p : pixels)
+		{
+			p = gen();
+			// plenty of color keyed and bright pixels
+			if(p % 7 == 0)
+				p &= 0xFF000000;
+			else if(p % 5 == 0)
+				p |= 0xF0;
+		}
+		return pixels;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( blob_colorizer )
+
+BOOST_AUTO_TEST_CASE( matches_reference )
+{
+	const Color colors[] = {Color(0, 0, 0), Color(255, 255, 255), Color(255, 0, 0), Color(0, 120, 250), Color(17, 200, 99)};
+	// counts that are no multiple of the vector width
+	for(std::size_t count : {0u, 1u, 3u, 4u, 7u, 75u, 1001u})
+	{
+		auto source = randomPixels(count);
+		for(const auto& color : colors)
+		{
+			std::vector<std::uint32_t> target(count);
+			colorizeBlobPixels(source.data(), target.data(), count, color);
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				BOOST_REQUIRE_EQUAL( target[i], referenceColorize(source[i], color) );
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( all_channel_values )
+{
+	std::vector<std::uint32_t> source;
+	for(std::uint32_t v = 0; v < 256; ++v)
+	{
+		source.push_back(0x80000000 | v << 16 | (255 - v) << 8 | v);
+		source.push_back(0xFF000000 | v);
+	}
+
+	for(int c = 0; c < 256; c += 15)
+	{
+		Color color(c, 255 - c, c / 2);
+		std::vector<std::uint32_t> target(source.size());
+		colorizeBlobPixels(source.data(), target.data(), source.size(), color);
+		for(std::size_t i = 0; i < source.size(); ++i)
+		{
+			BOOST_REQUIRE_EQUAL( target[i], referenceColorize(source[i], color) );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( in_place )
+{
+	auto pixels = randomPixels(30);
+	auto expected = pixels;
+	for(auto& p : expected)
+		p = referenceColorize(p, Color(10, 20, 30));
+
+	colorizeBlobPixels(pixels.data(), pixels.data(), pixels.size(), Color(10, 20, 30));
+	BOOST_CHECK( pixels == expected );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
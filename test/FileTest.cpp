@@ -7,6 +7,9 @@
 #include <iostream>
 #include <cstring>
 #include <physfs.h>
+#include <boost/crc.hpp>
+#include "lua.hpp"
+#include "UserConfig.h"
 
 #define TEST_EXECUTION_PATH "./test/"
 
@@ -414,4 +417,99 @@ BOOST_AUTO_TEST_CASE( int_test )
 	PHYSFS_delete("cycle.tmp");
 }
 
+BOOST_AUTO_TEST_CASE( lua_script_test )
+{
+	init_Physfs();
+
+	auto runScript = [](const char* source)
+	{
+		FileWrite writer("cycle.lua");
+		writer.write( std::string(source) );
+		writer.close();
+
+		lua_State* state = luaL_newstate();
+		BOOST_REQUIRE_EQUAL( FileRead::readLuaScript("cycle", state), 0 );
+		BOOST_REQUIRE_EQUAL( lua_pcall(state, 0, 0, 0), 0 );
+		lua_getglobal(state, "value");
+		double value = lua_tonumber(state, -1);
+		lua_close(state);
+		return value;
+	};
+
+	// the second load comes from the cache, the third one has to notice the changed file
+	BOOST_CHECK_EQUAL( runScript("value = 1 + 2"), 3 );
+	BOOST_CHECK_EQUAL( runScript("value = 1 + 2"), 3 );
+	BOOST_CHECK_EQUAL( runScript("value = 5 * 2"), 10 );
+
+	PHYSFS_delete("cycle.lua");
+}
+
+BOOST_AUTO_TEST_CASE( checksum_test )
+{
+	init_Physfs();
+
+	auto writeAndChecksum = [](const std::string& content, uint32_t start)
+	{
+		FileWrite writer("checksum.tmp");
+		writer.write( content );
+		writer.close();
+
+		FileRead reader("checksum.tmp");
+		return reader.calcChecksum(start);
+	};
+
+	// larger than the read buffer, so it is processed in several chunks
+	std::string content;
+	for(int i = 0; i < 100000; ++i)
+		content += char(i * 7);
+
+	boost::crc_32_type expected;
+	expected.process_bytes( content.data(), content.size() );
+	BOOST_CHECK_EQUAL( writeAndChecksum(content, 0), expected.checksum() );
+	// served from the cache
+	BOOST_CHECK_EQUAL( writeAndChecksum(content, 0), expected.checksum() );
+
+	boost::crc_32_type tail;
+	tail.process_bytes( content.data() + 10, content.size() - 10 );
+	BOOST_CHECK_EQUAL( writeAndChecksum(content, 10), tail.checksum() );
+
+	// a changed file has to be read again
+	content.resize(500);
+	boost::crc_32_type shortened;
+	shortened.process_bytes( content.data(), content.size() );
+	BOOST_CHECK_EQUAL( writeAndChecksum(content, 0), shortened.checksum() );
+
+	PHYSFS_delete("checksum.tmp");
+}
+
+BOOST_AUTO_TEST_CASE( user_config_test )
+{
+	init_Physfs();
+
+	UserConfig config;
+	config.setInteger("scoretowin", 15);
+	config.setString("name", "blobby");
+	config.saveFile("cycle_config.xml");
+
+	auto reader = IUserConfigReader::createUserConfigReader("cycle_config.xml");
+	BOOST_CHECK_EQUAL( reader->getInteger("scoretowin"), 15 );
+	BOOST_CHECK_EQUAL( reader->getString("name"), "blobby" );
+	// repeated reads share the parsed snapshot
+	BOOST_CHECK_EQUAL( IUserConfigReader::createUserConfigReader("cycle_config.xml"), reader );
+
+	// saving replaces the snapshot, but does not change the one still in use
+	config.setInteger("scoretowin", 25);
+	config.saveFile("cycle_config.xml");
+	BOOST_CHECK_EQUAL( IUserConfigReader::createUserConfigReader("cycle_config.xml")->getInteger("scoretowin"), 25 );
+	BOOST_CHECK_EQUAL( reader->getInteger("scoretowin"), 15 );
+
+	// a fresh load of the written file sees the same values
+	UserConfig loaded;
+	BOOST_REQUIRE( loaded.loadFile("cycle_config.xml") );
+	BOOST_CHECK_EQUAL( loaded.getInteger("scoretowin"), 25 );
+	BOOST_CHECK_EQUAL( loaded.getString("name"), "blobby" );
+
+	PHYSFS_delete("cycle_config.xml");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
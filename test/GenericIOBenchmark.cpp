@@ -0,0 +1,120 @@
+#include "Benchmark.h"
+
+#include "GenericIO.h"
+#include "DuelMatchState.h"
+#include "NetworkSnapshot.h"
+#include "raknet/BitStream.h"
+
+namespace
+{
+	DuelMatchState makeState(float t)
+	{
+		DuelMatchState state;
+		state.worldState.blobPosition[LEFT_PLAYER] = Vector2(200 + t, 400);
+		state.worldState.blobPosition[RIGHT_PLAYER] = Vector2(600, 400 - t);
+		state.worldState.blobVelocity[LEFT_PLAYER] = Vector2(4.5, 0);
+		state.worldState.blobVelocity[RIGHT_PLAYER] = Vector2(0, -14.5);
+		state.worldState.blobState[LEFT_PLAYER] = 0;
+		state.worldState.blobState[RIGHT_PLAYER] = 2.5;
+		state.worldState.ballPosition = Vector2(300 + 3 * t, 200 - 2 * t);
+		state.worldState.ballVelocity = Vector2(3, -2 + 0.25f * t);
+		state.worldState.ballRotation = 1.5;
+		state.worldState.ballAngularVelocity = -0.1;
+		state.logicState.leftScore = 3;
+		state.logicState.rightScore = 14;
+		state.logicState.hitCount[LEFT_PLAYER] = 2;
+		state.logicState.hitCount[RIGHT_PLAYER] = 0;
+		state.logicState.servingPlayer = NO_PLAYER;
+		state.logicState.squish[LEFT_PLAYER] = 0;
+		state.logicState.squish[RIGHT_PLAYER] = 5;
+		state.logicState.squishWall = 0;
+		state.logicState.squishGround = 0;
+		state.logicState.isGameRunning = true;
+		state.logicState.isBallValid = true;
+		return state;
+	}
+}
+
+// the way ID_GAME_UPDATE used to be written: a new writer for every packet
+BENCHMARK( genericio_write_state_factory )
+{
+	DuelMatchState ms = makeState(0);
+	while(state.run())
+	{
+		RakNet::BitStream stream;
+		auto out = createGenericWriter(&stream);
+		out->generic<DuelMatchState>(ms);
+		doNotOptimize(stream.GetNumberOfBitsUsed());
+	}
+}
+
+BENCHMARK( genericio_write_state_stack )
+{
+	DuelMatchState ms = makeState(0);
+	while(state.run())
+	{
+		RakNet::BitStream stream;
+		NetworkOut out(&stream);
+		out.generic<DuelMatchState>(ms);
+		doNotOptimize(stream.GetNumberOfBitsUsed());
+	}
+}
+
+BENCHMARK( genericio_read_state_factory )
+{
+	RakNet::BitStream source;
+	NetworkOut(&source).generic<DuelMatchState>(makeState(0));
+
+	while(state.run())
+	{
+		RakNet::BitStream stream(source.GetData(), source.GetNumberOfBytesUsed(), false);
+		DuelMatchState ms;
+		auto in = createGenericReader(&stream);
+		in->generic<DuelMatchState>(ms);
+		doNotOptimize(ms);
+	}
+}
+
+BENCHMARK( genericio_read_state_stack )
+{
+	RakNet::BitStream source;
+	NetworkOut(&source).generic<DuelMatchState>(makeState(0));
+
+	while(state.run())
+	{
+		RakNet::BitStream stream(source.GetData(), source.GetNumberOfBytesUsed(), false);
+		DuelMatchState ms;
+		NetworkIn in(&stream);
+		in.generic<DuelMatchState>(ms);
+		doNotOptimize(ms);
+	}
+}
+
+// the way ID_GAME_UPDATE is written now
+BENCHMARK( snapshot_write_delta )
+{
+	MatchSnapshot base = MatchSnapshot::fromState(makeState(0));
+	DuelMatchState ms = makeState(2);
+	while(state.run())
+	{
+		RakNet::BitStream stream;
+		writeSnapshot(stream, MatchSnapshot::fromState(ms), &base, 2);
+		doNotOptimize(stream.GetNumberOfBitsUsed());
+	}
+}
+
+BENCHMARK( snapshot_read_delta )
+{
+	MatchSnapshot base = MatchSnapshot::fromState(makeState(0));
+	RakNet::BitStream source;
+	writeSnapshot(source, MatchSnapshot::fromState(makeState(2)), &base, 2);
+
+	while(state.run())
+	{
+		RakNet::BitStream stream(source.GetData(), source.GetNumberOfBytesUsed(), false);
+		MatchSnapshot snapshot;
+		readSnapshot(stream, snapshot, &base, 2);
+		DuelMatchState ms = snapshot.toState();
+		doNotOptimize(ms);
+	}
+}
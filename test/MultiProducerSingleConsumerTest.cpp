@@ -0,0 +1,81 @@
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <vector>
+
+#include "raknet/MultiProducerSingleConsumer.h"
+
+BOOST_AUTO_TEST_SUITE( multi_producer_single_consumer )
+
+BOOST_AUTO_TEST_CASE( fifo_order )
+{
+	BasicDataStructures::MultiProducerSingleConsumer<int> queue;
+	int value = -1;
+	BOOST_CHECK( !queue.Pop(value) );
+
+	for(int i = 0; i < 10; ++i)
+		queue.Push(i);
+
+	for(int i = 0; i < 5; ++i)
+	{
+		BOOST_REQUIRE( queue.Pop(value) );
+		BOOST_CHECK_EQUAL( value, i );
+	}
+
+	queue.Push(10);
+	for(int i = 5; i <= 10; ++i)
+	{
+		BOOST_REQUIRE( queue.Pop(value) );
+		BOOST_CHECK_EQUAL( value, i );
+	}
+	BOOST_CHECK( !queue.Pop(value) );
+
+	queue.Push(11);
+	queue.Clear();
+	BOOST_CHECK( !queue.Pop(value) );
+}
+
+BOOST_AUTO_TEST_CASE( concurrent_producers )
+{
+	// each value encodes its producer and a sequence number, so we can check that
+	// nothing is lost and that every producer's values arrive in order
+	const int PRODUCERS = 4;
+	const int COUNT = 100000;
+	BasicDataStructures::MultiProducerSingleConsumer<int> queue;
+
+	std::vector<std::thread> producers;
+	for(int p = 0; p < PRODUCERS; ++p)
+	{
+		producers.emplace_back([&queue, p]()
+		{
+			for(int i = 0; i < COUNT; ++i)
+				queue.Push(p * COUNT + i);
+		});
+	}
+
+	std::vector<int> next(PRODUCERS, 0);
+	int received = 0;
+	bool ordered = true;
+	while(received < PRODUCERS * COUNT)
+	{
+		int value;
+		if(!queue.Pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		int producer = value / COUNT;
+		ordered = ordered && value % COUNT == next[producer];
+		next[producer] = value % COUNT + 1;
+		++received;
+	}
+
+	for(auto& producer : producers)
+		producer.join();
+
+	BOOST_CHECK( ordered );
+	int value;
+	BOOST_CHECK( !queue.Pop(value) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
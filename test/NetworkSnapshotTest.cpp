@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+
+#include "NetworkSnapshot.h"
+#include "raknet/BitStream.h"
+
+namespace
+{
+	DuelMatchState makeState(float t)
+	{
+		DuelMatchState state;
+		state.worldState.blobPosition[LEFT_PLAYER] = Vector2(200 + t, 400);
+		state.worldState.blobPosition[RIGHT_PLAYER] = Vector2(600, 400 - t);
+		state.worldState.blobVelocity[LEFT_PLAYER] = Vector2(4.5, 0);
+		state.worldState.blobVelocity[RIGHT_PLAYER] = Vector2(0, -14.5);
+		state.worldState.blobState[LEFT_PLAYER] = 0;
+		state.worldState.blobState[RIGHT_PLAYER] = 2.5;
+		state.worldState.ballPosition = Vector2(300 + 3 * t, 200 - 2 * t);
+		state.worldState.ballVelocity = Vector2(3, -2);
+		state.worldState.ballRotation = 1.5;
+		state.worldState.ballAngularVelocity = -0.1;
+		state.logicState.leftScore = 3;
+		state.logicState.rightScore = 14;
+		state.logicState.hitCount[LEFT_PLAYER] = 2;
+		state.logicState.hitCount[RIGHT_PLAYER] = 0;
+		state.logicState.servingPlayer = NO_PLAYER;
+		state.logicState.squish[LEFT_PLAYER] = 0;
+		state.logicState.squish[RIGHT_PLAYER] = 5;
+		state.logicState.squishWall = 0;
+		state.logicState.squishGround = 0;
+		state.logicState.isGameRunning = true;
+		state.logicState.isBallValid = true;
+		state.playerInput[LEFT_PLAYER] = PlayerInput(true, false, true);
+		state.playerInput[RIGHT_PLAYER] = PlayerInput(false, false, false);
+		return state;
+	}
+
+	MatchSnapshot roundtrip(const MatchSnapshot& snapshot, const MatchSnapshot* base, unsigned age, int& bits)
+	{
+		RakNet::BitStream stream;
+		writeSnapshot(stream, snapshot, base, age);
+		bits = stream.GetNumberOfBitsUsed();
+
+		MatchSnapshot result;
+		BOOST_REQUIRE( readSnapshot(stream, result, base, age) );
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( NetworkSnapshotTest )
+
+BOOST_AUTO_TEST_CASE( snapshot_quantization )
+{
+	DuelMatchState state = makeState(0);
+	MatchSnapshot snapshot = MatchSnapshot::fromState(state);
+	DuelMatchState restored = snapshot.toState();
+
+	BOOST_CHECK_CLOSE( restored.getBallPosition().x, state.getBallPosition().x, 0.01 );
+	BOOST_CHECK_CLOSE( restored.getBlobVelocity(RIGHT_PLAYER).y, state.getBlobVelocity(RIGHT_PLAYER).y, 0.01 );
+	BOOST_CHECK_EQUAL( restored.getScore(RIGHT_PLAYER), 14 );
+	BOOST_CHECK_EQUAL( restored.getServingPlayer(), NO_PLAYER );
+	BOOST_CHECK( restored.playerInput[LEFT_PLAYER] == state.playerInput[LEFT_PLAYER] );
+
+	// quantizing a restored state does not change anything
+	BOOST_CHECK( MatchSnapshot::fromState(restored) == snapshot );
+}
+
+BOOST_AUTO_TEST_CASE( snapshot_keyframe )
+{
+	MatchSnapshot snapshot = MatchSnapshot::fromState(makeState(0));
+	int bits;
+	BOOST_CHECK( roundtrip(snapshot, nullptr, 0, bits) == snapshot );
+}
+
+BOOST_AUTO_TEST_CASE( snapshot_delta )
+{
+	MatchSnapshot base = MatchSnapshot::fromState(makeState(0));
+	MatchSnapshot current = MatchSnapshot::fromState(makeState(3));
+	current.fields[MatchSnapshot::LEFT_SCORE] += 1;
+
+	int full_bits;
+	int delta_bits;
+	BOOST_CHECK( roundtrip(current, nullptr, 0, full_bits) == current );
+	BOOST_CHECK( roundtrip(current, &base, 3, delta_bits) == current );
+	BOOST_CHECK_LT( delta_bits, full_bits / 2 );
+
+	// unchanged state costs one bit per field
+	BOOST_CHECK( roundtrip(base, &base, 0, delta_bits) == base );
+	BOOST_CHECK_EQUAL( delta_bits, (int)MatchSnapshot::FIELD_COUNT );
+}
+
+BOOST_AUTO_TEST_CASE( snapshot_history )
+{
+	SnapshotHistory history;
+	MatchSnapshot snapshot = MatchSnapshot::fromState(makeState(0));
+
+	BOOST_CHECK( history.find(5) == nullptr );
+	history.store(5, snapshot);
+	BOOST_REQUIRE( history.find(5) != nullptr );
+	BOOST_CHECK( *history.find(5) == snapshot );
+
+	// overwritten by a newer snapshot
+	history.store(5 + SnapshotHistory::SIZE, snapshot);
+	BOOST_CHECK( history.find(5) == nullptr );
+	BOOST_CHECK( history.find(5 + SnapshotHistory::SIZE) != nullptr );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,86 @@
+#include "Benchmark.h"
+
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "raknet/PacketDataPool.h"
+#include "raknet/PacketPool.h"
+#include "server/PacketRing.h"
+
+// an input packet of a client travels from the network thread to the game that handles it.
+// these benchmarks compare the way this was done before, with a heap allocated payload, a shared_ptr
+// and a locked list, to the pooled payload that is moved through the ring of the game.
+namespace
+{
+	const unsigned INPUT_PACKET_SIZE = 11;
+
+	void fillPacket(Packet* packet, unsigned char* data)
+	{
+		std::memset(data, 0, INPUT_PACKET_SIZE);
+		packet->data = data;
+		packet->length = INPUT_PACKET_SIZE;
+		packet->bitSize = INPUT_PACKET_SIZE * 8;
+	}
+}
+
+BENCHMARK( packet_payload_new_delete )
+{
+	while(state.run())
+	{
+		char* data = new char[INPUT_PACKET_SIZE];
+		doNotOptimize(data);
+		delete[] data;
+	}
+}
+
+BENCHMARK( packet_payload_pool )
+{
+	while(state.run())
+	{
+		char* data = PacketDataPool::Allocate(INPUT_PACKET_SIZE);
+		doNotOptimize(data);
+		PacketDataPool::Release(data);
+	}
+}
+
+BENCHMARK( packet_handoff_shared_list )
+{
+	std::list<std::shared_ptr<Packet>> queue;
+	std::mutex mutex;
+	while(state.run())
+	{
+		Packet* raw = new Packet;
+		fillPacket(raw, new unsigned char[INPUT_PACKET_SIZE]);
+		std::shared_ptr<Packet> packet(raw, [](Packet* p){ delete[] p->data; delete p; });
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queue.push_back(packet);
+		}
+		packet.reset();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			packet = queue.front();
+			queue.pop_front();
+		}
+		doNotOptimize(packet->data[0]);
+	}
+}
+
+BENCHMARK( packet_handoff_pool_ring )
+{
+	PacketPool pool;
+	PacketRing ring(256);
+	while(state.run())
+	{
+		Packet* raw = pool.GetPointer();
+		fillPacket(raw, (unsigned char*)PacketDataPool::Allocate(INPUT_PACKET_SIZE));
+		packet_ptr packet(raw, PacketDeleter(&pool));
+		ring.push(packet);
+
+		ring.pop(packet);
+		doNotOptimize(packet->data[0]);
+	}
+}
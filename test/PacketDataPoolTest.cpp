@@ -0,0 +1,73 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <set>
+#include <thread>
+
+#include "raknet/PacketDataPool.h"
+#include "raknet/MultiProducerSingleConsumer.h"
+
+BOOST_AUTO_TEST_SUITE( packet_data_pool )
+
+BOOST_AUTO_TEST_CASE( allocate_sizes )
+{
+	// all size classes and a buffer that is too large for any of them
+	const unsigned sizes[] = {0, 1, 32, 33, 128, 500, 2048, 2049, 100000};
+	for(unsigned size : sizes)
+	{
+		char* data = PacketDataPool::Allocate(size);
+		BOOST_REQUIRE( data );
+		std::memset(data, 0xAB, size);
+		PacketDataPool::Release(data);
+	}
+	PacketDataPool::Release(nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( reuse_buffers )
+{
+	// a released buffer is handed out again
+	char* first = PacketDataPool::Allocate(20);
+	PacketDataPool::Release(first);
+	char* second = PacketDataPool::Allocate(20);
+	BOOST_CHECK_EQUAL( (void*)first, (void*)second );
+	PacketDataPool::Release(second);
+}
+
+BOOST_AUTO_TEST_CASE( release_on_other_thread )
+{
+	// one thread allocates, another one releases, as the network thread and the game threads do
+	const int COUNT = 100000;
+	BasicDataStructures::MultiProducerSingleConsumer<char*> queue;
+
+	std::thread producer([&queue]()
+	{
+		for(int i = 0; i < COUNT; ++i)
+		{
+			char* data = PacketDataPool::Allocate(i % 600);
+			std::memset(data, i & 0xFF, i % 600);
+			queue.Push(data);
+		}
+	});
+
+	int received = 0;
+	bool intact = true;
+	while(received < COUNT)
+	{
+		char* data;
+		if(!queue.Pop(data))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		int size = received % 600;
+		for(int j = 0; j < size; ++j)
+			intact = intact && data[j] == char(received & 0xFF);
+		PacketDataPool::Release(data);
+		++received;
+	}
+	producer.join();
+
+	BOOST_CHECK( intact );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
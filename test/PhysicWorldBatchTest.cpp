@@ -0,0 +1,132 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "PhysicWorld.h"
+#include "PhysicWorldBatch.h"
+
+namespace
+{
+	bool sameBits(float a, float b)
+	{
+		return std::memcmp(&a, &b, sizeof(float)) == 0;
+	}
+
+	bool sameBits(Vector2 a, Vector2 b)
+	{
+		return sameBits(a.x, b.x) && sameBits(a.y, b.y);
+	}
+
+	void checkState(const PhysicState& expected, const PhysicState& actual)
+	{
+		for(int player = LEFT_PLAYER; player < MAX_PLAYERS; ++player)
+		{
+			BOOST_REQUIRE( sameBits(expected.blobPosition[player], actual.blobPosition[player]) );
+			BOOST_REQUIRE( sameBits(expected.blobVelocity[player], actual.blobVelocity[player]) );
+			BOOST_REQUIRE( sameBits(expected.blobState[player], actual.blobState[player]) );
+		}
+		BOOST_REQUIRE( sameBits(expected.ballPosition, actual.ballPosition) );
+		BOOST_REQUIRE( sameBits(expected.ballVelocity, actual.ballVelocity) );
+		BOOST_REQUIRE( sameBits(expected.ballRotation, actual.ballRotation) );
+		BOOST_REQUIRE( sameBits(expected.ballAngularVelocity, actual.ballAngularVelocity) );
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( physic_world_batch )
+
+BOOST_AUTO_TEST_CASE( initial_state )
+{
+	PhysicWorldBatch batch(3);
+	PhysicWorld world;
+	BOOST_CHECK_EQUAL( batch.size(), 3u );
+	for(std::size_t match = 0; match < batch.size(); ++match)
+	{
+		checkState(world.getState(), batch.getState(match));
+	}
+}
+
+// random inputs and frequently thrown balls, so every collision and event happens many times
+BOOST_AUTO_TEST_CASE( matches_physic_world )
+{
+	// no multiple of the vector width
+	const std::size_t count = 13;
+	std::mt19937 gen(7);
+	std::uniform_real_distribution<float> position_x(0, 800);
+	std::uniform_real_distribution<float> position_y(100, 450);
+	std::uniform_real_distribution<float> velocity(-15, 15);
+
+	PhysicWorldBatch batch(count);
+	std::vector<PhysicWorld> worlds(count);
+	std::vector<std::vector<MatchEvent>> world_events(count);
+	for(std::size_t match = 0; match < count; ++match)
+	{
+		worlds[match].setEventCallback([&world_events, match](const MatchEvent& event) { world_events[match].push_back(event); });
+	}
+
+	std::vector<bool> ball_valid(count, true);
+	std::vector<bool> game_running(count, true);
+	std::vector<PlayerInput> left(count);
+	std::vector<PlayerInput> right(count);
+	int event_counts[MatchEvent::BALL_HIT_NET_TOP + 1] = {0};
+
+	for(int step = 0; step < 20000; ++step)
+	{
+		for(std::size_t match = 0; match < count; ++match)
+		{
+			if(gen() % 150 == 0)
+			{
+				PhysicState state = worlds[match].getState();
+				state.ballPosition = Vector2(position_x(gen), position_y(gen));
+				state.ballVelocity = Vector2(velocity(gen), velocity(gen));
+				worlds[match].setState(state);
+				batch.setState(match, state);
+			}
+			if(gen() % 500 == 0)
+			{
+				ball_valid[match] = !ball_valid[match];
+				batch.setBallValid(match, ball_valid[match]);
+			}
+			if(gen() % 500 == 0)
+			{
+				game_running[match] = !game_running[match];
+				batch.setGameRunning(match, game_running[match]);
+			}
+
+			unsigned bits = gen();
+			left[match] = PlayerInput(bits & 1, bits & 2, (bits & 12) == 12);
+			right[match] = PlayerInput(bits & 16, bits & 32, (bits & 192) == 192);
+
+			world_events[match].clear();
+			worlds[match].step(left[match], right[match], ball_valid[match], game_running[match]);
+		}
+
+		batch.step(left, right);
+
+		std::size_t next_event = 0;
+		const auto& events = batch.getEvents();
+		for(std::size_t match = 0; match < count; ++match)
+		{
+			checkState(worlds[match].getState(), batch.getState(match));
+			for(const auto& expected : world_events[match])
+			{
+				BOOST_REQUIRE( next_event < events.size() );
+				const auto& actual = events[next_event++];
+				BOOST_REQUIRE_EQUAL( actual.match, match );
+				BOOST_REQUIRE_EQUAL( actual.event.event, expected.event );
+				BOOST_REQUIRE_EQUAL( actual.event.side, expected.side );
+				BOOST_REQUIRE( sameBits(actual.event.intensity, expected.intensity) );
+				++event_counts[expected.event];
+			}
+		}
+		BOOST_REQUIRE_EQUAL( next_event, events.size() );
+	}
+
+	for(int event = MatchEvent::BALL_HIT_BLOB; event <= MatchEvent::BALL_HIT_NET_TOP; ++event)
+	{
+		BOOST_CHECK( event_counts[event] > 0 );
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,213 @@
+#include "Benchmark.h"
+
+#include <memory>
+#include <vector>
+
+#include "lua.hpp"
+
+#include "DuelMatch.h"
+#include "DuelMatchState.h"
+#include "FileSystem.h"
+#include "IScriptableComponent.h"
+#include "InputSource.h"
+#include "PhysicWorld.h"
+#include "PhysicWorldBatch.h"
+#include "SimulationClock.h"
+
+namespace
+{
+	// the rules and api scripts are read from the data directory of the source tree
+	void setupFileSystem()
+	{
+		static FileSystem fs("blobbybench");
+		static bool initialised = false;
+		if(!initialised)
+		{
+			fs.addToSearchPath(BENCHMARK_DATA_DIR);
+			initialised = true;
+		}
+	}
+
+	// moves back and forth and jumps regularly, so the blobs hit the ball from time to time
+	PlayerInput patternInput(int step, int offset)
+	{
+		int phase = (step + offset) % 120;
+		return PlayerInput(phase < 50, phase >= 60 && phase < 110, phase % 40 < 15);
+	}
+
+	class PatternInputSource : public InputSource
+	{
+		public:
+			explicit PatternInputSource(int offset) : mOffset(offset)
+			{
+			}
+
+		private:
+			PlayerInputAbs getNextInput() override
+			{
+				PlayerInput input = patternInput(mStep++, mOffset);
+				return PlayerInputAbs(input.left, input.right, input.up);
+			}
+
+			int mStep = 0;
+			int mOffset;
+	};
+
+	// gives access to the simulation functions of the bot api
+	class SimulationScript : public IScriptableComponent
+	{
+		public:
+			SimulationScript()
+			{
+				acquireState("benchmark", [this]()
+				{
+					setGameConstants();
+					setGameFunctions();
+				});
+			}
+
+			void setBall(Vector2 position, Vector2 velocity)
+			{
+				DuelMatchState state;
+				state.worldState.ballPosition = position;
+				state.worldState.ballVelocity = velocity;
+				setMatchState(state);
+			}
+
+			/// calls simulate_until with the ball given in lua coordinates and returns the number of steps
+			int simulateUntil(float x, float y, float vx, float vy, const char* axis, float coordinate)
+			{
+				lua_getglobal(mState, "simulate_until");
+				lua_pushnumber(mState, x);
+				lua_pushnumber(mState, y);
+				lua_pushnumber(mState, vx);
+				lua_pushnumber(mState, vy);
+				lua_pushstring(mState, axis);
+				lua_pushnumber(mState, coordinate);
+				lua_call(mState, 6, 5);
+				int steps = lua_tointeger(mState, -5);
+				lua_pop(mState, 5);
+				return steps;
+			}
+	};
+}
+
+// a flying ball that bounces off the walls and the net, while the blobs do not move
+BENCHMARK( physicworld_step_ball )
+{
+	PhysicWorld world;
+	int step = 0;
+	while(state.run())
+	{
+		if(step++ % 300 == 0)
+		{
+			world.setBallPosition(Vector2(200, 150));
+			world.setBallVelocity(Vector2(-9, -4));
+		}
+		world.step(PlayerInput(), PlayerInput(), true, true);
+		doNotOptimize(world.getBallPosition());
+	}
+}
+
+// moving and jumping blobs, which collide with the ball
+BENCHMARK( physicworld_step_rally )
+{
+	PhysicWorld world;
+	int step = 0;
+	while(state.run())
+	{
+		if(step % 300 == 0)
+		{
+			world.setBallPosition(Vector2(200, 150));
+			world.setBallVelocity(Vector2(3, -4));
+		}
+		world.step(patternInput(step, 0), patternInput(step, 37), true, true);
+		++step;
+		doNotOptimize(world.getBallPosition());
+	}
+}
+
+// 64 rallies, stepped one world after the other
+BENCHMARK( physicworld_step_rally_64 )
+{
+	std::vector<PhysicWorld> worlds(64);
+	int step = 0;
+	while(state.run())
+	{
+		for(std::size_t match = 0; match < worlds.size(); ++match)
+		{
+			auto& world = worlds[match];
+			if(step % 300 == 0)
+			{
+				world.setBallPosition(Vector2(200, 150));
+				world.setBallVelocity(Vector2(3, -4));
+			}
+			world.step(patternInput(step, match), patternInput(step, match + 37), true, true);
+		}
+		++step;
+		doNotOptimize(worlds.back().getBallPosition());
+	}
+}
+
+// the same 64 rallies, stepped together
+BENCHMARK( physicworldbatch_step_rally_64 )
+{
+	PhysicWorldBatch batch(64);
+	std::vector<PlayerInput> left(batch.size());
+	std::vector<PlayerInput> right(batch.size());
+	int step = 0;
+	while(state.run())
+	{
+		for(std::size_t match = 0; match < batch.size(); ++match)
+		{
+			if(step % 300 == 0)
+			{
+				PhysicState physic = batch.getState(match);
+				physic.ballPosition = Vector2(200, 150);
+				physic.ballVelocity = Vector2(3, -4);
+				batch.setState(match, physic);
+			}
+			left[match] = patternInput(step, match);
+			right[match] = patternInput(step, match + 37);
+		}
+		batch.step(left, right);
+		++step;
+		doNotOptimize(batch.getBallPosition(batch.size() - 1));
+	}
+}
+
+// the query bots make every frame: where does the current ball reach a given height
+BENCHMARK( simulate_until_cached )
+{
+	SimulationScript script;
+	script.setBall(Vector2(200, 150), Vector2(6, -4));
+	while(state.run())
+	{
+		doNotOptimize(script.simulateUntil(200, 600 - 150, 6, 4, "y", 250));
+	}
+}
+
+// a query for a ball that is not on the predicted trajectory, which has to be simulated step by step
+BENCHMARK( simulate_until_uncached )
+{
+	SimulationScript script;
+	script.setBall(Vector2(200, 150), Vector2(6, -4));
+	float velocity = 0;
+	while(state.run())
+	{
+		velocity = velocity > 4 ? 0 : velocity + 0.125f;
+		doNotOptimize(script.simulateUntil(100, 600 - 150, 2 + velocity, 4, "y", 250));
+	}
+}
+
+BENCHMARK( duelmatch_step_default_rules )
+{
+	setupFileSystem();
+	DuelMatch match(false, "default.lua", 1000, SimulationClock::createFixedStepClock(75.f));
+	match.setInputSources(std::make_shared<PatternInputSource>(0), std::make_shared<PatternInputSource>(37));
+	while(state.run())
+	{
+		match.step();
+		doNotOptimize(match.getBallPosition());
+	}
+}
@@ -0,0 +1,67 @@
+#include "Benchmark.h"
+
+#include <vector>
+
+#include "raknet/PlayerIDTable.h"
+
+// every incoming datagram has to find the remote system of its sender. RakPeer used to do this by
+// scanning the remote system list, these benchmarks compare that with the PlayerIDTable lookup
+// for different numbers of connected peers.
+namespace
+{
+	std::vector<PlayerID> makePlayers(unsigned count)
+	{
+		std::vector<PlayerID> players(count);
+		for(unsigned i = 0; i < count; ++i)
+		{
+			// clients behind the same address only differ by port
+			players[i].binaryAddress = 0x0100007F + (i / 4 << 24);
+			players[i].port = 2000 + i % 4;
+		}
+		return players;
+	}
+
+	void benchmarkLinearScan(BenchmarkState& state, unsigned count)
+	{
+		auto players = makePlayers(count);
+		unsigned next = 0;
+		while(state.run())
+		{
+			const PlayerID& target = players[next];
+			int found = -1;
+			for(unsigned i = 0; i < count; ++i)
+			{
+				if(players[i] == target)
+				{
+					found = i;
+					break;
+				}
+			}
+			doNotOptimize(found);
+			next = (next + 7) % count;
+		}
+	}
+
+	void benchmarkTable(BenchmarkState& state, unsigned count)
+	{
+		auto players = makePlayers(count);
+		PlayerIDTable table;
+		table.Reset(count);
+		for(unsigned i = 0; i < count; ++i)
+			table.Insert(players[i], i);
+
+		unsigned next = 0;
+		while(state.run())
+		{
+			doNotOptimize(table.Find(players[next]));
+			next = (next + 7) % count;
+		}
+	}
+}
+
+BENCHMARK( raknet_peer_lookup_scan_8 )		{ benchmarkLinearScan(state, 8); }
+BENCHMARK( raknet_peer_lookup_scan_150 )	{ benchmarkLinearScan(state, 150); }
+BENCHMARK( raknet_peer_lookup_scan_1000 )	{ benchmarkLinearScan(state, 1000); }
+BENCHMARK( raknet_peer_lookup_table_8 )		{ benchmarkTable(state, 8); }
+BENCHMARK( raknet_peer_lookup_table_150 )	{ benchmarkTable(state, 150); }
+BENCHMARK( raknet_peer_lookup_table_1000 )	{ benchmarkTable(state, 1000); }
@@ -0,0 +1,97 @@
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <random>
+
+#include "raknet/PlayerIDTable.h"
+
+namespace
+{
+	PlayerID makePlayerID(unsigned address, unsigned short port)
+	{
+		PlayerID id;
+		id.binaryAddress = address;
+		id.port = port;
+		return id;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( player_id_table )
+
+BOOST_AUTO_TEST_CASE( insert_find_remove )
+{
+	PlayerIDTable table;
+	BOOST_CHECK_EQUAL( table.Find(makePlayerID(1, 1)), -1 );
+
+	table.Reset(4);
+	table.Insert(makePlayerID(1, 1000), 0);
+	table.Insert(makePlayerID(1, 1001), 1);
+	table.Insert(makePlayerID(2, 1000), 2);
+
+	BOOST_CHECK_EQUAL( table.Find(makePlayerID(1, 1000)), 0 );
+	BOOST_CHECK_EQUAL( table.Find(makePlayerID(1, 1001)), 1 );
+	BOOST_CHECK_EQUAL( table.Find(makePlayerID(2, 1000)), 2 );
+	BOOST_CHECK_EQUAL( table.Find(makePlayerID(2, 1001)), -1 );
+	BOOST_CHECK_EQUAL( table.Find(UNASSIGNED_PLAYER_ID), -1 );
+
+	table.Remove(makePlayerID(1, 1001));
+	BOOST_CHECK_EQUAL( table.Find(makePlayerID(1, 1001)), -1 );
+	BOOST_CHECK_EQUAL( table.Find(makePlayerID(1, 1000)), 0 );
+	BOOST_CHECK_EQUAL( table.Find(makePlayerID(2, 1000)), 2 );
+
+	table.Clear();
+	BOOST_CHECK_EQUAL( table.Find(makePlayerID(1, 1000)), -1 );
+}
+
+// connects and disconnects players at random, and compares with a std::map.
+// removal has to keep all colliding entries reachable.
+BOOST_AUTO_TEST_CASE( random_connections )
+{
+	const unsigned short SLOTS = 150;
+	PlayerIDTable table;
+	table.Reset(SLOTS);
+
+	std::map<PlayerID, unsigned short> reference;
+	std::vector<bool> used(SLOTS, false);
+	std::mt19937 rng(42);
+
+	for(int i = 0; i < 20000; ++i)
+	{
+		// few addresses and ports, so that we get collisions
+		PlayerID id = makePlayerID(rng() % 64, 1000 + rng() % 8);
+		auto found = reference.find(id);
+		if(found != reference.end())
+		{
+			table.Remove(id);
+			used[found->second] = false;
+			reference.erase(found);
+		}
+		else if(reference.size() < SLOTS)
+		{
+			unsigned short slot = 0;
+			while(used[slot])
+				++slot;
+			used[slot] = true;
+			reference[id] = slot;
+			table.Insert(id, slot);
+		}
+
+		if(i % 100 == 0)
+		{
+			for(const auto& entry : reference)
+				BOOST_REQUIRE_EQUAL( table.Find(entry.first), entry.second );
+		}
+	}
+
+	for(unsigned address = 0; address < 64; ++address)
+	{
+		for(unsigned short port = 1000; port < 1008; ++port)
+		{
+			PlayerID id = makePlayerID(address, port);
+			auto found = reference.find(id);
+			BOOST_CHECK_EQUAL( table.Find(id), found == reference.end() ? -1 : found->second );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+#include "Benchmark.h"
+
+#include <stdexcept>
+
+#include "raknet/GetTime.h"
+#include "raknet/MTUSize.h"
+#include "raknet/NetworkTypes.h"
+#include "raknet/PacketDataPool.h"
+#include "raknet/ReliabilityLayer.h"
+#include "raknet/SocketLayer.h"
+
+// two reliability layers that talk to each other through udp sockets on the loopback interface,
+// like the server and a client do. Every iteration sends one message from one side to the other,
+// receives it there and passes the acknowledgements back.
+namespace
+{
+	const unsigned INPUT_PACKET_SIZE = 11;
+
+	struct Endpoint
+	{
+		Endpoint()
+		{
+			socket = SocketLayer::Instance()->CreateBoundSocket(0, false, "127.0.0.1");
+			if(socket == INVALID_SOCKET)
+				throw std::runtime_error("could not open benchmark socket");
+
+			sockaddr_in address;
+#ifdef _WIN32
+			int length = sizeof(address);
+#else
+			socklen_t length = sizeof(address);
+#endif
+			getsockname(socket, (sockaddr*)&address, &length);
+			id.binaryAddress = address.sin_addr.s_addr;
+			id.port = ntohs(address.sin_port);
+		}
+
+		~Endpoint()
+		{
+#ifdef _WIN32
+			closesocket(socket);
+#else
+			close(socket);
+#endif
+		}
+
+		/// hands all datagrams that arrived at the socket to the reliability layer
+		void deliver()
+		{
+			char buffer[MAXIMUM_MTU_SIZE];
+			int length;
+			while((length = recvfrom(socket, buffer, sizeof(buffer), 0, nullptr, nullptr)) > 0)
+				layer.HandleSocketReceiveFromConnectedPlayer(buffer, length);
+		}
+
+		/// returns the number of messages that are ready
+		int receive()
+		{
+			int count = 0;
+			char* data;
+			while(layer.Receive(&data) > 0)
+			{
+				PacketDataPool::Release(data);
+				++count;
+			}
+			return count;
+		}
+
+		SOCKET socket;
+		PlayerID id;
+		ReliabilityLayer layer;
+	};
+
+	void roundTrip(BenchmarkState& state, PacketReliability reliability)
+	{
+		Endpoint sender;
+		Endpoint receiver;
+		char payload[INPUT_PACKET_SIZE] = {};
+		unsigned long received = 0;
+
+		while(state.run())
+		{
+			unsigned int time = RakNet::GetTime();
+			sender.layer.Send(payload, INPUT_PACKET_SIZE * 8, HIGH_PRIORITY, reliability, 0, true, DEFAULT_MTU_SIZE, time);
+			sender.layer.Update(sender.socket, receiver.id, DEFAULT_MTU_SIZE, time);
+
+			receiver.deliver();
+			received += receiver.receive();
+			receiver.layer.Update(receiver.socket, sender.id, DEFAULT_MTU_SIZE, time);
+
+			sender.deliver();
+		}
+		doNotOptimize(received);
+	}
+}
+
+BENCHMARK( reliability_layer_reliable_ordered )
+{
+	roundTrip(state, RELIABLE_ORDERED);
+}
+
+BENCHMARK( reliability_layer_unreliable_sequenced )
+{
+	roundTrip(state, UNRELIABLE_SEQUENCED);
+}
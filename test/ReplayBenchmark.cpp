@@ -0,0 +1,96 @@
+#include "Benchmark.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base64.h"
+#include "DuelMatchState.h"
+#include "replays/ReplayRecorder.h"
+
+namespace
+{
+	// five minutes at the default game speed
+	const int GAME_STEPS = 5 * 60 * 75;
+
+	DuelMatchState makeState(int step)
+	{
+		DuelMatchState state;
+		state.worldState.ballPosition = Vector2(200 + step % 400, 300);
+		state.worldState.ballVelocity = Vector2(3, -2);
+		state.logicState.leftScore = step / 1500;
+		state.logicState.rightScore = step / 2000;
+		state.playerInput[LEFT_PLAYER] = PlayerInput(step % 3 == 0, step % 5 == 0, step % 7 == 0);
+		state.playerInput[RIGHT_PLAYER] = PlayerInput(step % 2 == 0, false, step % 11 == 0);
+		return state;
+	}
+
+	std::unique_ptr<ReplayRecorder> createRecorder()
+	{
+		std::unique_ptr<ReplayRecorder> recorder(new ReplayRecorder());
+		recorder->setPlayerNames("left player", "right player");
+		recorder->setGameSpeed(75);
+		recorder->setGameRulesScript("-- rules\n");
+		return recorder;
+	}
+
+	std::unique_ptr<ReplayRecorder> recordGame()
+	{
+		auto recorder = createRecorder();
+		for(int step = 0; step < GAME_STEPS; ++step)
+			recorder->record(makeState(step));
+		recorder->finalize(15, 11);
+		return recorder;
+	}
+}
+
+BENCHMARK( replay_record )
+{
+	std::vector<DuelMatchState> states;
+	for(int step = 0; step < GAME_STEPS; ++step)
+		states.push_back(makeState(step));
+
+	// a new recorder for every game, so memory use stays like in a real game
+	auto recorder = createRecorder();
+	int step = 0;
+	while(state.run())
+	{
+		if(step == GAME_STEPS)
+		{
+			recorder = createRecorder();
+			step = 0;
+		}
+		recorder->record(states[step++]);
+	}
+}
+
+BENCHMARK( replay_save )
+{
+	auto recorder = recordGame();
+	while(state.run())
+	{
+		std::vector<char> data = recorder->getReplayData();
+		doNotOptimize(data.size());
+	}
+}
+
+// the xml replay format stores the input base64 encoded
+BENCHMARK( base64_encode )
+{
+	std::vector<char> data = recordGame()->getReplayData();
+	while(state.run())
+	{
+		std::string encoded = encode(data, 80);
+		doNotOptimize(encoded.size());
+	}
+}
+
+BENCHMARK( base64_decode )
+{
+	std::string encoded = encode(recordGame()->getReplayData(), 80);
+	while(state.run())
+	{
+		std::vector<uint8_t> decoded = decode(encoded);
+		doNotOptimize(decoded.size());
+	}
+}
@@ -0,0 +1,201 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FileSystem.h"
+#include "FileWrite.h"
+#include "InputSource.h"
+#include "DuelMatchState.h"
+#include "replays/IReplayLoader.h"
+#include "replays/ReplayRecorder.h"
+
+#define TEST_EXECUTION_PATH "./test"
+
+namespace
+{
+	// long enough for several savepoints and a score change
+	const int GAME_STEPS = 2000;
+
+	struct FSFixture
+	{
+		FSFixture() : mFS(TEST_EXECUTION_PATH)
+		{
+			mFS.setWriteDir(".");
+		}
+		FileSystem mFS;
+	};
+
+	DuelMatchState makeState(int step)
+	{
+		DuelMatchState state;
+		state.worldState.ballPosition = Vector2(200 + step % 400, 300);
+		state.logicState.leftScore = step / 900;
+		state.logicState.rightScore = step / 1300;
+		state.playerInput[LEFT_PLAYER] = PlayerInput(step % 3 == 0, step % 5 == 0, step % 7 == 0);
+		state.playerInput[RIGHT_PLAYER] = PlayerInput(step % 2 == 0, false, step % 11 == 0);
+		return state;
+	}
+
+	std::unique_ptr<ReplayRecorder> createRecorder()
+	{
+		std::unique_ptr<ReplayRecorder> recorder(new ReplayRecorder());
+		recorder->setPlayerNames("left player", "right player");
+		recorder->setPlayerColors(Color(255, 0, 0), Color(0, 0, 255));
+		recorder->setGameSpeed(75);
+		recorder->setGameRulesScript("-- rules");
+		return recorder;
+	}
+
+	void recordSteps(ReplayRecorder& recorder, int steps)
+	{
+		for(int step = 0; step < steps; ++step)
+			recorder.record(makeState(step));
+	}
+
+	void writeFile(const std::string& filename, const std::vector<char>& data)
+	{
+		FileWrite file(filename);
+		file.write(data.data(), data.size());
+	}
+
+	std::unique_ptr<IReplayLoader> load(const std::string& filename)
+	{
+		return std::unique_ptr<IReplayLoader>(IReplayLoader::createReplayLoader(filename));
+	}
+
+	/// checks that the first \p steps steps of \p loader are those recorded by recordSteps
+	void checkInput(IReplayLoader& loader, int steps)
+	{
+		InputSource left;
+		InputSource right;
+		for(int step = 0; step < steps; ++step)
+		{
+			loader.getInputAt(step, &left, &right);
+			DuelMatchState expected = makeState(step);
+			BOOST_REQUIRE( left.getRealInput().toPlayerInput(nullptr) == expected.playerInput[LEFT_PLAYER] );
+			BOOST_REQUIRE( right.getRealInput().toPlayerInput(nullptr) == expected.playerInput[RIGHT_PLAYER] );
+		}
+	}
+
+	/// checks that every savepoint of \p loader is found and contains the recorded state
+	void checkSavePoints(IReplayLoader& loader, int steps)
+	{
+		int found = 0;
+		for(int step = 0; step < steps; ++step)
+		{
+			int index;
+			if(!loader.isSavePoint(step, index))
+				continue;
+
+			ReplaySavePoint savepoint;
+			loader.readSavePoint(index, savepoint);
+			BOOST_REQUIRE_EQUAL( savepoint.step, (unsigned)step );
+			BOOST_REQUIRE_EQUAL( savepoint.state.logicState.leftScore, makeState(step).logicState.leftScore );
+			++found;
+		}
+		// one every REPLAY_SAVEPOINT_PERIOD steps, and one for every score change
+		BOOST_CHECK( found >= 4 );
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( replay_test )
+
+BOOST_FIXTURE_TEST_CASE( roundtrip, FSFixture )
+{
+	auto recorder = createRecorder();
+	recordSteps(*recorder, GAME_STEPS);
+	recorder->finalize(2, 1);
+	writeFile("replay_roundtrip.bvr", recorder->getReplayData());
+
+	auto loader = load("replay_roundtrip.bvr");
+	BOOST_REQUIRE( loader );
+	BOOST_CHECK_EQUAL( loader->getVersionMajor(), 3 );
+	BOOST_CHECK_EQUAL( loader->getPlayerName(LEFT_PLAYER), "left player" );
+	BOOST_CHECK_EQUAL( loader->getPlayerName(RIGHT_PLAYER), "right player" );
+	BOOST_CHECK( loader->getBlobColor(LEFT_PLAYER) == Color(255, 0, 0) );
+	BOOST_CHECK( loader->getBlobColor(RIGHT_PLAYER) == Color(0, 0, 255) );
+	BOOST_CHECK_EQUAL( loader->getSpeed(), 75 );
+	BOOST_CHECK_EQUAL( loader->getRules(), "-- rules" );
+	BOOST_CHECK_EQUAL( loader->getFinalScore(LEFT_PLAYER), 2 );
+	BOOST_CHECK_EQUAL( loader->getFinalScore(RIGHT_PLAYER), 1 );
+	// finalize adds one second without input
+	BOOST_REQUIRE_EQUAL( loader->getLength(), GAME_STEPS + 75 );
+
+	checkInput(*loader, GAME_STEPS);
+	checkSavePoints(*loader, GAME_STEPS);
+	BOOST_CHECK_THROW( loader->getInputAt(loader->getLength(), nullptr, nullptr), std::exception );
+
+	FileSystem::getSingleton().deleteFile("replay_roundtrip.bvr");
+}
+
+BOOST_FIXTURE_TEST_CASE( roundtrip_streamed, FSFixture )
+{
+	auto recorder = createRecorder();
+	recorder->streamTo("replay_streamed.bvr");
+	recordSteps(*recorder, GAME_STEPS);
+	recorder->finalize(2, 1);
+	recorder.reset();
+
+	auto loader = load("replay_streamed.bvr");
+	BOOST_REQUIRE_EQUAL( loader->getLength(), GAME_STEPS + 75 );
+	BOOST_CHECK_EQUAL( loader->getFinalScore(LEFT_PLAYER), 2 );
+	checkInput(*loader, GAME_STEPS);
+	checkSavePoints(*loader, GAME_STEPS);
+
+	FileSystem::getSingleton().deleteFile("replay_streamed.bvr");
+}
+
+// a recording that stopped in the middle of a chunk has no index, so the chunks are scanned
+BOOST_FIXTURE_TEST_CASE( truncated_file, FSFixture )
+{
+	auto recorder = createRecorder();
+	recordSteps(*recorder, GAME_STEPS);
+	recorder->finalize(2, 1);
+	std::vector<char> data = recorder->getReplayData();
+	data.resize(data.size() * 2 / 3);
+	writeFile("replay_truncated.bvr", data);
+
+	auto loader = load("replay_truncated.bvr");
+	BOOST_CHECK( loader->getLength() > 0 );
+	BOOST_CHECK( loader->getLength() < GAME_STEPS );
+	checkInput(*loader, loader->getLength());
+	BOOST_CHECK_THROW( loader->getInputAt(loader->getLength(), nullptr, nullptr), std::exception );
+
+	// the last savepoint before the cut tells the score
+	int savepoint;
+	int index = loader->getSavePoint(loader->getLength(), savepoint);
+	BOOST_REQUIRE( index >= 0 );
+	BOOST_CHECK( savepoint <= loader->getLength() );
+	BOOST_CHECK_EQUAL( loader->getFinalScore(LEFT_PLAYER), makeState(savepoint).logicState.leftScore );
+
+	FileSystem::getSingleton().deleteFile("replay_truncated.bvr");
+}
+
+// an index that does not match the chunks is ignored, and the chunks are scanned instead
+BOOST_FIXTURE_TEST_CASE( inconsistent_index, FSFixture )
+{
+	auto recorder = createRecorder();
+	recordSteps(*recorder, GAME_STEPS);
+	recorder->finalize(2, 1);
+	std::vector<char> data = recorder->getReplayData();
+
+	// change the length, so it no longer matches the input chunks
+	const unsigned char* trailer = reinterpret_cast<const unsigned char*>(data.data() + data.size() - 8);
+	uint32_t index_position = trailer[0] | (trailer[1] << 8u) | (trailer[2] << 16u) | ((uint32_t)trailer[3] << 24u);
+	BOOST_REQUIRE( std::memcmp(data.data() + index_position, "INDX", 4) == 0 );
+	// the length follows the tag and the chunk size
+	data[index_position + 9] = 1;
+	writeFile("replay_inconsistent.bvr", data);
+
+	auto loader = load("replay_inconsistent.bvr");
+	BOOST_REQUIRE_EQUAL( loader->getLength(), GAME_STEPS + 75 );
+	checkInput(*loader, GAME_STEPS);
+	checkSavePoints(*loader, GAME_STEPS);
+
+	FileSystem::getSingleton().deleteFile("replay_inconsistent.bvr");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
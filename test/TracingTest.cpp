@@ -0,0 +1,141 @@
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "Tracing.h"
+
+namespace
+{
+	int countOccurrences(const std::string& text, const std::string& pattern)
+	{
+		int count = 0;
+		for(auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+			++count;
+		return count;
+	}
+
+	std::string writeTrace()
+	{
+		std::ostringstream stream;
+		writeChromeTrace(stream);
+		return stream.str();
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( tracing )
+
+BOOST_AUTO_TEST_CASE( disabled )
+{
+	stopTracing();
+	BOOST_CHECK( !isTracing() );
+	{
+		TRACE_SCOPE("disabled_scope");
+	}
+	BOOST_CHECK_EQUAL( countOccurrences(writeTrace(), "disabled_scope"), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( nested_scopes )
+{
+	startTracing();
+	{
+		TRACE_SCOPE("outer_scope");
+		TRACE_SCOPE("inner_scope");
+	}
+	stopTracing();
+
+	// scopes that end after tracing was stopped are still recorded, new ones are not
+	{
+		TRACE_SCOPE("stopped_scope");
+	}
+
+	std::string trace = writeTrace();
+	BOOST_CHECK_EQUAL( trace.find("{\"traceEvents\":["), 0u );
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "\"name\":\"outer_scope\",\"ph\":\"X\""), 1 );
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "\"name\":\"inner_scope\",\"ph\":\"X\""), 1 );
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "stopped_scope"), 0 );
+	// the inner scope ends first
+	BOOST_CHECK( trace.find("inner_scope") < trace.find("outer_scope") );
+}
+
+BOOST_AUTO_TEST_CASE( restart_discards_events )
+{
+	startTracing();
+	{
+		TRACE_SCOPE("first_run");
+	}
+	startTracing();
+	{
+		TRACE_SCOPE("second_run");
+	}
+	stopTracing();
+
+	std::string trace = writeTrace();
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "first_run"), 0 );
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "second_run"), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( ring_buffer )
+{
+	// only the last events are kept
+	startTracing(4);
+	{
+		TRACE_SCOPE("old_event");
+	}
+	for(int i = 0; i < 4; ++i)
+	{
+		TRACE_SCOPE("new_event");
+	}
+	stopTracing();
+
+	std::string trace = writeTrace();
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "old_event"), 0 );
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "new_event"), 4 );
+}
+
+BOOST_AUTO_TEST_CASE( threads )
+{
+	startTracing();
+	std::thread worker([]()
+	{
+		setTraceThreadName("traced worker");
+		for(int i = 0; i < 10; ++i)
+		{
+			TRACE_SCOPE("worker_event");
+		}
+	});
+	worker.join();
+	{
+		TRACE_SCOPE("main_event");
+	}
+	stopTracing();
+
+	// events of finished threads are kept
+	std::string trace = writeTrace();
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "worker_event"), 10 );
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "main_event"), 1 );
+	BOOST_CHECK_EQUAL( countOccurrences(trace, "\"args\":{\"name\":\"traced worker\"}"), 1 );
+}
+
+// finished threads don't keep their buffers, only their most recent events are kept
+BOOST_AUTO_TEST_CASE( finished_threads )
+{
+	startTracing(16);
+	for(int t = 0; t < 10; ++t)
+	{
+		std::thread worker([]()
+		{
+			for(int i = 0; i < 4; ++i)
+			{
+				TRACE_SCOPE("short_lived_event");
+			}
+		});
+		worker.join();
+	}
+	stopTracing();
+
+	BOOST_CHECK_EQUAL( countOccurrences(writeTrace(), "short_lived_event"), 16 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
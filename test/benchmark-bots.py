@@ -7,74 +7,41 @@ This can help identify regressions in bot play.
 
 from pathlib import Path
 import subprocess
+import json
 from tabulate import tabulate
 import argparse
-from multiprocessing import Pool
-from functools import partial
-from itertools import combinations_with_replacement
 
-def simulate(bot_names, combination):
-    left_bot = bot_names[combination[0]]
-    right_bot = bot_names[combination[1]]
-    print(f"Running {left_bot} vs {right_bot}")
-
-    output = subprocess.check_output(["./botbench", left_bot, right_bot], text=True)  # type: str
-    marker = f"{left_bot} vs {right_bot}:"
-    for line in output.splitlines():
-        if marker in line:
-            result = line[len(marker):]
-            score, _, time = result.partition("in")
-            left, _, right = score.partition("-")
-            time = time.split()[0]
-            return (combination, int(left), int(right), int(time))
-
-
-    return (combination, None, None, None)
-
-
-def writeToTable(results, score_table, time_table):
-    for result in results:
-        lid = result[0][0]
-        rid = result[0][1]
-        left = result[1]
-        right = result[2]
-        time = result[3]
-
-        if left is not None:
-            score_table[lid][1 + rid] = left
-        else:
-            score_table[lid][1 + rid] = "err"
-
-        if right is not None:
-            score_table[rid][1 + lid] = right
-        else:
-            score_table[rid][1 + lid] = "err"
-
-        if time is not None:
-            time_table[rid][1 + lid] = time
-        else:
-            time_table[rid][1 + lid] = "err"
 
+def writeToTable(bot_names, duels, score_table, time_table):
+    index = {name: i for i, name in enumerate(bot_names)}
+    for duel in duels:
+        lid = index[duel["left"]]
+        rid = index[duel["right"]]
+        score_table[lid][1 + rid] += duel["left_score"]
+        score_table[rid][1 + lid] += duel["right_score"]
+        time_table[rid][1 + lid] += duel["game_seconds"]
 
 
 parser = argparse.ArgumentParser(description='Checks all combinations of bots against each other')
 parser.add_argument('-j', '--jobs', type=int, default=1)
+parser.add_argument('-s', '--seeds', type=int, default=1)
+args = parser.parse_args()
 
 bots_path = Path() / "data" / "scripts"
 bot_names = [str(bot.relative_to(bots_path)) for bot in bots_path.glob("*.lua")]
 
-assert len(bot_names) != 0, "No bots found"
+assert len(bot_names) > 1, "Not enough bots found"
 
 
 score_table = [[i] + [0] * len(bot_names) for i in bot_names]
 time_table = [[i] + [0] * len(bot_names) for i in bot_names]
 
-bot_combinations = list(combinations_with_replacement(range(len(bot_names)), 2))
-
-with Pool(vars(parser.parse_args())["jobs"]) as p:
-    results = p.map(partial(simulate, bot_names), bot_combinations)
+# botbench plays the whole round robin itself, using one thread per job
+output = subprocess.check_output(["./botbench", "--format", "json", "--jobs", str(args.jobs),
+                                  "--seeds", str(args.seeds)] + bot_names, text=True)
+results = json.loads(output)
 
-writeToTable(results, score_table, time_table)
+writeToTable(bot_names, results["duels"], score_table, time_table)
 
 print("Scores:")
 print(tabulate(score_table, headers=[""] + bot_names))
@@ -82,3 +49,7 @@ print(tabulate(score_table, headers=[""] + bot_names))
 print()
 print("Durations:")
 print(tabulate(time_table, headers=[""] + bot_names))
+
+print()
+print(f"Simulated {results['total_steps']} steps in {results['wall_seconds']:.1f} s "
+      f"({results['steps_per_second']:.0f} steps/s)")